@@ -78,11 +78,16 @@ FILES="milenage.c milenage.h Milenage_FunctionDefs.cc Milenage_Functions.ttcn "
 gen_links $DIR $FILES
 
 DIR=../library/ng_crypto
+FILES="ng_key_derivation.c ng_key_derivation.h "
+gen_links $DIR $FILES
+
+DIR=../library/lte_crypto
 FILES="key_derivation.c key_derivation.h "
 gen_links $DIR $FILES
 
 DIR=../library
 FILES="Misc_Helpers.ttcn General_Types.ttcn GSM_Types.ttcn Osmocom_Types.ttcn Native_Functions.ttcn Native_FunctionDefs.cc IPCP_Types.ttcn IPCP_Templates.ttcn "
+FILES+="ASN1_Codec.hh "
 FILES+="SCTP_Templates.ttcn "
 FILES+="DNS_Helpers.ttcn "
 FILES+="NGAP_CodecPort.ttcn NGAP_CodecPort_CtrlFunctDef.cc NGAP_CodecPort_CtrlFunct.ttcn NGAP_Functions.ttcn NGAP_Emulation.ttcn "
@@ -53,6 +53,7 @@ gen_links $DIR $FILES
 
 DIR=../library
 FILES="Misc_Helpers.ttcn General_Types.ttcn GSM_Types.ttcn Osmocom_Types.ttcn Native_Functions.ttcn Native_FunctionDefs.cc "
+FILES+="ASN1_Codec.hh "
 FILES+="HTTP_Adapter.ttcn "
 FILES+="BSSMAP_Templates.ttcn "
 FILES+="CBSP_Types.ttcn CBSP_Templates.ttcn "
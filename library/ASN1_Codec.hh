@@ -0,0 +1,200 @@
+#ifndef ASN1_CODEC_HH
+#define ASN1_CODEC_HH
+
+/* Common implementation of the enc_XXX() / dec_XXX() external functions
+ * wrapping the TITAN generated ASN.1 (PER/BER) codecs.
+ *
+ * Released under the terms of GNU General Public License, Version 2 or
+ * (at your option) any later version.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <TTCN3.hh>
+
+namespace ASN1__Codec {
+
+template <class T, const TTCN_Typedescriptor_t &DESCR, TTCN_EncDec::coding_t CODING, int FLAVOR>
+OCTETSTRING enc(const T &val)
+{
+	TTCN_Buffer buf;
+	OCTETSTRING ret_val;
+
+	val.encode(DESCR, buf, CODING, FLAVOR);
+	/* hands the encoded memory over to ret_val without copying */
+	buf.get_string(ret_val);
+	return ret_val;
+}
+
+template <class T, const TTCN_Typedescriptor_t &DESCR, TTCN_EncDec::coding_t CODING, int FLAVOR>
+T dec(const OCTETSTRING &stream)
+{
+	/* refers to the memory of stream rather than copying it via put_os() */
+	TTCN_Buffer buf(stream);
+	T ret_val;
+
+	ret_val.decode(DESCR, buf, CODING, FLAVOR);
+	return ret_val;
+}
+
+/* Minimal reader for the ALIGNED variant of PER (ITU-T X.691), just enough to
+ * walk the outer layers of a 3GPP *AP PDU (CHOICE index, constrained whole
+ * numbers, length determinants, open types) without decoding all of it. */
+struct aper_reader {
+	const unsigned char *data;
+	size_t len;		/* in octets */
+	size_t pos;		/* in bits */
+};
+
+static inline void aper_init(struct aper_reader *r, const unsigned char *data, size_t len)
+{
+	r->data = data;
+	r->len = len;
+	r->pos = 0;
+}
+
+static inline unsigned long long aper_get_bits(struct aper_reader *r, unsigned int num_bits)
+{
+	unsigned long long val = 0;
+	unsigned int i;
+
+	if (r->pos + num_bits > r->len * 8)
+		TTCN_error("APER: cannot read %u bits at offset %zu of %zu octets",
+			   num_bits, r->pos, r->len);
+	for (i = 0; i < num_bits; i++, r->pos++)
+		val = (val << 1) | ((r->data[r->pos / 8] >> (7 - r->pos % 8)) & 1);
+	return val;
+}
+
+static inline void aper_align(struct aper_reader *r)
+{
+	r->pos = (r->pos + 7) & ~(size_t)7;
+}
+
+/* number of bits needed to encode range different values */
+static inline unsigned int aper_range_bits(unsigned long long range)
+{
+	unsigned int num_bits = 0;
+
+	while (num_bits < 64 && (1ULL << num_bits) < range)
+		num_bits++;
+	return num_bits;
+}
+
+/* constrained whole number in 0..ub (X.691 10.5.7) */
+static inline unsigned long long aper_get_constrained(struct aper_reader *r, unsigned long long ub)
+{
+	unsigned long long range = ub + 1;
+	unsigned int len;
+
+	if (range <= 255)
+		return aper_get_bits(r, aper_range_bits(range));
+	if (range <= 65536) {
+		aper_align(r);
+		return aper_get_bits(r, range == 256 ? 8 : 16);
+	}
+	/* indefinite length case: number of octets, then the octets */
+	len = aper_get_bits(r, aper_range_bits((aper_range_bits(range) + 7) / 8)) + 1;
+	aper_align(r);
+	return aper_get_bits(r, len * 8);
+}
+
+/* length determinant (X.691 10.9.3.6/10.9.3.7), fragments are not supported */
+static inline size_t aper_get_length(struct aper_reader *r)
+{
+	unsigned int oct;
+
+	aper_align(r);
+	oct = aper_get_bits(r, 8);
+	if (!(oct & 0x80))
+		return oct;
+	if ((oct & 0xc0) == 0x80)
+		return ((oct & 0x3f) << 8) | aper_get_bits(r, 8);
+	TTCN_error("APER: fragmented length determinant not supported");
+}
+
+/* skip over an open type, returning a reader for its contents */
+static inline struct aper_reader aper_get_open_type(struct aper_reader *r)
+{
+	size_t len = aper_get_length(r);
+	struct aper_reader sub;
+
+	if (r->pos / 8 + len > r->len)
+		TTCN_error("APER: open type of %zu octets exceeds PDU", len);
+	aper_init(&sub, r->data + r->pos / 8, len);
+	r->pos += len * 8;
+	return sub;
+}
+
+static inline INTEGER aper_int(unsigned long long val)
+{
+	INTEGER ret_val;
+
+	ret_val.set_long_long_val(val);
+	return ret_val;
+}
+
+/* Outer layers shared by the NGAP and S1AP PDUs: the PDU CHOICE of
+ * initiatingMessage/successfulOutcome/unsuccessfulOutcome, procedureCode,
+ * criticality and the message itself as open type. */
+struct aper_ap_hdr {
+	unsigned int pdu_type;		/* index of the PDU CHOICE */
+	unsigned int procedure_code;
+	unsigned int criticality;
+	struct aper_reader msg;
+};
+
+static inline void aper_get_ap_hdr(struct aper_reader *r, struct aper_ap_hdr *hdr)
+{
+	if (aper_get_bits(r, 1))
+		TTCN_error("APER: PDU CHOICE extension not supported");
+	hdr->pdu_type = aper_get_bits(r, 2);
+	hdr->procedure_code = aper_get_constrained(r, 255);
+	hdr->criticality = aper_get_bits(r, 2);
+	if (hdr->pdu_type > 2 || hdr->criticality > 2)
+		TTCN_error("APER: invalid PDU type %u / criticality %u",
+			   hdr->pdu_type, hdr->criticality);
+	hdr->msg = aper_get_open_type(r);
+}
+
+/* Start of a message SEQUENCE { protocolIEs ProtocolIE-Container, ... };
+ * returns the number of IEs in the container. */
+static inline unsigned int aper_get_num_ies(struct aper_reader *msg)
+{
+	aper_get_bits(msg, 1);	/* extension bit */
+	return aper_get_constrained(msg, 65535);
+}
+
+/* ProtocolIE-Field: returns the IE id, the value is returned as open type */
+static inline unsigned int aper_get_ie(struct aper_reader *msg, struct aper_reader *value)
+{
+	unsigned int id = aper_get_constrained(msg, 65535);
+
+	aper_get_bits(msg, 2);	/* criticality */
+	*value = aper_get_open_type(msg);
+	return id;
+}
+
+}
+
+/* Define OCTETSTRING enc__NAME(const TYPE&) and TYPE dec__NAME(const OCTETSTRING&)
+ * using the TYPE_descr_ generated for TYPE. */
+#define ASN1_CODEC_FUNCS(NAME, TYPE, CODING, ENC_FLAVOR, DEC_FLAVOR)			\
+	OCTETSTRING enc__##NAME(const TYPE &val)					\
+	{										\
+		return ASN1__Codec::enc<TYPE, TYPE##_descr_, CODING, ENC_FLAVOR>(val);	\
+	}										\
+	TYPE dec__##NAME(const OCTETSTRING &stream)					\
+	{										\
+		return ASN1__Codec::dec<TYPE, TYPE##_descr_, CODING, DEC_FLAVOR>(stream);	\
+	}
+
+/* BASIC-PER Aligned Variant, as used by the 3GPP *AP protocols */
+#define ASN1_CODEC_APER(NAME, TYPE) \
+	ASN1_CODEC_FUNCS(NAME, TYPE, TTCN_EncDec::CT_PER, PER_ALIGNED, PER_ALIGNED)
+
+/* DER on encode, any BER on decode */
+#define ASN1_CODEC_BER(NAME, TYPE) \
+	ASN1_CODEC_FUNCS(NAME, TYPE, TTCN_EncDec::CT_BER, BER_ENCODE_DER, BER_ACCEPT_ALL)
+
+#endif
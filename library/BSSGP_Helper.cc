@@ -1,85 +1,82 @@
 
+#include "Boolean.hh"
+#include "Integer.hh"
 #include "Octetstring.hh"
 #include "Error.hh"
 #include "Logger.hh"
 
 #include <stdint.h>
+#include <string.h>
 
 namespace BSSGP__Helper__Functions {
 
+/* parse Tag + variable-length "length" field (Osmocom TvLV) of the TLV at 'ie', with 'remain_len'
+ * octets of input left.  Returns the length of Tag+Length and stores the value length in 'data_len' */
+static int parse_tvlv_hdr(const unsigned char *ie, int remain_len, uint16_t *data_len)
+{
+	int tl_length;
+
+	if (remain_len < 2)
+		TTCN_error("Remaining input length (%d) insufficient for Tag+Length", remain_len);
+
+	if (ie[1] & 0x80) {
+		/* E bit is set, 7-bit length field */
+		*data_len = ie[1] & 0x7F;
+		tl_length = 2;
+	} else {
+		/* E bit is not set, 15 bit length field */
+		if (remain_len < 3)
+			TTCN_error("Remaining input length insufficient for 2-octet length");
+		*data_len = ie[1] << 8 | ie[2];
+		tl_length = 3;
+	}
+	if (remain_len < tl_length + *data_len)
+		TTCN_error("Remaining input length insufficient for TLV value length");
+
+	return tl_length;
+}
+
 /* convert a buffer filled with TLVs that have variable-length "length" fields (Osmocom TvLV) into a
- * buffer filled with TLVs that have fixed 16-bit length values (TL16V format) */
-static OCTETSTRING expand_tlv_part(OCTETSTRING const &in)
+ * buffer filled with TLVs that have fixed 16-bit length values (TL16V format).  The output is written
+ * to 'out', which must have room for at least in_len * 3 / 2 octets (each TLV is at least two octets
+ * long and grows by at most one).  Returns the number of octets written. */
+static int expand_tlv_part(const unsigned char *in_ptr, int in_len, unsigned char *out)
 {
-	const unsigned char *in_ptr = (const unsigned char *)in;
-	int in_len = in.lengthof();
+	unsigned char *out_ptr = out;
 	int ofs = 0;
 	uint16_t data_len;
-	OCTETSTRING out(0, (const unsigned char *)"");
 
 	while (ofs < in_len) {
-		int remain_len = in_len - ofs;
-		int tl_length;
-
-		if (remain_len < 2) {
-			TTCN_error("Remaining input length (%d) insufficient for Tag+Length", remain_len);
-			break;
-		}
-
-		/* copy over tag */
-		if (in_ptr[ofs+1] & 0x80) {
-			/* E bit is set, 7-bit length field */
-			data_len = in_ptr[ofs+1] & 0x7F;
-			tl_length = 2;
-		} else {
-			/* E bit is not set, 15 bit length field */
-			if (remain_len < 3) {
-				TTCN_error("Remaining input length insufficient for 2-octet length");
-				break;
-			}
-			data_len = in_ptr[ofs+1] << 8 | in_ptr[ofs+2];
-			tl_length = 3;
-		}
-		if (in_len < tl_length + data_len) {
-			TTCN_error("Remaining input length insufficient for TLV value length");
-			break;
-		}
+		int tl_length = parse_tvlv_hdr(in_ptr + ofs, in_len - ofs, &data_len);
 
 		/* Tag + 16bit length */
-		uint8_t hdr_buf[3];
-		hdr_buf[0] = in_ptr[ofs+0];
-		hdr_buf[1] = data_len >> 8;
-		hdr_buf[2] = data_len & 0xff;
-
-		OCTETSTRING tlv_hdr(3, hdr_buf);
-		out += tlv_hdr;
-
-		if (data_len) {
-			/* append octet string of current TLV to output octetstring */
-			OCTETSTRING tlv_val(data_len, in_ptr + ofs + tl_length);
-			out += tlv_val;
-		}
+		*out_ptr++ = in_ptr[ofs+0];
+		*out_ptr++ = data_len >> 8;
+		*out_ptr++ = data_len & 0xff;
+
+		/* copy value of current TLV to output buffer */
+		memcpy(out_ptr, in_ptr + ofs + tl_length, data_len);
+		out_ptr += data_len;
 
 		/* advance input offset*/
 		ofs += data_len + tl_length;
 	}
 
-	return out;
+	return out_ptr - out;
 }
 
 /* convert a buffer filled with TLVs that have fixed-length "length" fields (Osmocom TL16V) into a
- * buffer filled with TLVs that have variable-length values (TvLV format) */
-static OCTETSTRING compact_tlv_part(OCTETSTRING const &in)
+ * buffer filled with TLVs that have variable-length values (TvLV format).  The output is written to
+ * 'out', which must have room for at least in_len octets (the conversion never grows a TLV).
+ * Returns the number of octets written. */
+static int compact_tlv_part(const unsigned char *in_ptr, int in_len, unsigned char *out)
 {
-	const unsigned char *in_ptr = (const unsigned char *)in;
-	int in_len = in.lengthof();
+	unsigned char *out_ptr = out;
 	int ofs = 0;
 	uint16_t data_len;
-	OCTETSTRING out(0, (const unsigned char *)"");
 
 	while (ofs < in_len) {
 		int remain_len = in_len - ofs;
-		int tl_length;
 
 		if (remain_len < 3) {
 			TTCN_error("Remaining input length (%d) insufficient for Tag+Length", remain_len);
@@ -87,52 +84,69 @@ static OCTETSTRING compact_tlv_part(OCTETSTRING const &in)
 		}
 
 		data_len = (in_ptr[ofs+1] << 8) | in_ptr[ofs+2];
+		if (remain_len < 3 + data_len) {
+			TTCN_error("Remaining input length insufficient for TLV value length");
+			break;
+		}
 
-		/* Tag + 16bit length */
-		uint8_t hdr_buf[3];
-		hdr_buf[0] = in_ptr[ofs+0];
+		/* Tag */
+		*out_ptr++ = in_ptr[ofs+0];
 
 		if (data_len <= 0x7f) {
 			/* E bit is set, 7-bit length field */
-			hdr_buf[1] = 0x80 | data_len;
-			tl_length = 2;
+			*out_ptr++ = 0x80 | data_len;
 		} else {
 			/* E bit is not set, 15 bit length field */
-			hdr_buf[1] = data_len >> 8;
-			hdr_buf[2] = data_len & 0xff;
-			tl_length = 3;
+			*out_ptr++ = data_len >> 8;
+			*out_ptr++ = data_len & 0xff;
 		}
-		if (in_len < 3 + data_len) {
-			TTCN_error("Remaining input length insufficient for TLV value length");
-			break;
-		}
-
-		OCTETSTRING tlv_hdr(tl_length, hdr_buf);
-		out += tlv_hdr;
 
-		if (data_len) {
-			/* append octet string of current TLV to output octetstring */
-			OCTETSTRING tlv_val(data_len, in_ptr + ofs + 3);
-			out += tlv_val;
-		}
+		/* copy value of current TLV to output buffer */
+		memcpy(out_ptr, in_ptr + ofs + 3, data_len);
+		out_ptr += data_len;
 
 		/* advance input offset*/
 		ofs += data_len + 3;
 	}
 
-	return out;
+	return out_ptr - out;
+}
+
+/* copy the non-TLV prefix of a message and convert the TLV part behind it in one pass into a single
+ * pre-allocated output buffer */
+static OCTETSTRING convert_tlv_msg(const unsigned char *in_ptr, int in_len, int static_hdr_len, bool expand)
+{
+	int tlv_len = in_len - static_hdr_len;
+	size_t max_len = static_hdr_len + (expand ? tlv_len + tlv_len / 2 : tlv_len);
+	size_t accepted_len = max_len;
+	unsigned char *out = NULL;
+	TTCN_Buffer buf;
+	OCTETSTRING ret_val;
+	int out_len;
+
+	buf.get_end(out, accepted_len);
+	if (accepted_len < max_len)
+		TTCN_error("Cannot allocate %zu bytes for TLV conversion", max_len);
+
+	memcpy(out, in_ptr, static_hdr_len);
+	if (expand)
+		out_len = expand_tlv_part(in_ptr + static_hdr_len, tlv_len, out + static_hdr_len);
+	else
+		out_len = compact_tlv_part(in_ptr + static_hdr_len, tlv_len, out + static_hdr_len);
+
+	buf.increase_length(static_hdr_len + out_len);
+	buf.get_string(ret_val);
+
+	return ret_val;
 }
 
 #define BSSGP_PDUT_DL_UNITDATA	0x00
 #define BSSGP_PDUT_UL_UNITDATA	0x01
 
-/* expand all the variable-length "length" fields of a BSSGP message (Osmocom TvLV) into statlc TL16V format */
-OCTETSTRING f__BSSGP__expand__len(OCTETSTRING const &in)
+static int bssgp_static_hdr_len(const unsigned char *in_ptr, int in_len)
 {
-	const unsigned char *in_ptr = (const unsigned char *)in;
-	int in_len = in.lengthof();
 	uint8_t pdu_type = in_ptr[0];
-	uint8_t static_hdr_len = 1;
+	int static_hdr_len = 1;
 
 	if (pdu_type == BSSGP_PDUT_DL_UNITDATA || pdu_type == BSSGP_PDUT_UL_UNITDATA)
 		static_hdr_len = 8;
@@ -141,77 +155,176 @@ OCTETSTRING f__BSSGP__expand__len(OCTETSTRING const &in)
 		TTCN_error("BSSGP message is shorter (%u bytes) than minimum header length (%u bytes) for msg_type 0x%02x",
 				in_len, static_hdr_len, pdu_type);
 
-	/* prefix = non-TLV section of header */
-	OCTETSTRING prefix(static_hdr_len, in_ptr);
-	OCTETSTRING tlv_part_in(in_len - static_hdr_len, in_ptr + static_hdr_len);
+	return static_hdr_len;
+}
+
+#define BSSGP_IEI_LLC_PDU	0x0e
 
-	return prefix + expand_tlv_part(tlv_part_in);
+/* locate the LLC-PDU IE, which normally is the last IE of both UL- and DL-UNITDATA.  Returns the
+ * offset of the IE within 'in_ptr' and stores the offset and length of its value in 'llc_ofs' /
+ * 'llc_len', or returns -1 if there is no LLC-PDU IE or if it is followed by further IEs */
+static int unitdata_find_llc(const unsigned char *in_ptr, int in_len, int static_hdr_len,
+			     int *llc_ofs, uint16_t *llc_len)
+{
+	int ofs, tl_length;
+
+	for (ofs = static_hdr_len; ; ofs += tl_length + *llc_len) {
+		if (ofs >= in_len)
+			return -1;
+		tl_length = parse_tvlv_hdr(in_ptr + ofs, in_len - ofs, llc_len);
+		if (in_ptr[ofs] == BSSGP_IEI_LLC_PDU)
+			break;
+	}
+	if (ofs + tl_length + *llc_len != in_len)
+		return -1;
+
+	*llc_ofs = ofs + tl_length;
+	return ofs;
+}
+
+/* maximum length of the expanded UNITDATA header: static part, expanded IEs in front of the LLC-PDU
+ * IE (located at 'llc_ie_ofs') and Tag + 16bit length of the LLC-PDU IE */
+static size_t unitdata_hdr_max_len(int static_hdr_len, int llc_ie_ofs)
+{
+	return llc_ie_ofs + (llc_ie_ofs - static_hdr_len) / 2 + 3;
+}
+
+/* write the expanded UNITDATA header (everything up to and including the Tag + 16bit length of the
+ * LLC-PDU IE) to 'out'.  Returns the number of octets written. */
+static int unitdata_expand_hdr(const unsigned char *in_ptr, int static_hdr_len, int llc_ie_ofs,
+			       uint16_t llc_len, unsigned char *out)
+{
+	int out_len;
+
+	memcpy(out, in_ptr, static_hdr_len);
+	out_len = static_hdr_len + expand_tlv_part(in_ptr + static_hdr_len, llc_ie_ofs - static_hdr_len,
+						   out + static_hdr_len);
+	out[out_len++] = BSSGP_IEI_LLC_PDU;
+	out[out_len++] = llc_len >> 8;
+	out[out_len++] = llc_len & 0xff;
+
+	return out_len;
+}
+
+/* expand all the variable-length "length" fields of a BSSGP message (Osmocom TvLV) into statlc TL16V format */
+OCTETSTRING f__BSSGP__expand__len(OCTETSTRING const &in)
+{
+	const unsigned char *in_ptr = (const unsigned char *)in;
+	int in_len = in.lengthof();
+	int static_hdr_len = bssgp_static_hdr_len(in_ptr, in_len);
+	int llc_ie_ofs, llc_ofs, out_len;
+	uint16_t llc_len;
+	size_t max_len, accepted_len;
+	unsigned char *out = NULL;
+	TTCN_Buffer buf;
+	OCTETSTRING ret_val;
+
+	/* UNITDATA: expand the header via the fast path and append the LLC-PDU value as-is, rather
+	 * than walking the (potentially large) LLC-PDU as part of the generic TLV conversion */
+	if (in_ptr[0] == BSSGP_PDUT_DL_UNITDATA || in_ptr[0] == BSSGP_PDUT_UL_UNITDATA)
+		llc_ie_ofs = unitdata_find_llc(in_ptr, in_len, static_hdr_len, &llc_ofs, &llc_len);
+	else
+		llc_ie_ofs = -1;
+	if (llc_ie_ofs < 0)
+		return convert_tlv_msg(in_ptr, in_len, static_hdr_len, true);
+
+	max_len = unitdata_hdr_max_len(static_hdr_len, llc_ie_ofs) + llc_len;
+	accepted_len = max_len;
+	buf.get_end(out, accepted_len);
+	if (accepted_len < max_len)
+		TTCN_error("Cannot allocate %zu bytes for TLV conversion", max_len);
+
+	out_len = unitdata_expand_hdr(in_ptr, static_hdr_len, llc_ie_ofs, llc_len, out);
+	memcpy(out + out_len, in_ptr + llc_ofs, llc_len);
+
+	buf.increase_length(out_len + llc_len);
+	buf.get_string(ret_val);
+
+	return ret_val;
 }
 
 OCTETSTRING f__BSSGP__compact__len(OCTETSTRING const &in)
 {
 	const unsigned char *in_ptr = (const unsigned char *)in;
 	int in_len = in.lengthof();
-	uint8_t pdu_type = in_ptr[0];
-	uint8_t static_hdr_len = 1;
 
-	if (pdu_type == BSSGP_PDUT_DL_UNITDATA || pdu_type == BSSGP_PDUT_UL_UNITDATA)
-		static_hdr_len = 8;
+	return convert_tlv_msg(in_ptr, in_len, bssgp_static_hdr_len(in_ptr, in_len), false);
+}
+
+/* Fast path for UL/DL-UNITDATA: only expand the (small) IEs in front of the trailing LLC-PDU IE and
+ * terminate the output with the Tag + 16bit length of the LLC-PDU IE.  The LLC-PDU value itself is
+ * not copied, its offset and length within 'in' are returned instead, so the caller can slice it
+ * out (or append it) without decoding the message again. */
+OCTETSTRING f__BSSGP__expand__len__unitdata(OCTETSTRING const &in, INTEGER &llc_ofs, INTEGER &llc_len)
+{
+	const unsigned char *in_ptr = (const unsigned char *)in;
+	int in_len = in.lengthof();
+	int static_hdr_len, llc_ie_ofs, value_ofs, out_len;
+	uint16_t value_len;
+	size_t max_len, accepted_len;
+	unsigned char *out = NULL;
+	TTCN_Buffer buf;
+	OCTETSTRING ret_val;
+
+	if (in_len < 1 || (in_ptr[0] != BSSGP_PDUT_DL_UNITDATA && in_ptr[0] != BSSGP_PDUT_UL_UNITDATA))
+		TTCN_error("BSSGP message is not a UL/DL-UNITDATA");
+	static_hdr_len = bssgp_static_hdr_len(in_ptr, in_len);
+	llc_ie_ofs = unitdata_find_llc(in_ptr, in_len, static_hdr_len, &value_ofs, &value_len);
+	if (llc_ie_ofs < 0)
+		TTCN_error("BSSGP UNITDATA without trailing LLC-PDU IE");
+
+	max_len = unitdata_hdr_max_len(static_hdr_len, llc_ie_ofs);
+	accepted_len = max_len;
+	buf.get_end(out, accepted_len);
+	if (accepted_len < max_len)
+		TTCN_error("Cannot allocate %zu bytes for TLV conversion", max_len);
+
+	out_len = unitdata_expand_hdr(in_ptr, static_hdr_len, llc_ie_ofs, value_len, out);
+
+	buf.increase_length(out_len);
+	buf.get_string(ret_val);
+
+	llc_ofs = value_ofs;
+	llc_len = value_len;
+
+	return ret_val;
+}
+
+#define NS_PDUT_NS_UNITDATA	0x00
+
+static int ns_static_hdr_len(const unsigned char *in_ptr, int in_len)
+{
+	uint8_t pdu_type = in_ptr[0];
+	int static_hdr_len = 1;
 
 	if (in_len < static_hdr_len)
-		TTCN_error("BSSGP message is shorter (%u bytes) than minimum header length (%u bytes) for msg_type 0x%02x",
+		TTCN_error("NS message is shorter (%u bytes) than minimum header length (%u bytes) for msg_type 0x%02x",
 				in_len, static_hdr_len, pdu_type);
 
-	/* prefix = non-TLV section of header */
-	OCTETSTRING prefix(static_hdr_len, in_ptr);
-	OCTETSTRING tlv_part_in(in_len - static_hdr_len, in_ptr + static_hdr_len);
-
-	return prefix + compact_tlv_part(tlv_part_in);
+	return static_hdr_len;
 }
 
-#define NS_PDUT_NS_UNITDATA	0x00
-
 /* expand all the variable-length "length" fields of a NS message (Osmocom TvLV) into statlc TL16V format */
 OCTETSTRING f__NS__expand__len(OCTETSTRING const &in)
 {
 	const unsigned char *in_ptr = (const unsigned char *)in;
 	int in_len = in.lengthof();
-	uint8_t pdu_type = in_ptr[0];
-	uint8_t static_hdr_len = 1;
 
-	if (pdu_type == NS_PDUT_NS_UNITDATA)
+	if (in_ptr[0] == NS_PDUT_NS_UNITDATA)
 		return in;
 
-	if (in_len < static_hdr_len)
-		TTCN_error("NS message is shorter (%u bytes) than minimum header length (%u bytes) for msg_type 0x%02x",
-				in_len, static_hdr_len, pdu_type);
-
-	/* prefix = non-TLV section of header */
-	OCTETSTRING prefix(static_hdr_len, in_ptr);
-	OCTETSTRING tlv_part_in(in_len - static_hdr_len, in_ptr + static_hdr_len);
-
-	return prefix + expand_tlv_part(tlv_part_in);
+	return convert_tlv_msg(in_ptr, in_len, ns_static_hdr_len(in_ptr, in_len), true);
 }
 
 OCTETSTRING f__NS__compact__len(OCTETSTRING const &in)
 {
 	const unsigned char *in_ptr = (const unsigned char *)in;
 	int in_len = in.lengthof();
-	uint8_t pdu_type = in_ptr[0];
-	uint8_t static_hdr_len = 1;
 
-	if (pdu_type == NS_PDUT_NS_UNITDATA)
+	if (in_ptr[0] == NS_PDUT_NS_UNITDATA)
 		return in;
 
-	if (in_len < static_hdr_len)
-		TTCN_error("NS message is shorter (%u bytes) than minimum header length (%u bytes) for msg_type 0x%02x",
-				in_len, static_hdr_len, pdu_type);
-
-	/* prefix = non-TLV section of header */
-	OCTETSTRING prefix(static_hdr_len, in_ptr);
-	OCTETSTRING tlv_part_in(in_len - static_hdr_len, in_ptr + static_hdr_len);
-
-	return prefix + compact_tlv_part(tlv_part_in);
+	return convert_tlv_msg(in_ptr, in_len, ns_static_hdr_len(in_ptr, in_len), false);
 }
 
 
@@ -275,13 +388,58 @@ static const uint32_t tbl_crc24[256] = {
 
 #define INIT_CRC24	0xffffff
 
+/* Slice-by-8 tables: tbl_crc24_s8[k][x] is the CRC register contribution of
+ * octet x followed by k zero octets, tbl_crc24_s8[0] being tbl_crc24.  The
+ * 24 bit register is processed as a 32 bit one whose upper octet is always
+ * zero, so the usual reflected slice-by-8 scheme applies unchanged. */
+static struct crc24_s8_tables {
+	uint32_t t[8][256];
+
+	crc24_s8_tables()
+	{
+		for (int x = 0; x < 256; x++) {
+			t[0][x] = tbl_crc24[x];
+			for (int k = 1; k < 8; k++)
+				t[k][x] = (t[k-1][x] >> 8) ^ tbl_crc24[t[k-1][x] & 0xff];
+		}
+	}
+} tbl_crc24_s8;
+
+static inline uint32_t load_le32(const unsigned char *cp)
+{
+	return cp[0] | (cp[1] << 8) | (cp[2] << 16) | ((uint32_t)cp[3] << 24);
+}
+
 static uint32_t crc24_calc(uint32_t fcs, const unsigned char *cp, int len)
 {
+	const uint32_t (*t)[256] = tbl_crc24_s8.t;
+
+	while (len >= 8) {
+		uint32_t lo = fcs ^ load_le32(cp);
+		uint32_t hi = load_le32(cp + 4);
+		fcs = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+		      t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+		      t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^
+		      t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+		cp += 8;
+		len -= 8;
+	}
 	while (len--)
 		fcs = (fcs >> 8) ^ tbl_crc24[(fcs ^ *cp++) & 0xff];
 	return fcs;
 }
 
+static uint32_t llc_fcs(const unsigned char *data, int len)
+{
+	uint32_t fcs_calc;
+
+	fcs_calc = crc24_calc(INIT_CRC24, data, len);
+	fcs_calc = ~fcs_calc;
+	fcs_calc &= 0xffffff;
+
+	return fcs_calc;
+}
+
 OCTETSTRING f__LLC__compute__fcs(OCTETSTRING const &in)
 {
 	uint32_t fcs_calc;
@@ -289,9 +447,7 @@ OCTETSTRING f__LLC__compute__fcs(OCTETSTRING const &in)
 	const unsigned char *data = (const unsigned char *)in;
 	int len = in.lengthof();
 
-	fcs_calc = crc24_calc(INIT_CRC24, data, len);
-	fcs_calc = ~fcs_calc;
-	fcs_calc &= 0xffffff;
+	fcs_calc = llc_fcs(data, len);
 
 	fcs_buf[0] = fcs_calc & 0xff;
 	fcs_buf[1] = (fcs_calc >> 8) & 0xff;
@@ -300,4 +456,20 @@ OCTETSTRING f__LLC__compute__fcs(OCTETSTRING const &in)
 	return OCTETSTRING(3, fcs_buf);
 }
 
+/* verify the FCS in the last three octets of a received LLC frame in place */
+BOOLEAN f__LLC__check__fcs(OCTETSTRING const &frame)
+{
+	const unsigned char *data = (const unsigned char *)frame;
+	int len = frame.lengthof();
+	uint32_t fcs_rx;
+
+	if (len < 3)
+		return false;
+
+	len -= 3;
+	fcs_rx = data[len] | (data[len+1] << 8) | (data[len+2] << 16);
+
+	return llc_fcs(data, len) == fcs_rx;
+}
+
 }
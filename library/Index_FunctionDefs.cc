@@ -0,0 +1,236 @@
+/* Native hash index for the emulation components, see Index_Functions.ttcn
+ *
+ * Released under the terms of GNU General Public License, Version 2 or
+ * (at your option) any later version.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <queue>
+
+#include <Boolean.hh>
+#include <Integer.hh>
+#include <Octetstring.hh>
+#include <Hexstring.hh>
+#include <Charstring.hh>
+
+namespace Index__Functions {
+
+/* Keys are stored as byte strings prefixed by a type tag, so that e.g. an
+ * octetstring and a charstring of the same content are different keys. */
+enum index_key_type {
+	INDEX_KEY_OCT	= 'O',
+	INDEX_KEY_HEX	= 'H',
+	INDEX_KEY_CHAR	= 'C',
+	INDEX_KEY_INT	= 'I',
+};
+
+struct index {
+	bool in_use;
+	std::unordered_map<std::string, int> map;
+	/* slot allocator: slot_used[n] tells whether slot n is allocated, the
+	 * slots freed since are kept in free_slots, lowest first */
+	std::vector<bool> slot_used;
+	std::priority_queue<int, std::vector<int>, std::greater<int>> free_slots;
+};
+
+/* all indexes of this component, IndexHandle is the position in here */
+static std::vector<struct index> indexes;
+
+static struct index &index_get(const INTEGER &idx)
+{
+	int i = idx;
+
+	if (i < 0 || (size_t)i >= indexes.size() || !indexes[i].in_use)
+		TTCN_error("Index_Functions: invalid index handle %d", i);
+	return indexes[i];
+}
+
+static void index_reset(struct index &ix)
+{
+	ix.map.clear();
+	ix.slot_used.clear();
+	ix.free_slots = decltype(ix.free_slots)();
+}
+
+static std::string key_oct(const OCTETSTRING &key)
+{
+	std::string k(1, (char)INDEX_KEY_OCT);
+
+	k.append((const char *)(const unsigned char *)key, key.lengthof());
+	return k;
+}
+
+static std::string key_hex(const HEXSTRING &key)
+{
+	int len = key.lengthof();
+	std::string k(1 + len, (char)INDEX_KEY_HEX);
+
+	/* one nibble per octet keeps "1" and "10" apart without a length */
+	for (int i = 0; i < len; i++)
+		k[1 + i] = key.get_nibble(i);
+	return k;
+}
+
+static std::string key_char(const CHARSTRING &key)
+{
+	std::string k(1, (char)INDEX_KEY_CHAR);
+
+	k.append((const char *)key, key.lengthof());
+	return k;
+}
+
+static std::string key_int(const INTEGER &key)
+{
+	std::string k(1, (char)INDEX_KEY_INT);
+	/* not just int: TEIDs and the like exceed the native int range */
+	long long v = key.get_long_long_val();
+
+	k.append((const char *)&v, sizeof(v));
+	return k;
+}
+
+static BOOLEAN index_add(const INTEGER &idx, const std::string &key, const INTEGER &val)
+{
+	return index_get(idx).map.emplace(key, (int)val).second;
+}
+
+static INTEGER index_lookup(const INTEGER &idx, const std::string &key)
+{
+	struct index &ix = index_get(idx);
+	auto it = ix.map.find(key);
+
+	return it == ix.map.end() ? -1 : it->second;
+}
+
+static BOOLEAN index_del(const INTEGER &idx, const std::string &key)
+{
+	return index_get(idx).map.erase(key) > 0;
+}
+
+INTEGER f__index__new()
+{
+	size_t i;
+
+	for (i = 0; i < indexes.size(); i++) {
+		if (!indexes[i].in_use)
+			break;
+	}
+	if (i == indexes.size())
+		indexes.emplace_back();
+	index_reset(indexes[i]);
+	indexes[i].in_use = true;
+	return (int)i;
+}
+
+void f__index__free(const INTEGER &idx)
+{
+	struct index &ix = index_get(idx);
+
+	index_reset(ix);
+	ix.in_use = false;
+}
+
+void f__index__clear(const INTEGER &idx)
+{
+	index_reset(index_get(idx));
+}
+
+INTEGER f__index__size(const INTEGER &idx)
+{
+	return (int)index_get(idx).map.size();
+}
+
+BOOLEAN f__index__add__oct(const INTEGER &idx, const OCTETSTRING &key, const INTEGER &val)
+{
+	return index_add(idx, key_oct(key), val);
+}
+
+BOOLEAN f__index__add__hex(const INTEGER &idx, const HEXSTRING &key, const INTEGER &val)
+{
+	return index_add(idx, key_hex(key), val);
+}
+
+BOOLEAN f__index__add__char(const INTEGER &idx, const CHARSTRING &key, const INTEGER &val)
+{
+	return index_add(idx, key_char(key), val);
+}
+
+BOOLEAN f__index__add__int(const INTEGER &idx, const INTEGER &key, const INTEGER &val)
+{
+	return index_add(idx, key_int(key), val);
+}
+
+INTEGER f__index__get__oct(const INTEGER &idx, const OCTETSTRING &key)
+{
+	return index_lookup(idx, key_oct(key));
+}
+
+INTEGER f__index__get__hex(const INTEGER &idx, const HEXSTRING &key)
+{
+	return index_lookup(idx, key_hex(key));
+}
+
+INTEGER f__index__get__char(const INTEGER &idx, const CHARSTRING &key)
+{
+	return index_lookup(idx, key_char(key));
+}
+
+INTEGER f__index__get__int(const INTEGER &idx, const INTEGER &key)
+{
+	return index_lookup(idx, key_int(key));
+}
+
+BOOLEAN f__index__del__oct(const INTEGER &idx, const OCTETSTRING &key)
+{
+	return index_del(idx, key_oct(key));
+}
+
+BOOLEAN f__index__del__hex(const INTEGER &idx, const HEXSTRING &key)
+{
+	return index_del(idx, key_hex(key));
+}
+
+BOOLEAN f__index__del__char(const INTEGER &idx, const CHARSTRING &key)
+{
+	return index_del(idx, key_char(key));
+}
+
+BOOLEAN f__index__del__int(const INTEGER &idx, const INTEGER &key)
+{
+	return index_del(idx, key_int(key));
+}
+
+INTEGER f__index__slot__alloc(const INTEGER &idx)
+{
+	struct index &ix = index_get(idx);
+	int slot;
+
+	if (ix.free_slots.empty()) {
+		ix.slot_used.push_back(true);
+		return (int)ix.slot_used.size() - 1;
+	}
+	slot = ix.free_slots.top();
+	ix.free_slots.pop();
+	ix.slot_used[slot] = true;
+	return slot;
+}
+
+void f__index__slot__free(const INTEGER &idx, const INTEGER &slot)
+{
+	struct index &ix = index_get(idx);
+	int s = slot;
+
+	if (s < 0 || (size_t)s >= ix.slot_used.size())
+		TTCN_error("Index_Functions: freeing slot %d never allocated", s);
+	if (!ix.slot_used[s])
+		TTCN_error("Index_Functions: slot %d is not allocated (freed twice?)", s);
+	ix.slot_used[s] = false;
+	ix.free_slots.push(s);
+}
+
+}
@@ -7,128 +7,39 @@
 
 #include <stdint.h>
 
-extern "C" {
-
-typedef uint8_t ubit_t;
-typedef uint8_t pbit_t;
-
-static int osmo_pbit2ubit(ubit_t *out, const pbit_t *in, unsigned int num_bits)
-{
-	unsigned int i;
-	ubit_t *cur = out;
-	ubit_t *limit = out + num_bits;
-
-	for (i = 0; i < (num_bits/8)+1; i++) {
-		pbit_t byte = in[i];
-		*cur++ = (byte >> 7) & 1;
-		if (cur >= limit)
-			break;
-		*cur++ = (byte >> 6) & 1;
-		if (cur >= limit)
-			break;
-		*cur++ = (byte >> 5) & 1;
-		if (cur >= limit)
-			break;
-		*cur++ = (byte >> 4) & 1;
-		if (cur >= limit)
-			break;
-		*cur++ = (byte >> 3) & 1;
-		if (cur >= limit)
-			break;
-		*cur++ = (byte >> 2) & 1;
-		if (cur >= limit)
-			break;
-		*cur++ = (byte >> 1) & 1;
-		if (cur >= limit)
-			break;
-		*cur++ = (byte >> 0) & 1;
-		if (cur >= limit)
-			break;
-	}
-	return cur - out;
-}
-
-
-struct osmo_crc8gen_code {
-	int bits;           /*!< Actual number of bits of the CRC */
-	uint8_t poly;      /*!< Polynom (normal representation, MSB omitted */
-	uint8_t init;      /*!< Initialization value of the CRC state */
-	uint8_t remainder; /*!< Remainder of the CRC (final XOR) */
-};
-
-static uint8_t
-osmo_crc8gen_compute_bits(const struct osmo_crc8gen_code *code,
-                           const ubit_t *in, int len)
-{
-	const uint8_t poly = code->poly;
-	uint8_t crc = code->init;
-	int i, n = code->bits-1;
-
-	for (i=0; i<len; i++) {
-		uint8_t bit = in[i] & 1;
-		crc ^= (bit << n);
-		if (crc & ((uint8_t)1 << n)) {
-			crc <<= 1;
-			crc ^= poly;
-		} else {
-			crc <<= 1;
+/* Table driven CRC computation over packed bits (MSB first) for CRC widths
+ * up to 16 bits, with init = 0 and no final XOR.  The CRC register is kept
+ * left-aligned in 16 bits, so that the same byte-wise scheme works for the
+ * 6 bit header CRC as well as the 10 bit payload CRC. */
+struct iuup_crc_code {
+	int bits;		/*!< Actual number of bits of the CRC */
+	uint16_t poly;		/*!< Polynom (normal representation, MSB omitted */
+	uint16_t table[256];	/*!< Left-aligned register after shifting in one octet */
+
+	iuup_crc_code(int _bits, uint16_t _poly) : bits(_bits), poly(_poly)
+	{
+		const uint16_t poly16 = poly << (16 - bits);
+
+		for (int x = 0; x < 256; x++) {
+			uint16_t crc = x << 8;
+			for (int i = 0; i < 8; i++)
+				crc = (crc & 0x8000) ? (crc << 1) ^ poly16 : crc << 1;
+			table[x] = crc;
 		}
-		crc &= ((uint8_t)1 << code->bits) - 1;
 	}
 
-	crc ^= code->remainder;
-
-	return crc;
-}
+	uint16_t compute(const uint8_t *in, unsigned int len) const
+	{
+		uint16_t crc = 0;
 
-struct osmo_crc16gen_code {
-	int bits;           /*!< Actual number of bits of the CRC */
-	uint16_t poly;      /*!< Polynom (normal representation, MSB omitted */
-	uint16_t init;      /*!< Initialization value of the CRC state */
-	uint16_t remainder; /*!< Remainder of the CRC (final XOR) */
-};
-
-static uint16_t
-osmo_crc16gen_compute_bits(const struct osmo_crc16gen_code *code,
-                           const ubit_t *in, int len)
-{
-	const uint16_t poly = code->poly;
-	uint16_t crc = code->init;
-	int i, n = code->bits-1;
-
-	for (i=0; i<len; i++) {
-		uint16_t bit = in[i] & 1;
-		crc ^= (bit << n);
-		if (crc & ((uint16_t)1 << n)) {
-			crc <<= 1;
-			crc ^= poly;
-		} else {
-			crc <<= 1;
-		}
-		crc &= ((uint16_t)1 << code->bits) - 1;
+		while (len--)
+			crc = (crc << 8) ^ table[(crc >> 8) ^ *in++];
+		return crc >> (16 - bits);
 	}
-
-	crc ^= code->remainder;
-
-	return crc;
-}
-
-}
-
-
-static const struct osmo_crc8gen_code iuup_hdr_crc_code = {
-	.bits = 6,
-	.poly = 47,
-	.init = 0,
-	.remainder = 0,
 };
 
-static const struct osmo_crc16gen_code iuup_data_crc_code = {
-	.bits = 10,
-	.poly = 563,
-	.init = 0,
-	.remainder = 0,
-};
+static const struct iuup_crc_code iuup_hdr_crc_code(6, 47);
+static const struct iuup_crc_code iuup_data_crc_code(10, 563);
 
 static int iuup_get_payload_offset(const uint8_t *iuup_pdu)
 {
@@ -146,9 +57,8 @@ static int iuup_get_payload_offset(const uint8_t *iuup_pdu)
 
 int osmo_iuup_compute_payload_crc(const uint8_t *iuup_pdu, unsigned int pdu_len)
 {
-	ubit_t buf[1024*8];
 	uint8_t pdu_type;
-	int offset, payload_len_bytes;
+	int offset;
 
 	if (pdu_len < 1)
 		return -1;
@@ -166,21 +76,46 @@ int osmo_iuup_compute_payload_crc(const uint8_t *iuup_pdu, unsigned int pdu_len)
 	if (pdu_len < (unsigned int)offset)
 		return -1;
 
-	payload_len_bytes = pdu_len - offset;
-	osmo_pbit2ubit(buf, iuup_pdu+offset, payload_len_bytes*8);
-	return osmo_crc16gen_compute_bits(&iuup_data_crc_code, buf, payload_len_bytes*8);
+	return iuup_data_crc_code.compute(iuup_pdu + offset, pdu_len - offset);
 }
 
 int osmo_iuup_compute_header_crc(const uint8_t *iuup_pdu, unsigned int pdu_len)
 {
-	ubit_t buf[2*8];
-
 	if (pdu_len < 2)
 		return -1;
 
-	osmo_pbit2ubit(buf, iuup_pdu, 2*8);
-	return osmo_crc8gen_compute_bits(&iuup_hdr_crc_code, buf, 2*8);
+	return iuup_hdr_crc_code.compute(iuup_pdu, 2);
 }
+
+/* Verify header and (if present) payload CRC of a received IuUP PDU.
+ * Returns 0 if both match, -1 on a malformed PDU, -2 on a header CRC error
+ * and -3 on a payload CRC error. */
+int osmo_iuup_check_crc(const uint8_t *iuup_pdu, unsigned int pdu_len)
+{
+	int offset, crc;
+
+	if (pdu_len < 3)
+		return -1;
+
+	offset = iuup_get_payload_offset(iuup_pdu);
+	if (offset < 0 || pdu_len < (unsigned int)offset)
+		return -1;
+
+	crc = osmo_iuup_compute_header_crc(iuup_pdu, pdu_len);
+	if (crc != iuup_pdu[2] >> 2)
+		return -2;
+
+	/* Type 1 has no payload CRC */
+	if (offset == 3)
+		return 0;
+
+	crc = osmo_iuup_compute_payload_crc(iuup_pdu, pdu_len);
+	if (crc != (((iuup_pdu[2] & 0x03) << 8) | iuup_pdu[3]))
+		return -3;
+
+	return 0;
+}
+
 /* IuUP CRC Implementation */
 
 /* (C) 2017 by Harald Welte <laforge@gnumonks.org>
@@ -227,22 +162,76 @@ INTEGER f__IuUP__compute__crc__header(OCTETSTRING const &in)
 	return INTEGER(crc_calc);
 }
 
+INTEGER f__IuUP__check__crc(OCTETSTRING const &in)
+{
+	const unsigned char *data = (const unsigned char *)in;
+	int len = in.lengthof();
+
+	return INTEGER(osmo_iuup_check_crc(data, len));
+}
+
+/* Patch header CRC (and, for PDU types 0 and 14, the payload CRC) into an
+ * already encoded IuUP PDU in-place */
+static void iuup_patch_crc(uint8_t *iuup_pdu, unsigned int pdu_len)
+{
+	int offset = iuup_get_payload_offset(iuup_pdu);
+	int crc_hdr, crc_payload;
+
+	if (offset < 0 || pdu_len < (unsigned int)offset)
+		TTCN_error("Cannot compute CRC of malformed IuUP PDU (len=%u)", pdu_len);
+
+	crc_hdr = osmo_iuup_compute_header_crc(iuup_pdu, pdu_len);
+	if (offset == 3) {
+		/* Type 1 has no payload CRC, leave the spare bits alone */
+		iuup_pdu[2] = ((crc_hdr & 0x3f) << 2) | (iuup_pdu[2] & 0x03);
+		return;
+	}
+
+	crc_payload = osmo_iuup_compute_payload_crc(iuup_pdu, pdu_len);
+	iuup_pdu[2] = ((crc_hdr & 0x3f) << 2) | ((crc_payload & 0x3ff) >> 8);
+	iuup_pdu[3] = crc_payload & 0xff;
+}
+
 OCTETSTRING f__enc__IuUP__PDU(const IuUP__PDU& pdu)
 {
 	TTCN_Buffer buf;
-	int crc_hdr, crc_payload;
-	uint8_t in[2];
+	OCTETSTRING ret_val;
+
 	pdu.encode(IuUP__PDU_descr_, buf, TTCN_EncDec::CT_RAW);
-	OCTETSTRING ret_val(buf.get_len(), buf.get_data());
 
-	crc_hdr = osmo_iuup_compute_header_crc(buf.get_data(), buf.get_len());
-	crc_payload = osmo_iuup_compute_payload_crc(buf.get_data(), buf.get_len());
-	in[0] = (crc_hdr & 0x3f) << 2;
-	in[0] |= (crc_payload & 0x3ff) >> 8;
-	in[1] = crc_payload & 0xff;
-	OCTETSTRING CHECKSUM(2, in);
+	/* The buffer is private to us, so fill in the CRCs right where the RAW
+	 * encoder left the (zero) placeholders instead of re-assembling the PDU */
+	iuup_patch_crc((uint8_t *)buf.get_data(), buf.get_len());
+	buf.get_string(ret_val);
 
-	ret_val = substr(ret_val, 0, 2) + CHECKSUM + substr(ret_val, 4, ret_val.lengthof()-4);
+	return ret_val;
+}
+
+/* Derive the next frame of a constant-payload IuUP data stream from a
+ * template frame (as returned by f_enc_IuUP_PDU): Only the frame number and
+ * the header CRC change, the payload CRC of the template remains valid. */
+OCTETSTRING f__IuUP__tmpl__frame__set__nr(OCTETSTRING const &tmpl, INTEGER const &frame_nr)
+{
+	const uint8_t *data = (const uint8_t *)tmpl;
+	int len = tmpl.lengthof();
+	uint8_t hdr[3];
+	int offset;
+
+	if (len < 3)
+		TTCN_error("IuUP template frame too short (len=%d)", len);
+
+	offset = iuup_get_payload_offset(data);
+	if (offset < 0 || (data[0] >> 4) == 14 || len < offset)
+		TTCN_error("IuUP template frame is not a data PDU (type 0 or 1)");
+
+	hdr[0] = (data[0] & 0xf0) | ((int)frame_nr & 0x0f);
+	hdr[1] = data[1];
+	hdr[2] = (osmo_iuup_compute_header_crc(hdr, 2) << 2) | (data[2] & 0x03);
+
+	/* one copy of the template, then overwrite the two modified octets */
+	OCTETSTRING ret_val(tmpl);
+	ret_val[0] = OCTETSTRING(1, &hdr[0]);
+	ret_val[2] = OCTETSTRING(1, &hdr[2]);
 
 	return ret_val;
 }
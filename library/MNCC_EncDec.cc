@@ -1,3 +1,7 @@
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+
 #include "mncc.h"
 #include "MNCC_Types.hh"
 
@@ -5,14 +9,117 @@
 
 namespace MNCC__Types {
 
-static int mncc_sock_version = MNCC_SOCK_VERSION;
+/* Layout of struct gsm_mncc as announced by the sizes/offsets in a
+ * MNCC_SOCKET_HELLO (MNCC_Layout in TTCN-3).  All fields up to and including
+ * lchan_mode are the same in every supported version, only the presence and
+ * position of the gcr/sdp tail (and thus the message size) differs; it is
+ * derived from the announced mncc_size, so that encoding and decoding can use
+ * plain offsets instead of checking the version. */
+struct mncc_layout {
+	/* as announced in the hello */
+	uint32_t version;
+	uint32_t mncc_size;
+	uint32_t data_frame_size;
+	uint32_t called_offset;
+	uint32_t signal_offset;
+	uint32_t emergency_offset;
+	uint32_t lchan_type_offset;
+	/* derived */
+	int32_t gcr_offset;	/* -1 if not present */
+	uint32_t sdp_offset;
+	uint32_t sdp_len;	/* 0 if not present */
+	uint32_t min_len;	/* minimum length of a received signal message */
+};
+
+static void mncc_layout_derive(struct mncc_layout *l)
+{
+	const uint32_t common_len = offsetof(struct gsm_mncc, v7);
+	const uint32_t v8_len = offsetof(struct gsm_mncc, v8.sdp) + sizeof(((struct gsm_mncc *)0)->v8.sdp);
+
+	if (l->called_offset != offsetof(struct gsm_mncc, called) ||
+	    l->signal_offset != offsetof(struct gsm_mncc, signal) ||
+	    l->emergency_offset != offsetof(struct gsm_mncc, emergency) ||
+	    (l->lchan_type_offset && l->lchan_type_offset != offsetof(struct gsm_mncc, lchan_type)))
+		TTCN_error("MNCCv%u layout (called %u, signal %u, emergency %u, lchan_type %u) "
+			   "not supported", l->version, l->called_offset, l->signal_offset,
+			   l->emergency_offset, l->lchan_type_offset);
+	if (l->data_frame_size != sizeof(struct gsm_data_frame))
+		TTCN_error("MNCCv%u data frame size %u not supported", l->version, l->data_frame_size);
+	if (l->mncc_size < common_len)
+		TTCN_error("MNCCv%u size %u too short", l->version, l->mncc_size);
+
+	/* only a struct with room for gcr and the full sdp behind it has a gcr */
+	if (l->mncc_size >= v8_len) {
+		l->gcr_offset = offsetof(struct gsm_mncc, v8.gcr);
+		l->sdp_offset = offsetof(struct gsm_mncc, v8.sdp);
+	} else {
+		l->gcr_offset = -1;
+		l->sdp_offset = offsetof(struct gsm_mncc, v7.sdp);
+	}
+	l->sdp_len = 0;
+	if (l->mncc_size > l->sdp_offset)
+		l->sdp_len = std::min<uint32_t>(l->mncc_size - l->sdp_offset,
+						sizeof(((struct gsm_mncc *)0)->v8.sdp));
+	l->min_len = l->sdp_len ? l->sdp_offset + l->sdp_len : l->mncc_size;
+}
+
+static struct mncc_layout mncc_layout(const MNCC__Layout& in)
+{
+	struct mncc_layout l;
+
+	l.version = in.version();
+	l.mncc_size = in.mncc__size();
+	l.data_frame_size = in.data__frame__size();
+	l.called_offset = in.called__offset();
+	l.signal_offset = in.signal__offset();
+	l.emergency_offset = in.emergency__offset();
+	l.lchan_type_offset = in.lchan__type__offset();
+	mncc_layout_derive(&l);
+	return l;
+}
+
+/* layout of the struct gsm_mncc in mncc.h for the given version */
+static struct mncc_layout mncc_builtin_layout(uint32_t version)
+{
+	struct mncc_layout l;
+	size_t tail_len;
+
+	memset(&l, 0, sizeof(l));
+	if (version >= 8)
+		tail_len = sizeof(((struct gsm_mncc *)0)->v8);
+	else
+		tail_len = sizeof(((struct gsm_mncc *)0)->v7);
+	l.version = version;
+	/* padded like the struct in the peer would be */
+	l.mncc_size = (offsetof(struct gsm_mncc, v7) + tail_len + alignof(struct gsm_mncc) - 1)
+			& ~(alignof(struct gsm_mncc) - 1);
+	l.data_frame_size = sizeof(struct gsm_data_frame);
+	l.called_offset = offsetof(struct gsm_mncc, called);
+	l.signal_offset = offsetof(struct gsm_mncc, signal);
+	l.emergency_offset = offsetof(struct gsm_mncc, emergency);
+	l.lchan_type_offset = offsetof(struct gsm_mncc, lchan_type);
+	mncc_layout_derive(&l);
+	return l;
+}
+
+/* layout used by enc_MNCC_PDU() / dec_MNCC_PDU(), i.e. by the MNCC_CodecPort */
+static const struct mncc_layout mncc_default_layout = mncc_builtin_layout(MNCC_SOCK_VERSION);
 
-BOOLEAN set__MNCC__version(INTEGER const& version)
+MNCC__Layout f__MNCC__layout__builtin(const INTEGER& version)
 {
 	if (version != 7 && version != 8)
-		return false;
-	mncc_sock_version = version;
-	return true;
+		TTCN_error("MNCCv%d not supported", (int) version);
+	struct mncc_layout l = mncc_builtin_layout((int) version);
+	return MNCC__Layout(l.version, l.mncc_size, l.data_frame_size, l.called_offset,
+			    l.signal_offset, l.emergency_offset, l.lchan_type_offset);
+}
+
+MNCC__Layout f__MNCC__layout__from__hello(const MNCC__PDU__Hello& hello)
+{
+	/* reject layouts we can't encode/decode right away, not on the
+	 * first signal message */
+	(void) mncc_layout(hello);
+	return hello;
 }
 
 static void enc_bcap(struct gsm_mncc_bearer_cap *out, const MNCC__bearer__cap& in)
@@ -77,315 +184,405 @@ static void enc_number(struct gsm_mncc_number *num, const MNCC__number& in)
 	strncpy(num->number, in.number(), sizeof(num->number));
 }
 
+/* decode a fixed size char[] field, which the peer isn't guaranteed to have
+ * NUL terminated */
+static CHARSTRING dec_str(const char *str, size_t max_len)
+{
+	return CHARSTRING(strnlen(str, max_len), str);
+}
+
 static MNCC__number dec_number(const struct gsm_mncc_number *num)
 {
-	return MNCC__number(num->type, num->plan,num->present, num->screen, num->number);
+	return MNCC__number(num->type, num->plan,num->present, num->screen,
+			    dec_str(num->number, sizeof(num->number)));
 }
 
-OCTETSTRING enc__MNCC__PDU(const MNCC__PDU& in)
+/* Reserve len zero-initialized octets in the (empty) buffer.  The encoder fills
+ * in the message in place; TTCN_Buffer::get_string() then hands the memory
+ * over to the resulting OCTETSTRING. */
+static void *mncc_enc_reserve(TTCN_Buffer& ttcn_buffer, size_t len)
 {
-	struct gsm_mncc mncc;
-	OCTETSTRING ret_val;
-	TTCN_Buffer ttcn_buffer;
+	unsigned char *ptr = NULL;
+	size_t avail = len;
+
+	ttcn_buffer.get_end(ptr, avail);
+	memset(ptr, 0, len);
+	ttcn_buffer.increase_length(len);
+	return ptr;
+}
+
+static void enc_signal(struct gsm_mncc *mncc, const MNCC__PDU__Signal& in_sig,
+		       const struct mncc_layout *l)
+{
+	mncc->callref = in_sig.callref();
+	if (in_sig.bearer__cap().is_value()) {
+		enc_bcap(&mncc->bearer_cap, in_sig.bearer__cap());
+		mncc->fields |= MNCC_F_BEARER_CAP;
+	}
+	if (in_sig.called().is_value()) {
+		enc_number(&mncc->called, in_sig.called());
+		mncc->fields |= MNCC_F_CALLED;
+	}
+	if (in_sig.calling().is_value()) {
+		enc_number(&mncc->calling, in_sig.calling());
+		mncc->fields |= MNCC_F_CALLING;
+	}
+	if (in_sig.redirecting().is_value()) {
+		enc_number(&mncc->redirecting, in_sig.redirecting());
+		mncc->fields |= MNCC_F_REDIRECTING;
+	}
+	if (in_sig.connected().is_value()) {
+		enc_number(&mncc->connected, in_sig.connected());
+		mncc->fields |= MNCC_F_CONNECTED;
+	}
+	if (in_sig.cause().is_value()) {
+		const MNCC__cause &cause = in_sig.cause();
+		const OCTETSTRING &diag = cause.diag();
+		mncc->cause.location = cause.location();
+		mncc->cause.coding = cause.coding();
+		mncc->cause.rec = cause.rec();
+		mncc->cause.rec_val = cause.rec__val();
+		mncc->cause.value = cause.val();
+		mncc->cause.diag_len = diag.lengthof();
+		if (mncc->cause.diag_len > (int) sizeof(mncc->cause.diag))
+			TTCN_error("MNCC diagnostics length %u too long", mncc->cause.diag_len);
+		memcpy(mncc->cause.diag, (const unsigned char *) diag, mncc->cause.diag_len);
+		mncc->fields |= MNCC_F_CAUSE;
+	}
+	if (in_sig.progress().is_value()) {
+		const MNCC__progress &progress = in_sig.progress();
+		mncc->progress.coding = progress.coding();
+		mncc->progress.location = progress.location();
+		mncc->progress.descr = progress.descr();
+		mncc->fields |= MNCC_F_PROGRESS;
+	}
+	if (in_sig.useruser().is_value()) {
+		const MNCC__useruser &useruser = in_sig.useruser();
+		mncc->useruser.proto = useruser.proto();
+		strncpy(mncc->useruser.info, useruser.info(), sizeof(mncc->useruser.info));
+		mncc->fields |= MNCC_F_USERUSER;
+	}
+	if (in_sig.facility().is_value()) {
+		const CHARSTRING &fac = in_sig.facility();
+		strncpy(mncc->facility.info, fac, sizeof(mncc->facility.info));
+		mncc->facility.len = strnlen(mncc->facility.info, sizeof(mncc->facility.info));
+		mncc->fields |= MNCC_F_FACILITY;
+	}
+	if (in_sig.cccap().is_value()) {
+		const MNCC__cccap &cccap = in_sig.cccap();
+		mncc->cccap.dtmf = cccap.dtmf();
+		mncc->cccap.pcp = cccap.pcp();
+		mncc->fields |= MNCC_F_CCCAP;
+	}
+	if (in_sig.ssversion().is_value()) {
+		const CHARSTRING &ssv = in_sig.ssversion();
+		strncpy(mncc->ssversion.info, ssv, sizeof(mncc->ssversion.info));
+		mncc->ssversion.len = strnlen(mncc->ssversion.info, sizeof(mncc->ssversion.info));
+		mncc->fields |= MNCC_F_SSVERSION;
+	}
+	mncc->clir.sup = in_sig.clir__sup();
+	mncc->clir.inv = in_sig.clir__inv();
+	if (in_sig.signal().is_value()) {
+		const INTEGER &sig = in_sig.signal();
+		mncc->signal = sig;
+		mncc->fields |= MNCC_F_SIGNAL;
+	}
+	if (in_sig.keypad().is_value()) {
+		const CHARSTRING &kpd = in_sig.keypad();
+		mncc->signal = (int) kpd[0].get_char();
+		mncc->fields |= MNCC_F_KEYPAD;
+	}
+	mncc->more = in_sig.more();
+	mncc->notify = in_sig.notify();
+	if (in_sig.emergency().is_value()) {
+		const INTEGER &emerg = in_sig.emergency();
+		mncc->emergency = emerg;
+		mncc->fields |= MNCC_F_EMERGENCY;
+	}
+	strncpy(mncc->imsi, in_sig.imsi(), sizeof(mncc->imsi));
+	mncc->lchan_type = in_sig.lchan__type();
+	mncc->lchan_mode = in_sig.lchan__mode();
+	if (in_sig.gcr().is_value()) {
+		const OCTETSTRING &gcr = in_sig.gcr();
+		if (l->gcr_offset < 0)
+			TTCN_error("GCR is only available since MNCCv8");
+		if (gcr.lengthof() != sizeof(mncc->v8.gcr))
+			TTCN_error("MNCC GCR length %d invalid", gcr.lengthof());
+		memcpy((uint8_t *) mncc + l->gcr_offset, (const unsigned char *) gcr,
+		       sizeof(mncc->v8.gcr));
+		mncc->fields |= MNCC_F_GCR;
+	}
+	if (in_sig.sdp().is_value()) {
+		const CHARSTRING &sdp = in_sig.sdp();
+		strncpy((char *) mncc + l->sdp_offset, sdp, l->sdp_len);
+	}
+}
+
+static void enc_rtp(struct gsm_mncc_rtp *rtp, const MNCC__PDU__Rtp& in_rtp)
+{
+	const OCTETSTRING &ip = in_rtp.ip();
+
+	rtp->callref = in_rtp.callref();
+	if (in_rtp.is__ipv6()) {
+		struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *) &rtp->addr;
+		if (ip.lengthof() != sizeof(sin6->sin6_addr))
+			TTCN_error("MNCC RTP IPv6 address length %d invalid", ip.lengthof());
+		sin6->sin6_family = AF_INET6;
+		memcpy(&sin6->sin6_addr, (const unsigned char *) ip, sizeof(sin6->sin6_addr));
+		sin6->sin6_port = htons(in_rtp.rtp__port());
+	} else {
+		struct sockaddr_in *sin = (struct sockaddr_in *) &rtp->addr;
+		if (ip.lengthof() != sizeof(sin->sin_addr))
+			TTCN_error("MNCC RTP IPv4 address length %d invalid", ip.lengthof());
+		sin->sin_family = AF_INET;
+		memcpy(&sin->sin_addr, (const unsigned char *) ip, sizeof(sin->sin_addr));
+		sin->sin_port = htons(in_rtp.rtp__port());
+	}
+	rtp->payload_type = in_rtp.payload__type();
+	rtp->payload_msg_type = in_rtp.payload__msg__type();
+	if (in_rtp.sdp().is_value()) {
+		const CHARSTRING &sdp = in_rtp.sdp();
+		strncpy(rtp->sdp, sdp, sizeof(rtp->sdp));
+	}
+}
+
+static void enc_hello(struct gsm_mncc_hello *hello, const MNCC__PDU__Hello& in_hello)
+{
+	hello->version = in_hello.version();
+	hello->mncc_size = in_hello.mncc__size();
+	hello->data_frame_size = in_hello.data__frame__size();
+	hello->called_offset = in_hello.called__offset();
+	hello->signal_offset = in_hello.signal__offset();
+	hello->emergency_offset = in_hello.emergency__offset();
+	hello->lchan_type_offset = in_hello.lchan__type__offset();
+}
 
-	memset(&mncc, 0, sizeof(mncc));
-	mncc.msg_type = in.msg__type();
+static OCTETSTRING enc_MNCC_PDU(const MNCC__PDU& in, const struct mncc_layout *l)
+{
+	TTCN_Buffer ttcn_buffer;
+	OCTETSTRING ret_val;
 
 	switch (in.u().get_selection()) {
 	case MNCC__MsgUnion::ALT_signal: {
-		const MNCC__PDU__Signal& in_sig = in.u().signal();
-		mncc.callref = in_sig.callref();
-		if (in_sig.bearer__cap().is_value()) {
-			enc_bcap(&mncc.bearer_cap, in_sig.bearer__cap());
-			mncc.fields |= MNCC_F_BEARER_CAP;
-		}
-		if (in_sig.called().is_value()) {
-			enc_number(&mncc.called, in_sig.called());
-			mncc.fields |= MNCC_F_CALLED;
-		}
-		if (in_sig.calling().is_value()) {
-			enc_number(&mncc.calling, in_sig.calling());
-			mncc.fields |= MNCC_F_CALLING;
-		}
-		if (in_sig.redirecting().is_value()) {
-			enc_number(&mncc.redirecting, in_sig.redirecting());
-			mncc.fields |= MNCC_F_REDIRECTING;
-		}
-		if (in_sig.connected().is_value()) {
-			enc_number(&mncc.connected, in_sig.connected());
-			mncc.fields |= MNCC_F_CONNECTED;
-		}
-		if (in_sig.cause().is_value()) {
-			const MNCC__cause &cause = in_sig.cause();
-			TTCN_Buffer ttcn_buffer(cause.diag());
-			mncc.cause.location = cause.location();
-			mncc.cause.coding = cause.coding();
-			mncc.cause.rec = cause.rec();
-			mncc.cause.rec_val = cause.rec__val();
-			mncc.cause.value = cause.val();
-			mncc.cause.diag_len = ttcn_buffer.get_len();
-			if (mncc.cause.diag_len > (int) sizeof(mncc.cause.diag)) {
-				TTCN_error("MNCC diagnostics length %u too long", mncc.cause.diag_len);
-				mncc.cause.diag_len = sizeof(mncc.cause.diag);
-			}
-			memcpy(mncc.cause.diag, ttcn_buffer.get_data(), ttcn_buffer.get_len());
-			mncc.fields |= MNCC_F_CAUSE;
-		}
-		if (in_sig.progress().is_value()) {
-			const MNCC__progress &progress = in_sig.progress();
-			mncc.progress.coding = progress.coding();
-			mncc.progress.location = progress.location();
-			mncc.progress.descr = progress.descr();
-			mncc.fields |= MNCC_F_PROGRESS;
-		}
-		if (in_sig.useruser().is_value()) {
-			const MNCC__useruser &useruser = in_sig.useruser();
-			mncc.useruser.proto = useruser.proto();
-			strncpy(mncc.useruser.info, useruser.info(), sizeof(mncc.useruser.info));
-			mncc.fields |= MNCC_F_USERUSER;
-		}
-		if (in_sig.facility().is_value()) {
-			const CHARSTRING &fac = in_sig.facility();
-			strncpy(mncc.facility.info, fac, sizeof(mncc.facility.info));
-			mncc.facility.len = strlen(mncc.facility.info);
-			mncc.fields |= MNCC_F_FACILITY;
-		}
-		if (in_sig.cccap().is_value()) {
-			const MNCC__cccap &cccap = in_sig.cccap();
-			mncc.cccap.dtmf = cccap.dtmf();
-			mncc.cccap.pcp = cccap.pcp();
-			mncc.fields |= MNCC_F_CCCAP;
-		}
-		if (in_sig.ssversion().is_value()) {
-			const CHARSTRING &ssv = in_sig.ssversion();
-			strncpy(mncc.ssversion.info, ssv, sizeof(mncc.ssversion.info));
-			mncc.ssversion.len = strlen(mncc.ssversion.info);
-			mncc.fields |= MNCC_F_SSVERSION;
-		}
-		mncc.clir.sup = in_sig.clir__sup();
-		mncc.clir.inv = in_sig.clir__inv();
-		if (in_sig.signal().is_value()) {
-			const INTEGER &sig = in_sig.signal();
-			mncc.signal = sig;
-			mncc.fields |= MNCC_F_SIGNAL;
-		}
-		if (in_sig.keypad().is_value()) {
-			const CHARSTRING &kpd = in_sig.keypad();
-			mncc.signal = (int) kpd[0].get_char();
-			mncc.fields |= MNCC_F_KEYPAD;
-		}
-		mncc.more = in_sig.more();
-		mncc.notify = in_sig.notify();
-		if (in_sig.emergency().is_value()) {
-			const INTEGER &emerg = in_sig.emergency();
-			mncc.emergency = emerg;
-			mncc.fields |= MNCC_F_EMERGENCY;
-		}
-		strncpy(mncc.imsi, in_sig.imsi(), sizeof(mncc.imsi));
-		mncc.lchan_type = in_sig.lchan__type();
-		mncc.lchan_mode = in_sig.lchan__mode();
-		if (in_sig.gcr().is_value()) {
-			const OCTETSTRING &gcr = in_sig.gcr();
-			if (mncc_sock_version < 8)
-				TTCN_error("GCR is only available since MNCCv8");
-			memcpy(&mncc.v8.gcr[0], gcr, sizeof(mncc.v8.gcr));
-			mncc.fields |= MNCC_F_GCR;
-		}
-		if (in_sig.sdp().is_value()) {
-			const CHARSTRING &sdp = in_sig.sdp();
-			if (mncc_sock_version > 7)
-				strncpy(&mncc.v8.sdp[0], sdp, sizeof(mncc.v8.sdp));
-			else
-				strncpy(&mncc.v7.sdp[0], sdp, sizeof(mncc.v7.sdp));
-		}
-		ret_val = OCTETSTRING(sizeof(mncc), (uint8_t *)&mncc);
-		}
+		struct gsm_mncc *mncc;
+		/* the buffer may be shorter than struct gsm_mncc for older
+		 * versions; only the common fields are accessed via the struct */
+		mncc = (struct gsm_mncc *) mncc_enc_reserve(ttcn_buffer, l->mncc_size);
+		mncc->msg_type = in.msg__type();
+		enc_signal(mncc, in.u().signal(), l);
 		break;
-	case MNCC__MsgUnion::ALT_data:
-		struct gsm_data_frame data;
-		memset(&data, 0, sizeof(data));
-		data.msg_type = in.msg__type();
-		ret_val = OCTETSTRING(sizeof(data), (uint8_t *)&data);
-		ret_val = ret_val & in.u().data().data();
+	}
+	case MNCC__MsgUnion::ALT_data: {
+		/* header and voice frame in one go, as this is sent for every frame */
+		const OCTETSTRING &payload = in.u().data().data();
+		struct gsm_data_frame *data;
+		data = (struct gsm_data_frame *) mncc_enc_reserve(ttcn_buffer,
+						sizeof(*data) + payload.lengthof());
+		data->msg_type = in.msg__type();
+		data->callref = in.u().data().callref();
+		memcpy(data->data, (const unsigned char *) payload, payload.lengthof());
 		break;
-	case MNCC__MsgUnion::ALT_rtp:
-		struct gsm_mncc_rtp rtp;
-		memset(&rtp, 0, sizeof(rtp));
-		rtp.msg_type = in.msg__type();
-		rtp.callref = in.u().rtp().callref();
-		ttcn_buffer.put_string(in.u().rtp().ip());
-		if (in.u().rtp().is__ipv6()) {
-			// if(in.u().rtp().ip().lengthof() != 16) print error
-			rtp.addr.ss_family = AF_INET6;
-			memcpy(&((struct sockaddr_in6*)&rtp.addr)->sin6_addr, ttcn_buffer.get_data(),
-			       sizeof(struct in6_addr));
-			((struct sockaddr_in6*)&rtp.addr)->sin6_port = htons(in.u().rtp().rtp__port());
-		} else {
-			// if(in.u().rtp().ip().lengthof() != 4) print error
-			rtp.addr.ss_family = AF_INET;
-			memcpy(&((struct sockaddr_in*)&rtp.addr)->sin_addr, ttcn_buffer.get_data(),
-			       sizeof(struct in_addr));
-			((struct sockaddr_in*)&rtp.addr)->sin_port = htons(in.u().rtp().rtp__port());
-		}
-		rtp.payload_type = in.u().rtp().payload__type();
-		rtp.payload_msg_type = in.u().rtp().payload__msg__type();
-		if (in.u().rtp().sdp().is_value()) {
-			const CHARSTRING &sdp = in.u().rtp().sdp();
-			strncpy(rtp.sdp, sdp, sizeof(rtp.sdp));
-		}
-		ret_val = OCTETSTRING(sizeof(rtp), (uint8_t *) &rtp);
+	}
+	case MNCC__MsgUnion::ALT_rtp: {
+		struct gsm_mncc_rtp *rtp;
+		rtp = (struct gsm_mncc_rtp *) mncc_enc_reserve(ttcn_buffer, sizeof(*rtp));
+		rtp->msg_type = in.msg__type();
+		enc_rtp(rtp, in.u().rtp());
 		break;
-	case MNCC__MsgUnion::ALT_hello:
-		struct gsm_mncc_hello hello;
-		memset(&hello, 0, sizeof(hello));
-		hello.msg_type = in.msg__type();
-		hello.version = in.u().hello().version();
-		hello.mncc_size = in.u().hello().mncc__size();
-		hello.data_frame_size = in.u().hello().data__frame__size();
-		hello.called_offset = in.u().hello().called__offset();
-		hello.signal_offset = in.u().hello().signal__offset();
-		hello.emergency_offset = in.u().hello().emergency__offset();
-		hello.lchan_type_offset = in.u().hello().lchan__type__offset();
-		ret_val = OCTETSTRING(sizeof(hello), (uint8_t *) &hello);
+	}
+	case MNCC__MsgUnion::ALT_hello: {
+		struct gsm_mncc_hello *hello;
+		hello = (struct gsm_mncc_hello *) mncc_enc_reserve(ttcn_buffer, sizeof(*hello));
+		hello->msg_type = in.msg__type();
+		enc_hello(hello, in.u().hello());
 		break;
 	}
+	default:
+		TTCN_error("Cannot encode unbound MNCC PDU");
+	}
 
+	ttcn_buffer.get_string(ret_val);
 	return ret_val;
 }
 
-MNCC__PDU dec__MNCC__PDU(const OCTETSTRING& in)
+OCTETSTRING enc__MNCC__PDU(const MNCC__PDU& in)
 {
-	TTCN_Buffer ttcn_buffer(in);
-	const struct gsm_mncc *in_mncc;
-	MNCC__PDU__Signal sign;
-	const struct gsm_mncc_hello *in_hello;
-	MNCC__PDU__Hello hello;
-	const struct gsm_data_frame *in_data;
-	MNCC__PDU__Data data;
-	const struct gsm_mncc_rtp *in_rtp;
-	MNCC__PDU__Rtp rtp;
-	MNCC__MsgUnion u;
-	bool is_ipv6;
-	OCTETSTRING ip;
-	uint16_t port;
-
-	in_mncc = (struct gsm_mncc *) ttcn_buffer.get_read_data();
+	return enc_MNCC_PDU(in, &mncc_default_layout);
+}
 
-	sign.set_implicit_omit();
-	hello.set_implicit_omit();
-	data.set_implicit_omit();
-	rtp.set_implicit_omit();
+OCTETSTRING enc__MNCC__PDU__layout(const MNCC__PDU& in, const MNCC__Layout& layout)
+{
+	struct mncc_layout l = mncc_layout(layout);
+	return enc_MNCC_PDU(in, &l);
+}
 
-	switch (in_mncc->msg_type) {
-	case MNCC_SOCKET_HELLO:
-		in_hello = (const struct gsm_mncc_hello *) in_mncc;
-		hello = MNCC__PDU__Hello(in_hello->version,
-					 in_hello->mncc_size,
-					 in_hello->data_frame_size,
-					 in_hello->called_offset,
-					 in_hello->signal_offset,
-					 in_hello->emergency_offset,
-					 in_hello->lchan_type_offset);
-		u.hello() = hello;
+static void dec_check_len(const char *what, size_t len, size_t min_len)
+{
+	if (len < min_len)
+		TTCN_error("MNCC %s too short: %zu < %zu octets", what, len, min_len);
+}
+
+static void dec_hello(MNCC__PDU__Hello& hello, const struct gsm_mncc_hello *in_hello)
+{
+	hello.version() = in_hello->version;
+	hello.mncc__size() = in_hello->mncc_size;
+	hello.data__frame__size() = in_hello->data_frame_size;
+	hello.called__offset() = in_hello->called_offset;
+	hello.signal__offset() = in_hello->signal_offset;
+	hello.emergency__offset() = in_hello->emergency_offset;
+	hello.lchan__type__offset() = in_hello->lchan_type_offset;
+}
+
+static void dec_rtp(MNCC__PDU__Rtp& rtp, const struct gsm_mncc_rtp *in_rtp)
+{
+	const struct sockaddr_in6 *sin6;
+	const struct sockaddr_in *sin;
+
+	rtp.callref() = in_rtp->callref;
+	switch (in_rtp->addr.ss_family) {
+	case AF_INET6:
+		sin6 = (const struct sockaddr_in6 *) &in_rtp->addr;
+		rtp.is__ipv6() = true;
+		rtp.ip() = OCTETSTRING(sizeof(sin6->sin6_addr), (const unsigned char *) &sin6->sin6_addr);
+		rtp.rtp__port() = ntohs(sin6->sin6_port);
 		break;
+	case AF_UNSPEC: //RTP_CREATE and RTP_FREE can contain fully zeroed addr
+	case AF_INET:
+		sin = (const struct sockaddr_in *) &in_rtp->addr;
+		rtp.is__ipv6() = false;
+		rtp.ip() = OCTETSTRING(sizeof(sin->sin_addr), (const unsigned char *) &sin->sin_addr);
+		rtp.rtp__port() = ntohs(sin->sin_port);
+		break;
+	default:
+		TTCN_error("MNCC RTP address family %u unsupported", in_rtp->addr.ss_family);
+	}
+	rtp.payload__type() = in_rtp->payload_type;
+	rtp.payload__msg__type() = in_rtp->payload_msg_type;
+	rtp.sdp() = dec_str(in_rtp->sdp, sizeof(in_rtp->sdp));
+}
+
+static void dec_signal(MNCC__PDU__Signal& sign, const struct gsm_mncc *in_mncc,
+		       const struct mncc_layout *l)
+{
+	sign.callref() = in_mncc->callref;
+	if (in_mncc->fields & MNCC_F_BEARER_CAP) {
+		sign.bearer__cap() = dec_bcap(&in_mncc->bearer_cap);
+	}
+	if (in_mncc->fields & MNCC_F_CALLED)
+		sign.called() = dec_number(&in_mncc->called);
+	if (in_mncc->fields & MNCC_F_CALLING)
+		sign.calling() = dec_number(&in_mncc->calling);
+	if (in_mncc->fields & MNCC_F_REDIRECTING)
+		sign.redirecting() = dec_number(&in_mncc->redirecting);
+	if (in_mncc->fields & MNCC_F_CONNECTED)
+		sign.connected() = dec_number(&in_mncc->connected);
+	if (in_mncc->fields & MNCC_F_CAUSE) {
+		if (in_mncc->cause.diag_len < 0 ||
+		    in_mncc->cause.diag_len > (int) sizeof(in_mncc->cause.diag))
+			TTCN_error("MNCC diagnostics length %d invalid", in_mncc->cause.diag_len);
+		sign.cause() = MNCC__cause(in_mncc->cause.location,
+					   in_mncc->cause.coding,
+					   in_mncc->cause.rec,
+					   in_mncc->cause.rec_val,
+					   in_mncc->cause.value,
+					   OCTETSTRING(in_mncc->cause.diag_len,
+							(const uint8_t *)in_mncc->cause.diag));
+	}
+	if (in_mncc->fields & MNCC_F_USERUSER) {
+		sign.useruser() = MNCC__useruser(in_mncc->useruser.proto,
+						 dec_str(in_mncc->useruser.info,
+							 sizeof(in_mncc->useruser.info)));
+	}
+	if (in_mncc->fields & MNCC_F_PROGRESS) {
+		sign.progress() = MNCC__progress(in_mncc->progress.coding,
+						 in_mncc->progress.location,
+						 in_mncc->progress.descr);
+	}
+	if (in_mncc->fields & MNCC_F_EMERGENCY)
+		sign.emergency() = in_mncc->emergency;
+	if (in_mncc->fields & MNCC_F_FACILITY)
+		sign.facility() = dec_str(in_mncc->facility.info, sizeof(in_mncc->facility.info));
+	if (in_mncc->fields & MNCC_F_SSVERSION)
+		sign.ssversion() = dec_str(in_mncc->ssversion.info, sizeof(in_mncc->ssversion.info));
+	if (in_mncc->fields & MNCC_F_CCCAP)
+		sign.cccap() = MNCC__cccap(in_mncc->cccap.dtmf, in_mncc->cccap.pcp);
+	if (in_mncc->fields & MNCC_F_KEYPAD) {
+		char kpd[2] = { (char) in_mncc->keypad, 0 };
+		sign.keypad() = CHARSTRING(kpd);
+	}
+	if (in_mncc->fields & MNCC_F_SIGNAL)
+		sign.signal() = in_mncc->signal;
+
+	sign.clir__sup() = in_mncc->clir.sup;
+	sign.clir__inv() = in_mncc->clir.inv;
+	sign.more() = in_mncc->more;
+	sign.notify() = in_mncc->notify;
+	sign.imsi() = dec_str(in_mncc->imsi, sizeof(in_mncc->imsi));
+	sign.lchan__type() = in_mncc->lchan_type;
+	sign.lchan__mode() = in_mncc->lchan_mode;
+	if (l->gcr_offset >= 0 && (in_mncc->fields & MNCC_F_GCR))
+		sign.gcr() = OCTETSTRING(sizeof(in_mncc->v8.gcr),
+					 (const uint8_t *) in_mncc + l->gcr_offset);
+	if (l->sdp_len)
+		sign.sdp() = dec_str((const char *) in_mncc + l->sdp_offset, l->sdp_len);
+	sign.set_implicit_omit();
+}
+
+/* The message is decoded in place from the OCTETSTRING (no TTCN_Buffer copy)
+ * straight into the fields of the returned PDU, after checking that the input
+ * is long enough for the struct selected by msg_type. */
+static MNCC__PDU dec_MNCC_PDU(const OCTETSTRING& in, const struct mncc_layout *l)
+{
+	const unsigned char *buf = (const unsigned char *) in;
+	const size_t len = in.lengthof();
+	MNCC__PDU ret_val;
+	uint32_t msg_type;
+
+	dec_check_len("message", len, sizeof(msg_type));
+	memcpy(&msg_type, buf, sizeof(msg_type));
+	ret_val.msg__type() = (int) msg_type;
+
+	switch (msg_type) {
 	case GSM_TCHF_FRAME:
 	case GSM_TCHF_FRAME_EFR:
 	case GSM_TCHH_FRAME:
 	case GSM_TCH_FRAME_AMR:
-	case GSM_BAD_FRAME:
-		in_data = (const struct gsm_data_frame *) in_mncc;
-		u.data() = MNCC__PDU__Data(in_data->callref,
-					   substr(in, offsetof(struct gsm_data_frame, data),
-						  in.lengthof() - offsetof(struct gsm_data_frame, data)));
+	case GSM_BAD_FRAME: {
+		/* fast path for the voice frames relayed during a call */
+		const struct gsm_data_frame *in_data = (const struct gsm_data_frame *) buf;
+		MNCC__PDU__Data &data = ret_val.u().data();
+		dec_check_len("data frame", len, sizeof(*in_data));
+		data.callref() = in_data->callref;
+		data.data() = OCTETSTRING(len - sizeof(*in_data), in_data->data);
+		break;
+	}
+	case MNCC_SOCKET_HELLO:
+		dec_check_len("hello", len, sizeof(struct gsm_mncc_hello));
+		dec_hello(ret_val.u().hello(), (const struct gsm_mncc_hello *) buf);
 		break;
 	case MNCC_RTP_CREATE:
 	case MNCC_RTP_CONNECT:
 	case MNCC_RTP_FREE:
-		in_rtp = (const struct gsm_mncc_rtp *) in_mncc;
-		switch (in_rtp->addr.ss_family) {
-		case AF_INET6:
-			is_ipv6 = true;
-			port = ntohs(((struct sockaddr_in6*)&in_rtp->addr)->sin6_port);
-			ip = OCTETSTRING(sizeof(struct in6_addr),
-					(const unsigned char*)&((struct sockaddr_in6*)&in_rtp->addr)->sin6_addr);
-
-			break;
-		case AF_UNSPEC: //RTP_CREATE and RTP_FREE can contain fully zeroed addr
-		case AF_INET:
-			is_ipv6 = false;
-			port = ntohs(((struct sockaddr_in*)&in_rtp->addr)->sin_port);
-			ip = OCTETSTRING(sizeof(struct in_addr),
-					(const unsigned char*)&((struct sockaddr_in*)&in_rtp->addr)->sin_addr);
-			break;
-		}
-		rtp = MNCC__PDU__Rtp(in_rtp->callref, is_ipv6, ip, port, in_rtp->payload_type,
-				     in_rtp->payload_msg_type, in_rtp->sdp);
-		u.rtp() = rtp;
+		dec_check_len("RTP message", len, sizeof(struct gsm_mncc_rtp));
+		dec_rtp(ret_val.u().rtp(), (const struct gsm_mncc_rtp *) buf);
 		break;
 	default:
-		sign.callref() = in_mncc->callref;
-		if (in_mncc->fields & MNCC_F_BEARER_CAP) {
-			sign.bearer__cap() = dec_bcap(&in_mncc->bearer_cap);
-		}
-		if (in_mncc->fields & MNCC_F_CALLED)
-			sign.called() = dec_number(&in_mncc->called);
-		if (in_mncc->fields & MNCC_F_CALLING)
-			sign.calling() = dec_number(&in_mncc->calling);
-		if (in_mncc->fields & MNCC_F_REDIRECTING)
-			sign.redirecting() = dec_number(&in_mncc->redirecting);
-		if (in_mncc->fields & MNCC_F_CONNECTED)
-			sign.connected() = dec_number(&in_mncc->connected);
-		if (in_mncc->fields & MNCC_F_CAUSE) {
-			sign.cause() = MNCC__cause(in_mncc->cause.location,
-						   in_mncc->cause.coding,
-						   in_mncc->cause.rec,
-						   in_mncc->cause.rec_val,
-						   in_mncc->cause.value,
-						   OCTETSTRING(in_mncc->cause.diag_len,
-								(const uint8_t *)in_mncc->cause.diag));
-		}
-		if (in_mncc->fields & MNCC_F_USERUSER) {
-			sign.useruser() = MNCC__useruser(in_mncc->useruser.proto,
-							 CHARSTRING(in_mncc->useruser.info));
-		}
-		if (in_mncc->fields & MNCC_F_PROGRESS) {
-			sign.progress() = MNCC__progress(in_mncc->progress.coding,
-							 in_mncc->progress.location,
-							 in_mncc->progress.descr);
-		}
-		if (in_mncc->fields & MNCC_F_EMERGENCY)
-			sign.emergency() = in_mncc->emergency;
-		if (in_mncc->fields & MNCC_F_FACILITY)
-			sign.facility() = CHARSTRING(in_mncc->facility.info);
-		if (in_mncc->fields & MNCC_F_SSVERSION)
-			sign.ssversion() = CHARSTRING(in_mncc->ssversion.info);
-		if (in_mncc->fields & MNCC_F_CCCAP)
-			sign.cccap() = MNCC__cccap(in_mncc->cccap.dtmf, in_mncc->cccap.pcp);
-		if (in_mncc->fields & MNCC_F_KEYPAD) {
-			char kpd[2] = { (char) in_mncc->keypad, 0 };
-			sign.keypad() = CHARSTRING(kpd);
-		}
-		if (in_mncc->fields & MNCC_F_SIGNAL)
-			sign.signal() = in_mncc->signal;
-
-		sign.clir__sup() = in_mncc->clir.sup;
-		sign.clir__inv() = in_mncc->clir.inv;
-		sign.more() = in_mncc->more;
-		sign.notify() = in_mncc->notify;
-		sign.imsi() = CHARSTRING(in_mncc->imsi);
-		sign.lchan__type() = in_mncc->lchan_type;
-		sign.lchan__mode() = in_mncc->lchan_mode;
-		if (mncc_sock_version > 7) {
-			if (in_mncc->fields & MNCC_F_GCR)
-				sign.gcr() = OCTETSTRING(sizeof(in_mncc->v8.gcr), in_mncc->v8.gcr);
-			sign.sdp() = in_mncc->v8.sdp;
-		} else {
-			sign.sdp() = in_mncc->v7.sdp;
-		}
-		u.signal() = sign;
+		dec_check_len("signal message", len, l->min_len);
+		dec_signal(ret_val.u().signal(), (const struct gsm_mncc *) buf, l);
 		break;
 	}
-	return MNCC__PDU(in_mncc->msg_type, u);
+	return ret_val;
+}
+
+MNCC__PDU dec__MNCC__PDU(const OCTETSTRING& in)
+{
+	return dec_MNCC_PDU(in, &mncc_default_layout);
+}
+
+MNCC__PDU dec__MNCC__PDU__layout(const OCTETSTRING& in, const MNCC__Layout& layout)
+{
+	struct mncc_layout l = mncc_layout(layout);
+	return dec_MNCC_PDU(in, &l);
 }
 
 }
@@ -13,7 +13,7 @@
 #include <Octetstring.hh>
 #include <Bitstring.hh>
 
-#include "key_derivation.h"
+#include "ng_key_derivation.h"
 
 namespace NG__CryptoFunctions {
 
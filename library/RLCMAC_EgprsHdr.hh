@@ -0,0 +1,130 @@
+#ifndef RLCMAC_EGPRS_HDR_HH
+#define RLCMAC_EGPRS_HDR_HH
+
+/* TS 44.060 EGPRS RLC/MAC header field descriptors and the generic
+ * pack/unpack kernels operating on them.  Kept free of TITAN dependencies,
+ * so that RLCMAC_EgprsHdr_bench.cc can build them stand-alone.
+ *
+ * Released under the terms of GNU General Public License, Version 2 or
+ * (at your option) any later version.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <endian.h>
+
+namespace RLCMAC__Types {
+
+/* Position of a field within an EGPRS RLC/MAC header, counted lsb-first
+ * from bit 0 of the first octet (i.e. within the header loaded as little
+ * endian integer).  Fields split across octet boundaries (tfi_hi/tfi_lo,
+ * ...) are contiguous in this numbering.  A width of 0 marks a field which
+ * doesn't exist in the given header type. */
+struct egprs_hdr_field {
+	uint8_t offset;
+	uint8_t width;
+};
+
+struct egprs_ul_hdr_desc {
+	uint8_t type; /* EGPRS header type 1..3 */
+	uint8_t len;
+	struct egprs_hdr_field r, si, cv, tfi, bsn1, bsn2, cps, spb, rsb, pi;
+};
+
+struct egprs_dl_hdr_desc {
+	uint8_t type; /* EGPRS header type 1..3 */
+	uint8_t len;
+	struct egprs_hdr_field usf, es_p, rrbp, tfi, pr, bsn1, bsn2, cps, spb;
+};
+
+/* TS 04.60  10.3a.4.1.1 */
+static constexpr struct egprs_ul_hdr_desc egprs_ul_hdr_1 = {
+	1, 6,
+	/* r */ {0, 1}, /* si */ {1, 1}, /* cv */ {2, 4}, /* tfi */ {6, 5},
+	/* bsn1 */ {11, 11}, /* bsn2 */ {22, 10}, /* cps */ {32, 5}, /* spb */ {0, 0},
+	/* rsb */ {37, 1}, /* pi */ {38, 1},
+};
+
+/* TS 04.60  10.3a.4.2.1 */
+static constexpr struct egprs_ul_hdr_desc egprs_ul_hdr_2 = {
+	2, 5,
+	/* r */ {0, 1}, /* si */ {1, 1}, /* cv */ {2, 4}, /* tfi */ {6, 5},
+	/* bsn1 */ {11, 11}, /* bsn2 */ {0, 0}, /* cps */ {22, 3}, /* spb */ {0, 0},
+	/* rsb */ {25, 1}, /* pi */ {26, 1},
+};
+
+/* TS 04.60  10.3a.4.3.1 */
+static constexpr struct egprs_ul_hdr_desc egprs_ul_hdr_3 = {
+	3, 4,
+	/* r */ {0, 1}, /* si */ {1, 1}, /* cv */ {2, 4}, /* tfi */ {6, 5},
+	/* bsn1 */ {11, 11}, /* bsn2 */ {0, 0}, /* cps */ {22, 4}, /* spb */ {26, 2},
+	/* rsb */ {28, 1}, /* pi */ {29, 1},
+};
+
+/* TS 04.60  10.3a.3.1 */
+static constexpr struct egprs_dl_hdr_desc egprs_dl_hdr_1 = {
+	1, 5,
+	/* usf */ {0, 3}, /* es_p */ {3, 2}, /* rrbp */ {5, 2}, /* tfi */ {7, 5},
+	/* pr */ {12, 2}, /* bsn1 */ {14, 11}, /* bsn2 */ {25, 10}, /* cps */ {35, 5},
+	/* spb */ {0, 0},
+};
+
+/* TS 04.60  10.3a.3.2 */
+static constexpr struct egprs_dl_hdr_desc egprs_dl_hdr_2 = {
+	2, 4,
+	/* usf */ {0, 3}, /* es_p */ {3, 2}, /* rrbp */ {5, 2}, /* tfi */ {7, 5},
+	/* pr */ {12, 2}, /* bsn1 */ {14, 11}, /* bsn2 */ {0, 0}, /* cps */ {25, 3},
+	/* spb */ {0, 0},
+};
+
+/* TS 04.60  10.3a.3.3 */
+static constexpr struct egprs_dl_hdr_desc egprs_dl_hdr_3 = {
+	3, 4,
+	/* usf */ {0, 3}, /* es_p */ {3, 2}, /* rrbp */ {5, 2}, /* tfi */ {7, 5},
+	/* pr */ {12, 2}, /* bsn1 */ {14, 11}, /* bsn2 */ {0, 0}, /* cps */ {25, 4},
+	/* spb */ {29, 2},
+};
+
+/* load/store the first LEN (4..8) octets of a header as little endian
+ * integer, independent of the host byte order.  All conditions are constant,
+ * so this reduces to one 32 bit access plus one per remaining octet. */
+template <unsigned int LEN>
+static inline uint64_t egprs_hdr_load(const uint8_t *data)
+{
+	static_assert(LEN >= 4 && LEN <= 8, "EGPRS header length out of range");
+	uint32_t lo;
+	uint64_t w;
+
+	memcpy(&lo, data, sizeof(lo));
+	w = le32toh(lo);
+	for (unsigned int i = 4; i < LEN; i++)
+		w |= (uint64_t)data[i] << (8 * i);
+	return w;
+}
+
+template <unsigned int LEN>
+static inline void egprs_hdr_store(uint8_t *data, uint64_t w)
+{
+	static_assert(LEN >= 4 && LEN <= 8, "EGPRS header length out of range");
+	uint32_t lo = htole32((uint32_t)w);
+
+	memcpy(data, &lo, sizeof(lo));
+	for (unsigned int i = 4; i < LEN; i++)
+		data[i] = w >> (8 * i);
+}
+
+static constexpr unsigned int egprs_hdr_get(uint64_t w, struct egprs_hdr_field f)
+{
+	return f.width ? (w >> f.offset) & ((1ULL << f.width) - 1) : 0;
+}
+
+static constexpr uint64_t egprs_hdr_put(uint64_t w, struct egprs_hdr_field f, unsigned int val)
+{
+	return f.width ? w | (((uint64_t)val & ((1ULL << f.width) - 1)) << f.offset) : w;
+}
+
+} // namespace
+
+#endif
@@ -0,0 +1,400 @@
+/* Stand-alone check and micro-benchmark of the table driven EGPRS RLC/MAC
+ * header kernels in RLCMAC_EgprsHdr.hh against the bitfield structs
+ * RLCMAC_EncDec.cc used before.  Not part of any test suite build:
+ *
+ *   g++ -O2 -o RLCMAC_EgprsHdr_bench RLCMAC_EgprsHdr_bench.cc
+ *   ./RLCMAC_EgprsHdr_bench
+ *
+ * Exits non-zero if both implementations disagree on any header.
+ *
+ * Released under the terms of GNU General Public License, Version 2 or
+ * (at your option) any later version.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "RLCMAC_EgprsHdr.hh"
+
+using namespace RLCMAC__Types;
+
+/* reference: the former bitfield layouts, TS 04.60 10.3a.3.x / 10.3a.4.x */
+/* TS 04.60  10.3a.4.1.1 */
+struct gprs_rlc_ul_header_egprs_1 {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+	uint8_t r:1,
+		 si:1,
+		 cv:4,
+		 tfi_hi:2;
+	uint8_t tfi_lo:3,
+		 bsn1_hi:5;
+	uint8_t bsn1_lo:6,
+		 bsn2_hi:2;
+	uint8_t bsn2_lo:8;
+	uint8_t cps:5,
+		 rsb:1,
+		 pi:1,
+		 spare_hi:1;
+	uint8_t spare_lo:6,
+		 dummy:2;
+#else
+/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
+	uint8_t tfi_hi:2, cv:4, si:1, r:1;
+	uint8_t bsn1_hi:5, tfi_lo:3;
+	uint8_t bsn2_hi:2, bsn1_lo:6;
+	uint8_t bsn2_lo:8;
+	uint8_t spare_hi:1, pi:1, rsb:1, cps:5;
+	uint8_t dummy:2, spare_lo:6;
+#endif
+} __attribute__ ((packed));
+
+/* TS 04.60  10.3a.4.2.1 */
+struct gprs_rlc_ul_header_egprs_2 {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+	uint8_t r:1,
+		 si:1,
+		 cv:4,
+		 tfi_hi:2;
+	uint8_t tfi_lo:3,
+		 bsn1_hi:5;
+	uint8_t bsn1_lo:6,
+		 cps_hi:2;
+	uint8_t cps_lo:1,
+		 rsb:1,
+		 pi:1,
+		 spare_hi:5;
+	uint8_t spare_lo:5,
+		 dummy:3;
+#else
+/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
+	uint8_t tfi_hi:2, cv:4, si:1, r:1;
+	uint8_t bsn1_hi:5, tfi_lo:3;
+	uint8_t cps_hi:2, bsn1_lo:6;
+	uint8_t spare_hi:5, pi:1, rsb:1, cps_lo:1;
+	uint8_t dummy:3, spare_lo:5;
+#endif
+} __attribute__ ((packed));
+
+/* TS 04.60  10.3a.4.3.1 */
+struct gprs_rlc_ul_header_egprs_3 {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+	uint8_t r:1,
+		 si:1,
+		 cv:4,
+		 tfi_hi:2;
+	uint8_t tfi_lo:3,
+		 bsn1_hi:5;
+	uint8_t bsn1_lo:6,
+		 cps_hi:2;
+	uint8_t cps_lo:2,
+		 spb:2,
+		 rsb:1,
+		 pi:1,
+		 spare:1,
+		 dummy:1;
+#else
+/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
+	uint8_t tfi_hi:2, cv:4, si:1, r:1;
+	uint8_t bsn1_hi:5, tfi_lo:3;
+	uint8_t cps_hi:2, bsn1_lo:6;
+	uint8_t dummy:1, spare:1, pi:1, rsb:1, spb:2, cps_lo:2;
+#endif
+} __attribute__ ((packed));
+
+struct gprs_rlc_dl_header_egprs_1 {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+	uint8_t usf:3,
+		 es_p:2,
+		 rrbp:2,
+		 tfi_hi:1;
+	uint8_t tfi_lo:4,
+		 pr:2,
+		 bsn1_hi:2;
+	uint8_t bsn1_mid:8;
+	uint8_t bsn1_lo:1,
+		 bsn2_hi:7;
+	uint8_t bsn2_lo:3,
+		 cps:5;
+#else
+/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
+	uint8_t tfi_hi:1, rrbp:2, es_p:2, usf:3;
+	uint8_t bsn1_hi:2, pr:2, tfi_lo:4;
+	uint8_t bsn1_mid:8;
+	uint8_t bsn2_hi:7, bsn1_lo:1;
+	uint8_t cps:5, bsn2_lo:3;
+#endif
+} __attribute__ ((packed));
+
+struct gprs_rlc_dl_header_egprs_2 {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+	uint8_t usf:3,
+		 es_p:2,
+		 rrbp:2,
+		 tfi_hi:1;
+	uint8_t tfi_lo:4,
+		 pr:2,
+		 bsn1_hi:2;
+	uint8_t bsn1_mid:8;
+	uint8_t bsn1_lo:1,
+		 cps:3,
+		 dummy:4;
+#else
+/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
+	uint8_t tfi_hi:1, rrbp:2, es_p:2, usf:3;
+	uint8_t bsn1_hi:2, pr:2, tfi_lo:4;
+	uint8_t bsn1_mid:8;
+	uint8_t dummy:4, cps:3, bsn1_lo:1;
+#endif
+} __attribute__ ((packed));
+
+struct gprs_rlc_dl_header_egprs_3 {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+	uint8_t usf:3,
+		 es_p:2,
+		 rrbp:2,
+		 tfi_hi:1;
+	uint8_t tfi_lo:4,
+		 pr:2,
+		 bsn1_hi:2;
+	uint8_t bsn1_mid:8;
+	uint8_t bsn1_lo:1,
+		 cps:4,
+		 spb:2,
+		 dummy:1;
+#else
+/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
+	uint8_t tfi_hi:1, rrbp:2, es_p:2, usf:3;
+	uint8_t bsn1_hi:2, pr:2, tfi_lo:4;
+	uint8_t bsn1_mid:8;
+	uint8_t dummy:1, spb:2, cps:4, bsn1_lo:1;
+#endif
+} __attribute__ ((packed));
+
+
+static int errors;
+
+#define CHECK(hdr, field, table, bitfield) \
+	do { \
+		if ((unsigned)(table) != (unsigned)(bitfield)) { \
+			if (errors++ < 10) \
+				fprintf(stderr, "%s %s: table %u != bitfield %u\n", \
+					hdr, field, (unsigned)(table), (unsigned)(bitfield)); \
+		} \
+	} while (0)
+
+static void check_dl(const uint8_t *d)
+{
+	const struct gprs_rlc_dl_header_egprs_1 *h1 = (const struct gprs_rlc_dl_header_egprs_1 *)d;
+	const struct gprs_rlc_dl_header_egprs_2 *h2 = (const struct gprs_rlc_dl_header_egprs_2 *)d;
+	const struct gprs_rlc_dl_header_egprs_3 *h3 = (const struct gprs_rlc_dl_header_egprs_3 *)d;
+	uint64_t w;
+
+	w = egprs_hdr_load<egprs_dl_hdr_1.len>(d);
+	CHECK("DL1", "usf", egprs_hdr_get(w, egprs_dl_hdr_1.usf), h1->usf);
+	CHECK("DL1", "es_p", egprs_hdr_get(w, egprs_dl_hdr_1.es_p), h1->es_p);
+	CHECK("DL1", "rrbp", egprs_hdr_get(w, egprs_dl_hdr_1.rrbp), h1->rrbp);
+	CHECK("DL1", "tfi", egprs_hdr_get(w, egprs_dl_hdr_1.tfi), h1->tfi_lo << 1 | h1->tfi_hi);
+	CHECK("DL1", "pr", egprs_hdr_get(w, egprs_dl_hdr_1.pr), h1->pr);
+	CHECK("DL1", "bsn1", egprs_hdr_get(w, egprs_dl_hdr_1.bsn1),
+	      h1->bsn1_lo << 10 | h1->bsn1_mid << 2 | h1->bsn1_hi);
+	CHECK("DL1", "bsn2", egprs_hdr_get(w, egprs_dl_hdr_1.bsn2), h1->bsn2_lo << 7 | h1->bsn2_hi);
+	CHECK("DL1", "cps", egprs_hdr_get(w, egprs_dl_hdr_1.cps), h1->cps);
+
+	w = egprs_hdr_load<egprs_dl_hdr_2.len>(d);
+	CHECK("DL2", "usf", egprs_hdr_get(w, egprs_dl_hdr_2.usf), h2->usf);
+	CHECK("DL2", "es_p", egprs_hdr_get(w, egprs_dl_hdr_2.es_p), h2->es_p);
+	CHECK("DL2", "rrbp", egprs_hdr_get(w, egprs_dl_hdr_2.rrbp), h2->rrbp);
+	CHECK("DL2", "tfi", egprs_hdr_get(w, egprs_dl_hdr_2.tfi), h2->tfi_lo << 1 | h2->tfi_hi);
+	CHECK("DL2", "pr", egprs_hdr_get(w, egprs_dl_hdr_2.pr), h2->pr);
+	CHECK("DL2", "bsn1", egprs_hdr_get(w, egprs_dl_hdr_2.bsn1),
+	      h2->bsn1_lo << 10 | h2->bsn1_mid << 2 | h2->bsn1_hi);
+	CHECK("DL2", "cps", egprs_hdr_get(w, egprs_dl_hdr_2.cps), h2->cps);
+
+	w = egprs_hdr_load<egprs_dl_hdr_3.len>(d);
+	CHECK("DL3", "usf", egprs_hdr_get(w, egprs_dl_hdr_3.usf), h3->usf);
+	CHECK("DL3", "es_p", egprs_hdr_get(w, egprs_dl_hdr_3.es_p), h3->es_p);
+	CHECK("DL3", "rrbp", egprs_hdr_get(w, egprs_dl_hdr_3.rrbp), h3->rrbp);
+	CHECK("DL3", "tfi", egprs_hdr_get(w, egprs_dl_hdr_3.tfi), h3->tfi_lo << 1 | h3->tfi_hi);
+	CHECK("DL3", "pr", egprs_hdr_get(w, egprs_dl_hdr_3.pr), h3->pr);
+	CHECK("DL3", "bsn1", egprs_hdr_get(w, egprs_dl_hdr_3.bsn1),
+	      h3->bsn1_lo << 10 | h3->bsn1_mid << 2 | h3->bsn1_hi);
+	CHECK("DL3", "cps", egprs_hdr_get(w, egprs_dl_hdr_3.cps), h3->cps);
+	CHECK("DL3", "spb", egprs_hdr_get(w, egprs_dl_hdr_3.spb), h3->spb);
+}
+
+struct ul_fields {
+	unsigned r, si, cv, tfi, bsn1, bsn2, cps, spb, rsb, pi;
+};
+
+template <const struct egprs_ul_hdr_desc &D>
+static void table_put_ul(uint8_t *out, const struct ul_fields &f)
+{
+	uint64_t w = 0;
+	w = egprs_hdr_put(w, D.r, f.r);
+	w = egprs_hdr_put(w, D.si, f.si);
+	w = egprs_hdr_put(w, D.cv, f.cv);
+	w = egprs_hdr_put(w, D.tfi, f.tfi);
+	w = egprs_hdr_put(w, D.bsn1, f.bsn1);
+	w = egprs_hdr_put(w, D.bsn2, f.bsn2);
+	w = egprs_hdr_put(w, D.cps, f.cps);
+	w = egprs_hdr_put(w, D.spb, f.spb);
+	w = egprs_hdr_put(w, D.rsb, f.rsb);
+	w = egprs_hdr_put(w, D.pi, f.pi);
+	egprs_hdr_store<D.len>(out, w);
+}
+
+static void bitfield_put_ul1(uint8_t *out, const struct ul_fields &f)
+{
+	struct gprs_rlc_ul_header_egprs_1 *e = (struct gprs_rlc_ul_header_egprs_1 *)out;
+	memset(e, 0, sizeof(*e));
+	e->r = f.r; e->si = f.si; e->cv = f.cv;
+	e->tfi_hi = f.tfi; e->tfi_lo = f.tfi >> 2;
+	e->bsn1_hi = f.bsn1; e->bsn1_lo = f.bsn1 >> 5;
+	e->bsn2_hi = f.bsn2; e->bsn2_lo = f.bsn2 >> 2;
+	e->cps = f.cps; e->rsb = f.rsb; e->pi = f.pi;
+}
+
+static void bitfield_put_ul2(uint8_t *out, const struct ul_fields &f)
+{
+	struct gprs_rlc_ul_header_egprs_2 *e = (struct gprs_rlc_ul_header_egprs_2 *)out;
+	memset(e, 0, sizeof(*e));
+	e->r = f.r; e->si = f.si; e->cv = f.cv;
+	e->tfi_hi = f.tfi; e->tfi_lo = f.tfi >> 2;
+	e->bsn1_hi = f.bsn1; e->bsn1_lo = f.bsn1 >> 5;
+	e->cps_hi = f.cps; e->cps_lo = f.cps >> 2;
+	e->rsb = f.rsb; e->pi = f.pi;
+}
+
+static void bitfield_put_ul3(uint8_t *out, const struct ul_fields &f)
+{
+	struct gprs_rlc_ul_header_egprs_3 *e = (struct gprs_rlc_ul_header_egprs_3 *)out;
+	memset(e, 0, sizeof(*e));
+	e->r = f.r; e->si = f.si; e->cv = f.cv;
+	e->tfi_hi = f.tfi; e->tfi_lo = f.tfi >> 2;
+	e->bsn1_hi = f.bsn1; e->bsn1_lo = f.bsn1 >> 5;
+	e->cps_hi = f.cps; e->cps_lo = f.cps >> 2;
+	e->spb = f.spb; e->rsb = f.rsb; e->pi = f.pi;
+}
+
+static void check_ul(const struct ul_fields &f)
+{
+	uint8_t t[8], b[8];
+
+	table_put_ul<egprs_ul_hdr_1>(t, f);
+	bitfield_put_ul1(b, f);
+	CHECK("UL1", "encoding", memcmp(t, b, egprs_ul_hdr_1.len), 0);
+
+	table_put_ul<egprs_ul_hdr_2>(t, f);
+	bitfield_put_ul2(b, f);
+	CHECK("UL2", "encoding", memcmp(t, b, egprs_ul_hdr_2.len), 0);
+
+	table_put_ul<egprs_ul_hdr_3>(t, f);
+	bitfield_put_ul3(b, f);
+	CHECK("UL3", "encoding", memcmp(t, b, egprs_ul_hdr_3.len), 0);
+}
+
+static struct ul_fields random_ul_fields(void)
+{
+	struct ul_fields f;
+	f.r = rand() & 1; f.si = rand() & 1; f.cv = rand() & 15; f.tfi = rand() & 31;
+	f.bsn1 = rand() & 2047; f.bsn2 = rand() & 1023; f.cps = rand() & 31;
+	f.spb = rand() & 3; f.rsb = rand() & 1; f.pi = rand() & 1;
+	return f;
+}
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double ns_per(bench_clock::time_point t0, bench_clock::time_point t1, unsigned n)
+{
+	return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+#define NUM_HDRS	(1 << 16)
+#define ROUNDS		200
+
+static void bench_dl1_unpack(const uint8_t *buf)
+{
+	const struct egprs_dl_hdr_desc &D = egprs_dl_hdr_1;
+	unsigned acc_b = 0, acc_t = 0;
+
+	bench_clock::time_point t0 = bench_clock::now();
+	for (unsigned k = 0; k < ROUNDS; k++) {
+		for (unsigned i = 0; i < NUM_HDRS; i++) {
+			const struct gprs_rlc_dl_header_egprs_1 *h =
+				(const struct gprs_rlc_dl_header_egprs_1 *)(buf + 8 * i);
+			acc_b += h->usf + h->es_p + h->rrbp + (h->tfi_lo << 1 | h->tfi_hi) + h->pr +
+				 (h->bsn1_lo << 10 | h->bsn1_mid << 2 | h->bsn1_hi) +
+				 (h->bsn2_lo << 7 | h->bsn2_hi) + h->cps;
+		}
+	}
+	bench_clock::time_point t1 = bench_clock::now();
+	for (unsigned k = 0; k < ROUNDS; k++) {
+		for (unsigned i = 0; i < NUM_HDRS; i++) {
+			uint64_t w = egprs_hdr_load<D.len>(buf + 8 * i);
+			acc_t += egprs_hdr_get(w, D.usf) + egprs_hdr_get(w, D.es_p) +
+				 egprs_hdr_get(w, D.rrbp) + egprs_hdr_get(w, D.tfi) +
+				 egprs_hdr_get(w, D.pr) + egprs_hdr_get(w, D.bsn1) +
+				 egprs_hdr_get(w, D.bsn2) + egprs_hdr_get(w, D.cps);
+		}
+	}
+	bench_clock::time_point t2 = bench_clock::now();
+
+	CHECK("DL1", "checksum", acc_t, acc_b);
+	printf("DL type 1 unpack: bitfield %6.2f ns/hdr, table %6.2f ns/hdr\n",
+	       ns_per(t0, t1, ROUNDS * NUM_HDRS), ns_per(t1, t2, ROUNDS * NUM_HDRS));
+}
+
+static void bench_ul1_pack(const struct ul_fields *fields, uint8_t *buf)
+{
+	unsigned acc_b = 0, acc_t = 0;
+
+	bench_clock::time_point t0 = bench_clock::now();
+	for (unsigned k = 0; k < ROUNDS; k++) {
+		for (unsigned i = 0; i < NUM_HDRS; i++)
+			bitfield_put_ul1(buf + 8 * i, fields[i]);
+		acc_b += buf[8 * (k % NUM_HDRS) + 3];
+	}
+	bench_clock::time_point t1 = bench_clock::now();
+	for (unsigned k = 0; k < ROUNDS; k++) {
+		for (unsigned i = 0; i < NUM_HDRS; i++)
+			table_put_ul<egprs_ul_hdr_1>(buf + 8 * i, fields[i]);
+		acc_t += buf[8 * (k % NUM_HDRS) + 3];
+	}
+	bench_clock::time_point t2 = bench_clock::now();
+
+	CHECK("UL1", "checksum", acc_t, acc_b);
+	printf("UL type 1 pack:   bitfield %6.2f ns/hdr, table %6.2f ns/hdr\n",
+	       ns_per(t0, t1, ROUNDS * NUM_HDRS), ns_per(t1, t2, ROUNDS * NUM_HDRS));
+}
+
+int main(void)
+{
+	static uint8_t buf[NUM_HDRS * 8];
+	static struct ul_fields fields[NUM_HDRS];
+	uint8_t d[8];
+
+	srand(1);
+	for (unsigned i = 0; i < 100000; i++) {
+		for (unsigned j = 0; j < sizeof(d); j++)
+			d[j] = rand();
+		check_dl(d);
+		check_ul(random_ul_fields());
+	}
+
+	for (unsigned i = 0; i < sizeof(buf); i++)
+		buf[i] = rand();
+	for (unsigned i = 0; i < NUM_HDRS; i++)
+		fields[i] = random_ul_fields();
+
+	bench_dl1_unpack(buf);
+	bench_ul1_pack(fields, buf);
+
+	if (errors) {
+		fprintf(stderr, "%d mismatches between table and bitfield kernels\n", errors);
+		return 1;
+	}
+	return 0;
+}
@@ -1,9 +1,11 @@
 #include <stdint.h>
+#include <string.h>
 #include <endian.h>
 
 #include "RLCMAC_Types.hh"
 #include "RLCMAC_Templates.hh"
 #include "GSM_Types.hh"
+#include "RLCMAC_EgprsHdr.hh"
 /* Decoding of TS 44.060 GPRS RLC/MAC blocks, portions requiring manual functions
  * beyond what TITAN RAW coder can handle internally.
  *
@@ -22,156 +24,13 @@ namespace RLCMAC__Types {
 // INTENRAL HELPERS
 /////////////////////
 
-/* TS 04.60  10.3a.4.1.1 */
-struct gprs_rlc_ul_header_egprs_1 {
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-	uint8_t r:1,
-		 si:1,
-		 cv:4,
-		 tfi_hi:2;
-	uint8_t tfi_lo:3,
-		 bsn1_hi:5;
-	uint8_t bsn1_lo:6,
-		 bsn2_hi:2;
-	uint8_t bsn2_lo:8;
-	uint8_t cps:5,
-		 rsb:1,
-		 pi:1,
-		 spare_hi:1;
-	uint8_t spare_lo:6,
-		 dummy:2;
-#else
-/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
-	uint8_t tfi_hi:2, cv:4, si:1, r:1;
-	uint8_t bsn1_hi:5, tfi_lo:3;
-	uint8_t bsn2_hi:2, bsn1_lo:6;
-	uint8_t bsn2_lo:8;
-	uint8_t spare_hi:1, pi:1, rsb:1, cps:5;
-	uint8_t dummy:2, spare_lo:6;
-#endif
-} __attribute__ ((packed));
-
-/* TS 04.60  10.3a.4.2.1 */
-struct gprs_rlc_ul_header_egprs_2 {
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-	uint8_t r:1,
-		 si:1,
-		 cv:4,
-		 tfi_hi:2;
-	uint8_t tfi_lo:3,
-		 bsn1_hi:5;
-	uint8_t bsn1_lo:6,
-		 cps_hi:2;
-	uint8_t cps_lo:1,
-		 rsb:1,
-		 pi:1,
-		 spare_hi:5;
-	uint8_t spare_lo:5,
-		 dummy:3;
-#else
-/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
-	uint8_t tfi_hi:2, cv:4, si:1, r:1;
-	uint8_t bsn1_hi:5, tfi_lo:3;
-	uint8_t cps_hi:2, bsn1_lo:6;
-	uint8_t spare_hi:5, pi:1, rsb:1, cps_lo:1;
-	uint8_t dummy:3, spare_lo:5;
-#endif
-} __attribute__ ((packed));
-
-/* TS 04.60  10.3a.4.3.1 */
-struct gprs_rlc_ul_header_egprs_3 {
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-	uint8_t r:1,
-		 si:1,
-		 cv:4,
-		 tfi_hi:2;
-	uint8_t tfi_lo:3,
-		 bsn1_hi:5;
-	uint8_t bsn1_lo:6,
-		 cps_hi:2;
-	uint8_t cps_lo:2,
-		 spb:2,
-		 rsb:1,
-		 pi:1,
-		 spare:1,
-		 dummy:1;
-#else
-/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
-	uint8_t tfi_hi:2, cv:4, si:1, r:1;
-	uint8_t bsn1_hi:5, tfi_lo:3;
-	uint8_t cps_hi:2, bsn1_lo:6;
-	uint8_t dummy:1, spare:1, pi:1, rsb:1, spb:2, cps_lo:2;
-#endif
-} __attribute__ ((packed));
-
-struct gprs_rlc_dl_header_egprs_1 {
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-	uint8_t usf:3,
-		 es_p:2,
-		 rrbp:2,
-		 tfi_hi:1;
-	uint8_t tfi_lo:4,
-		 pr:2,
-		 bsn1_hi:2;
-	uint8_t bsn1_mid:8;
-	uint8_t bsn1_lo:1,
-		 bsn2_hi:7;
-	uint8_t bsn2_lo:3,
-		 cps:5;
-#else
-/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
-	uint8_t tfi_hi:1, rrbp:2, es_p:2, usf:3;
-	uint8_t bsn1_hi:2, pr:2, tfi_lo:4;
-	uint8_t bsn1_mid:8;
-	uint8_t bsn2_hi:7, bsn1_lo:1;
-	uint8_t cps:5, bsn2_lo:3;
-#endif
-} __attribute__ ((packed));
-
-struct gprs_rlc_dl_header_egprs_2 {
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-	uint8_t usf:3,
-		 es_p:2,
-		 rrbp:2,
-		 tfi_hi:1;
-	uint8_t tfi_lo:4,
-		 pr:2,
-		 bsn1_hi:2;
-	uint8_t bsn1_mid:8;
-	uint8_t bsn1_lo:1,
-		 cps:3,
-		 dummy:4;
-#else
-/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
-	uint8_t tfi_hi:1, rrbp:2, es_p:2, usf:3;
-	uint8_t bsn1_hi:2, pr:2, tfi_lo:4;
-	uint8_t bsn1_mid:8;
-	uint8_t dummy:4, cps:3, bsn1_lo:1;
-#endif
-} __attribute__ ((packed));
-
-struct gprs_rlc_dl_header_egprs_3 {
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-	uint8_t usf:3,
-		 es_p:2,
-		 rrbp:2,
-		 tfi_hi:1;
-	uint8_t tfi_lo:4,
-		 pr:2,
-		 bsn1_hi:2;
-	uint8_t bsn1_mid:8;
-	uint8_t bsn1_lo:1,
-		 cps:4,
-		 spb:2,
-		 dummy:1;
-#else
-/* auto-generated from the little endian part above (libosmocore/contrib/struct_endianess.py) */
-	uint8_t tfi_hi:1, rrbp:2, es_p:2, usf:3;
-	uint8_t bsn1_hi:2, pr:2, tfi_lo:4;
-	uint8_t bsn1_mid:8;
-	uint8_t dummy:1, spb:2, cps:4, bsn1_lo:1;
-#endif
-} __attribute__ ((packed));
+/* EgprsHeaderType of a header descriptor from RLCMAC_EgprsHdr.hh */
+static constexpr EgprsHeaderType::enum_type egprs_hdr_type(uint8_t type)
+{
+	return type == 1 ? EgprsHeaderType::RLCMAC__HDR__TYPE__1 :
+	       type == 2 ? EgprsHeaderType::RLCMAC__HDR__TYPE__2 :
+			   EgprsHeaderType::RLCMAC__HDR__TYPE__3;
+}
 
 /*
 static const char hex_chars[] = "0123456789abcdef";
@@ -301,147 +160,161 @@ setup_rlc_mac_priv(CodingScheme::enum_type mcs, EgprsHeaderType::enum_type hdrty
 	data_block_offsets[1] = dbo[1];
 }
 
-/* bit-shift the entire 'src' of length 'length_bytes' by 'offset_bits'
- * and store the result to caller-allocated 'buffer'.  The shifting is
- * done lsb-first. */
-static void clone_aligned_buffer_lsbf(unsigned int offset_bits, unsigned int length_bytes,
-	const uint8_t *src, uint8_t *buffer)
+static inline uint64_t load_le64(const uint8_t *p)
 {
-	unsigned int hdr_bytes;
-	unsigned int extra_bits;
-	unsigned int i;
-
-	uint8_t c, last_c;
-	uint8_t *dst;
+	uint64_t w;
+	memcpy(&w, p, sizeof(w));
+	return le64toh(w);
+}
 
-	hdr_bytes = offset_bits / 8;
-	extra_bits = offset_bits % 8;
+static inline void store_le64(uint8_t *p, uint64_t w)
+{
+	w = htole64(w);
+	memcpy(p, &w, sizeof(w));
+}
 
-	//fprintf(stderr, "RLMAC: clone: hdr_bytes=%u extra_bits=%u (length_bytes=%u)\n", hdr_bytes, extra_bits, length_bytes);
+/* shift the bit-stream in 'src' by 'shift' (0..7) bits towards the LSB and
+ * store 'len' octets of the result to caller-allocated 'dst', lsb-first:
+ * dst[i] = src[i] >> shift | src[i+1] << (8 - shift).  Octets beyond
+ * 'src_len' are read as zero. */
+static void shr_bits_lsbf(uint8_t *dst, const uint8_t *src, size_t len, size_t src_len,
+	unsigned int shift)
+{
+	size_t i = 0;
 
-	if (extra_bits == 0) {
+	if (shift == 0) {
 		/* It is aligned already */
-		memcpy(buffer, src + hdr_bytes, length_bytes);
+		size_t n = len < src_len ? len : src_len;
+		memcpy(dst, src, n);
+		memset(dst + n, 0, len - n);
 		return;
 	}
 
-	dst = buffer;
-	src = src + hdr_bytes;
-	last_c = *(src++);
+	/* eight output octets at a time, each requiring nine input octets */
+	for (; i + 8 <= len && i + 9 <= src_len; i += 8)
+		store_le64(dst + i, load_le64(src + i) >> shift | (uint64_t)src[i + 8] << (64 - shift));
 
-	for (i = 0; i < length_bytes; i++) {
-		c = src[i];
-		*(dst++) = (last_c >> extra_bits) | (c << (8 - extra_bits));
-		last_c = c;
+	for (; i < len; i++) {
+		uint8_t lo = i < src_len ? src[i] : 0;
+		uint8_t hi = i + 1 < src_len ? src[i + 1] : 0;
+		dst[i] = (lo >> shift) | (hi << (8 - shift));
 	}
 }
 
-/* obtain an (aligned) EGPRS data block with given bit-offset and
- * bit-length from the parent buffer */
-static void get_egprs_data_block(const TTCN_Buffer& orig_ttcn_buffer, unsigned int offset_bits,
-	unsigned int length_bits, TTCN_Buffer& dst_ttcn_buffer)
+/* shift 'len' octets of the bit-stream in 'src' by 'shift' (0..7) bits
+ * towards the MSB and store the result to caller-allocated 'dst', lsb-first:
+ * dst[i] = src[i] << shift | src[i-1] >> (8 - shift), with src[-1] = 'prev'.
+ * Returns the bits shifted out of the last octet. */
+static uint8_t shl_bits_lsbf(uint8_t *dst, const uint8_t *src, size_t len, unsigned int shift,
+	uint8_t prev)
 {
-	const unsigned int initial_spare_bits = 6;
-	unsigned char *aligned_buf = NULL;
-	size_t min_src_length_bytes = (offset_bits + length_bits + 7) / 8;
-	size_t length_bytes = (initial_spare_bits + length_bits + 7) / 8;
-	size_t accepted_len = length_bytes;
+	size_t i = 0;
 
-	//fprintf(stderr, "RLMAC: trying to allocate %u bytes (orig is %zu bytes long with read pos %zu)\n", length_bytes, orig_ttcn_buffer.get_len(), orig_ttcn_buffer.get_pos());
-	dst_ttcn_buffer.get_end(aligned_buf, accepted_len);
-	if (accepted_len < length_bytes) {
-		fprintf(stderr, "RLMAC: ERROR! asked for %zu bytes but got %zu\n", length_bytes, accepted_len);
+	if (shift == 0) {
+		memcpy(dst, src, len);
+		return 0;
 	}
 
-	/* Copy the data out of the tvb to an aligned buffer */
-	clone_aligned_buffer_lsbf(
-		offset_bits - initial_spare_bits, length_bytes,
-		orig_ttcn_buffer.get_data(),
-		aligned_buf);
+	for (; i + 8 <= len; i += 8) {
+		store_le64(dst + i, load_le64(src + i) << shift | (uint64_t)(prev >> (8 - shift)));
+		prev = src[i + 7];
+	}
 
-	/* clear spare bits and move block header bits to the right */
-	aligned_buf[0] = aligned_buf[0] >> initial_spare_bits;
+	for (; i < len; i++) {
+		dst[i] = (src[i] << shift) | (prev >> (8 - shift));
+		prev = src[i];
+	}
 
-	dst_ttcn_buffer.increase_length(length_bytes);
+	return prev >> (8 - shift);
 }
 
-/* bit-shift the entire 'src' of length 'length_bytes'
- * and store the result to caller-allocated 'buffer'  by 'offset_bits'.  The shifting is
- * done lsb-first. */
-static void clone_unaligned_buffer_lsbf(unsigned int offset_bits, unsigned int length_bytes,
-	const uint8_t *src, uint8_t *buffer)
+/* make sure 'buf' has room for 'total_len' octets and return a writable
+ * pointer to the start of its data.  .get_end() is the only API providing
+ * writable memory (and it un-shares the memory if needed), so derive the
+ * start from the end pointer. */
+static uint8_t *ttcn_buffer_get_writable(TTCN_Buffer& buf, size_t total_len)
 {
-	unsigned int hdr_bytes;
-	unsigned int extra_bits;
-	unsigned int i;
+	size_t cur_len = buf.get_len();
+	size_t end_len = total_len > cur_len ? total_len - cur_len : 0;
+	size_t accepted_len = end_len;
+	unsigned char *end_ptr = NULL;
 
-	uint8_t c, last_hdr_c, last_c;
-	uint8_t *dst;
+	buf.get_end(end_ptr, accepted_len);
+	if (accepted_len < end_len)
+		TTCN_error("RLCMAC: asked for %zu bytes but got %zu", end_len, accepted_len);
 
-	hdr_bytes = offset_bits / 8;
-	extra_bits = offset_bits % 8;
+	return end_ptr - cur_len;
+}
 
-	//fprintf(stderr, "RLMAC: clone: hdr_bytes=%u extra_bits=%u (length_bytes=%u)\n", hdr_bytes, extra_bits, length_bytes);
+/* obtain an (aligned) EGPRS data block with given bit-offset and
+ * bit-length from the parent block of 'src_len' octets at 'src' */
+static void get_egprs_data_block(const uint8_t *src, size_t src_len, unsigned int offset_bits,
+	unsigned int length_bits, TTCN_Buffer& dst_ttcn_buffer)
+{
+	const unsigned int initial_spare_bits = 6;
+	unsigned int hdr_bytes = (offset_bits - initial_spare_bits) / 8;
+	unsigned int extra_bits = (offset_bits - initial_spare_bits) % 8;
+	size_t length_bytes = (initial_spare_bits + length_bits + 7) / 8;
+	size_t dst_len = dst_ttcn_buffer.get_len();
+	uint8_t *aligned_buf;
 
-	if (extra_bits == 0) {
-		/* It is aligned already */
-		memcpy(buffer, src + hdr_bytes, length_bytes);
-		return;
-	}
+	aligned_buf = ttcn_buffer_get_writable(dst_ttcn_buffer, dst_len + length_bytes) + dst_len;
 
-	/* Copy first header+data byte, it's not handled correctly by loop */
-	dst = buffer + hdr_bytes;
-	last_hdr_c = *dst;
-	last_c = *dst << (8 - extra_bits);
+	/* Copy the data out of the tvb to an aligned buffer */
+	if (hdr_bytes < src_len)
+		shr_bits_lsbf(aligned_buf, src + hdr_bytes, length_bytes,
+			      src_len - hdr_bytes, extra_bits);
+	else
+		memset(aligned_buf, 0, length_bytes);
 
-	for (i = 0; i < length_bytes; i++) {
-		c = src[i];
-		*(dst++) = (last_c >> (8 - extra_bits)) | (c << extra_bits);
-		last_c = c;
-	}
-	/* overwrite the lower extra_bits */
-	*dst = (*dst & (0xff << extra_bits)) | (last_c >> (8 - extra_bits));
+	/* clear spare bits and move block header bits to the right */
+	aligned_buf[0] = aligned_buf[0] >> initial_spare_bits;
 
-	/* Copy back first header+data byte */
-	dst = buffer + hdr_bytes;
-	*(dst++) = last_hdr_c | (src[0] << (8 - extra_bits));
-	*dst |= (src[0] >> (extra_bits)) & (0xff >> (8 - extra_bits));
+	dst_ttcn_buffer.increase_length(length_bytes);
 }
 
 /* put an (aligned) EGPRS data block with given bit-offset and
- * bit-length into parent buffer */
+ * bit-length into parent buffer, right behind the header already
+ * contained in it */
 static void put_egprs_data_block(const TTCN_Buffer& aligned_data_block_buffer, unsigned int offset_bits,
 	unsigned int length_bits, TTCN_Buffer& dst_ttcn_buffer)
 {
 	const unsigned int initial_spare_bits = 6;
-	unsigned char *unaligned_buf = NULL;
-	char tmpbuf[120];
-	int tmplen = dst_ttcn_buffer.get_len();
-	//size_t max_length_bytes = (initial_spare_bits + length_bits + 7) / 8;
-	size_t length_bytes = tmplen + aligned_data_block_buffer.get_len();
-	size_t accepted_len = length_bytes;
-
-	//fprintf(stderr, "RLMAC: trying to allocate %u bytes\n", length_bytes);
-
-	/* API .get_end() is the only one I could find to access writeable
-	   memory in the buffer. It points to the end. Hence, we first copy
-	   (readonly) data to tmpbuf and later clear() so that .get_end()
-	   provides us with a pointer to the start of the buffer. */
-	memcpy(tmpbuf, dst_ttcn_buffer.get_data(), tmplen);
-	dst_ttcn_buffer.clear();
-	dst_ttcn_buffer.get_end(unaligned_buf, accepted_len);
-	if (accepted_len < tmplen) {
-		fprintf(stderr, "RLMAC: ERROR! asked for %zu bytes but got %zu\n", length_bytes, accepted_len);
-	}
-	memcpy(unaligned_buf, tmpbuf, tmplen);
+	const uint8_t *src = aligned_data_block_buffer.get_data();
+	size_t src_len = aligned_data_block_buffer.get_len();
+	unsigned int hdr_bytes = (offset_bits - initial_spare_bits) / 8;
+	unsigned int extra_bits = (offset_bits - initial_spare_bits) % 8;
+	size_t hdr_len = dst_ttcn_buffer.get_len();
+	size_t data_end, total_len, i;
+	uint8_t hdr_tail[8], first, carry;
+	uint8_t *buf;
+
+	if (src_len == 0)
+		return;
 
-	/* Copy the data out of the tvb to an aligned buffer */
-	clone_unaligned_buffer_lsbf(
-		offset_bits - initial_spare_bits, length_bytes,
-		aligned_data_block_buffer.get_data(),
-		unaligned_buf);
+	/* The first octet of the aligned block only carries the two bits
+	 * following the header, the remaining octets are shifted by
+	 * 'extra_bits' into the octets behind 'hdr_bytes' */
+	data_end = hdr_bytes + src_len + (extra_bits ? 1 : 0);
+	total_len = data_end > hdr_len ? data_end : hdr_len;
+	if (hdr_len < hdr_bytes + 1 || hdr_len - hdr_bytes - 1 > sizeof(hdr_tail))
+		TTCN_error("RLCMAC: header length %zu doesn't match data offset %u", hdr_len, offset_bits);
 
-	dst_ttcn_buffer.increase_length(length_bytes);
+	buf = ttcn_buffer_get_writable(dst_ttcn_buffer, total_len);
+
+	/* header octets overlapping with the data part (spare bits zero) */
+	memcpy(hdr_tail, buf + hdr_bytes + 1, hdr_len - hdr_bytes - 1);
+
+	first = src[0] << initial_spare_bits;
+	buf[hdr_bytes] |= first << extra_bits;
+	carry = shl_bits_lsbf(buf + hdr_bytes + 1, src + 1, src_len - 1, extra_bits, first);
+	if (extra_bits)
+		buf[hdr_bytes + src_len] = carry;
+
+	for (i = 0; i < hdr_len - hdr_bytes - 1; i++)
+		buf[hdr_bytes + 1 + i] |= hdr_tail[i];
+
+	dst_ttcn_buffer.increase_length(total_len - hdr_len);
 }
 
 /* Append padding bytes and spare bits at the end of ttcn_buffer, based on requested CS */
@@ -473,13 +346,13 @@ static void encode_trailing_padding_spb(TTCN_Buffer& ttcn_buffer, CodingScheme c
 
 /* DECODE DOWNLINK */
 
-RlcmacDlDataBlock dec__RlcmacDlDataBlock(const OCTETSTRING& stream)
+static void dec_RlcmacDlDataBlock(const OCTETSTRING& stream, CodingScheme::enum_type cs_mcs,
+	RlcmacDlDataBlock& ret_val)
 {
-	RlcmacDlDataBlock ret_val;
 	TTCN_Buffer ttcn_buffer(stream);
 	int num_llc_blocks = 0;
 
-	ret_val.cs() = payload_len_2_coding_scheme(stream.lengthof());
+	ret_val.cs() = cs_mcs;
 
 	/* use automatic/generated decoder for header */
 	ret_val.mac__hdr().decode(DlMacDataHeader_descr_, ttcn_buffer, TTCN_EncDec::CT_RAW);
@@ -530,124 +403,60 @@ RlcmacDlDataBlock dec__RlcmacDlDataBlock(const OCTETSTRING& stream)
 			}
 		}
 	}
-
-	return ret_val;
 }
 
-static
-EgprsDlMacDataHeader dec__EgprsDlMacDataHeader_type1(const OCTETSTRING& stream)
+RlcmacDlDataBlock dec__RlcmacDlDataBlock(const OCTETSTRING& stream)
 {
-	TTCN_Buffer ttcn_buffer(stream);
-	EgprsDlMacDataHeader ret_val;
-	const struct gprs_rlc_dl_header_egprs_1 *egprs1;
-	uint8_t tmp;
+	RlcmacDlDataBlock ret_val;
 
-	egprs1 = static_cast<const struct gprs_rlc_dl_header_egprs_1 *>
-		((const void *)ttcn_buffer.get_data());
+	dec_RlcmacDlDataBlock(stream, payload_len_2_coding_scheme(stream.lengthof()), ret_val);
 
-	ret_val.header__type() = EgprsHeaderType::RLCMAC__HDR__TYPE__1;
-	ret_val.tfi() = egprs1->tfi_lo << 1 | egprs1->tfi_hi << 0;
-	ret_val.rrbp() = egprs1->rrbp;
-	tmp = egprs1->es_p;
-	ret_val.esp() = BITSTRING(2, &tmp);
-	ret_val.usf() = egprs1->usf;
-	ret_val.bsn1() = egprs1->bsn1_lo << 10 | egprs1->bsn1_mid << 2 | egprs1->bsn1_hi;
-	ret_val.bsn2__offset() = egprs1->bsn2_lo << 7 | egprs1->bsn2_hi;
-	ret_val.pr() = egprs1->pr;
-	ret_val.cps() = egprs1->cps;
-	ret_val.spb() = OMIT_VALUE;
-
-	ttcn_buffer.increase_pos(sizeof(*egprs1));
 	return ret_val;
 }
 
-static
-EgprsDlMacDataHeader dec__EgprsDlMacDataHeader_type2(const OCTETSTRING& stream)
+template <const struct egprs_dl_hdr_desc &D>
+static EgprsDlMacDataHeader dec_EgprsDlMacDataHeader(const uint8_t *data)
 {
-	TTCN_Buffer ttcn_buffer(stream);
 	EgprsDlMacDataHeader ret_val;
-	const struct gprs_rlc_dl_header_egprs_2 *egprs2;
+	const uint64_t w = egprs_hdr_load<D.len>(data);
 	uint8_t tmp;
 
-	egprs2 = static_cast<const struct gprs_rlc_dl_header_egprs_2 *>
-		((const void *)ttcn_buffer.get_data());
-
-	ret_val.header__type() = EgprsHeaderType::RLCMAC__HDR__TYPE__2;
-	ret_val.tfi() = egprs2->tfi_lo << 1 | egprs2->tfi_hi << 0;
-	ret_val.rrbp() = egprs2->rrbp;
-	tmp = egprs2->es_p;
+	ret_val.header__type() = egprs_hdr_type(D.type);
+	ret_val.tfi() = egprs_hdr_get(w, D.tfi);
+	ret_val.rrbp() = egprs_hdr_get(w, D.rrbp);
+	tmp = egprs_hdr_get(w, D.es_p);
 	ret_val.esp() = BITSTRING(2, &tmp);
-	ret_val.usf() = egprs2->usf;
-	ret_val.bsn1() = egprs2->bsn1_lo << 10 | egprs2->bsn1_mid << 2 | egprs2->bsn1_hi;
-	ret_val.bsn2__offset() = 0; /*TODO: mark optional and not set ? */
-	ret_val.pr() = egprs2->pr;
-	ret_val.cps() = egprs2->cps;
-	ret_val.spb() = OMIT_VALUE;
-
-	ttcn_buffer.increase_pos(sizeof(*egprs2));
-	return ret_val;
-}
-
-static
-EgprsDlMacDataHeader dec__EgprsDlMacDataHeader_type3(const OCTETSTRING& stream)
-{
-	TTCN_Buffer ttcn_buffer(stream);
-	EgprsDlMacDataHeader ret_val;
-	const struct gprs_rlc_dl_header_egprs_3 *egprs3;
-	uint8_t tmp;
-
-	egprs3 = static_cast<const struct gprs_rlc_dl_header_egprs_3 *>
-		((const void *)ttcn_buffer.get_data());
+	ret_val.usf() = egprs_hdr_get(w, D.usf);
+	ret_val.bsn1() = egprs_hdr_get(w, D.bsn1);
+	ret_val.bsn2__offset() = egprs_hdr_get(w, D.bsn2); /*TODO: mark optional and not set ? */
+	ret_val.pr() = egprs_hdr_get(w, D.pr);
+	ret_val.cps() = egprs_hdr_get(w, D.cps);
+	if (D.spb.width)
+		ret_val.spb() = egprs_hdr_get(w, D.spb);
+	else
+		ret_val.spb() = OMIT_VALUE;
 
-	ret_val.header__type() = EgprsHeaderType::RLCMAC__HDR__TYPE__3;
-	ret_val.tfi() = egprs3->tfi_lo << 1 | egprs3->tfi_hi << 0;
-	ret_val.rrbp() = egprs3->rrbp;
-	tmp = egprs3->es_p;
-	ret_val.esp() = BITSTRING(2, &tmp);
-	ret_val.usf() = egprs3->usf;
-	ret_val.bsn1() = egprs3->bsn1_lo << 10 | egprs3->bsn1_mid << 2 | egprs3->bsn1_hi;
-	ret_val.bsn2__offset() = 0; /*TODO: mark optional and not set ? */
-	ret_val.pr() = egprs3->pr;
-	ret_val.spb() = egprs3->spb;
-	ret_val.cps() = egprs3->cps;
-
-	ttcn_buffer.increase_pos(sizeof(*egprs3));
 	return ret_val;
 }
 
-static
-RlcmacDlEgprsDataBlock dec__RlcmacDlEgprsDataBlock(const OCTETSTRING& stream)
+/* decode the EGPRS DL data block of 'len' octets at 'data', using header type D */
+template <const struct egprs_dl_hdr_desc &D>
+static void dec_RlcmacDlEgprsDataBlock(const uint8_t *data, size_t len, CodingScheme::enum_type cs_mcs,
+	RlcmacDlEgprsDataBlock& ret_val)
 {
-	RlcmacDlEgprsDataBlock ret_val;
-	TTCN_Buffer ttcn_buffer(stream);
 	TTCN_Buffer aligned_buffer;
 	int num_llc_blocks = 0;
 	unsigned int data_block_bits, data_block_offsets[2];
 	unsigned int num_calls;
 	const uint8_t *ti_e;
 
-	ret_val.mcs() = payload_len_2_coding_scheme(stream.lengthof());
-	switch (ret_val.mcs()) {
-	case CodingScheme::MCS__0:
-	case CodingScheme::MCS__1:
-	case CodingScheme::MCS__2:
-	case CodingScheme::MCS__3:
-	case CodingScheme::MCS__4:
-		ret_val.mac__hdr() = dec__EgprsDlMacDataHeader_type3(stream);
-		break;
-	case CodingScheme::MCS__5:
-	case CodingScheme::MCS__6:
-		ret_val.mac__hdr() = dec__EgprsDlMacDataHeader_type2(stream);
-		break;
-	case CodingScheme::MCS__7:
-	case CodingScheme::MCS__8:
-	case CodingScheme::MCS__9:
-		ret_val.mac__hdr() = dec__EgprsDlMacDataHeader_type1(stream);
-		break;
-	}
-	setup_rlc_mac_priv(ret_val.mcs(), ret_val.mac__hdr().header__type(), false,
-			   &num_calls, &data_block_bits, data_block_offsets);
-	get_egprs_data_block(ttcn_buffer, data_block_offsets[0], data_block_bits, aligned_buffer);
+	if (len < D.len)
+		TTCN_error("dec_RlcmacDlEgprsDataBlock(): block too short (%zu bytes)", len);
+
+	ret_val.mcs() = cs_mcs;
+	ret_val.mac__hdr() = dec_EgprsDlMacDataHeader<D>(data);
+	setup_rlc_mac_priv(cs_mcs, egprs_hdr_type(D.type), false, &num_calls, &data_block_bits, data_block_offsets);
+	get_egprs_data_block(data, len, data_block_offsets[0], data_block_bits, aligned_buffer);
 
 	ti_e = aligned_buffer.get_read_data();
 	ret_val.fbi() = *ti_e & 0x02 ? true : false;
@@ -677,7 +486,7 @@ RlcmacDlEgprsDataBlock dec__RlcmacDlEgprsDataBlock(const OCTETSTRING& stream)
 		 * fills the current RLC data block precisely or continues in the following in-sequence RLC
 		 * data block */
 		lb.hdr() = OMIT_VALUE;
-		lb.payload() = OCTETSTRING(length, ttcn_buffer.get_read_data());
+		lb.payload() = OCTETSTRING(length, aligned_buffer.get_read_data());
 		aligned_buffer.increase_pos(length);
 		ret_val.blocks()[0] = lb;
 	} else {
@@ -692,6 +501,40 @@ RlcmacDlEgprsDataBlock dec__RlcmacDlEgprsDataBlock(const OCTETSTRING& stream)
 			}
 		}
 	}
+}
+
+typedef void (*dl_egprs_dec_fn)(const uint8_t *data, size_t len, CodingScheme::enum_type cs_mcs,
+				RlcmacDlEgprsDataBlock& ret_val);
+
+/* select the EGPRS DL data block decoder for the header type used by 'cs_mcs' */
+static dl_egprs_dec_fn dl_egprs_decoder(CodingScheme::enum_type cs_mcs)
+{
+	switch (cs_mcs) {
+	case CodingScheme::MCS__0:
+	case CodingScheme::MCS__1:
+	case CodingScheme::MCS__2:
+	case CodingScheme::MCS__3:
+	case CodingScheme::MCS__4:
+		return dec_RlcmacDlEgprsDataBlock<egprs_dl_hdr_3>;
+	case CodingScheme::MCS__5:
+	case CodingScheme::MCS__6:
+		return dec_RlcmacDlEgprsDataBlock<egprs_dl_hdr_2>;
+	case CodingScheme::MCS__7:
+	case CodingScheme::MCS__8:
+	case CodingScheme::MCS__9:
+		return dec_RlcmacDlEgprsDataBlock<egprs_dl_hdr_1>;
+	default:
+		TTCN_error("%s is not an EGPRS coding scheme", CodingScheme::enum_to_str(cs_mcs));
+	}
+}
+
+static
+RlcmacDlEgprsDataBlock dec__RlcmacDlEgprsDataBlock(const OCTETSTRING& stream)
+{
+	RlcmacDlEgprsDataBlock ret_val;
+	CodingScheme::enum_type cs_mcs = payload_len_2_coding_scheme(stream.lengthof());
+
+	dl_egprs_decoder(cs_mcs)((const uint8_t *)stream, stream.lengthof(), cs_mcs, ret_val);
 
 	return ret_val;
 }
@@ -732,9 +575,9 @@ RlcmacDlBlock dec__RlcmacDlBlock(const OCTETSTRING& stream)
 
 /* DECODE UPLINK */
 
-RlcmacUlDataBlock dec__RlcmacUlDataBlock(const OCTETSTRING& stream)
+static void dec_RlcmacUlDataBlock(const OCTETSTRING& stream, CodingScheme::enum_type cs_mcs,
+	RlcmacUlDataBlock& ret_val)
 {
-	RlcmacUlDataBlock ret_val;
 	TTCN_Buffer ttcn_buffer(stream);
 	int num_llc_blocks = 0;
 
@@ -744,7 +587,7 @@ RlcmacUlDataBlock dec__RlcmacUlDataBlock(const OCTETSTRING& stream)
 	stream.log();
 	TTCN_Logger::end_event();
 
-	ret_val.cs() = payload_len_2_coding_scheme(stream.lengthof());
+	ret_val.cs() = cs_mcs;
 
 	/* use automatic/generated decoder for header */
 	ret_val.mac__hdr().decode(UlMacDataHeader_descr_, ttcn_buffer, TTCN_EncDec::CT_RAW);
@@ -830,91 +673,65 @@ RlcmacUlDataBlock dec__RlcmacUlDataBlock(const OCTETSTRING& stream)
 	TTCN_Logger::log_event_str("dec_RlcmacUlDataBlock(): ret_val before return: ");
 	ret_val.log();
 	TTCN_Logger::end_event();
-
-	return ret_val;
-}
-
-static
-EgprsUlMacDataHeader dec__EgprsUlMacDataHeader_type1(const OCTETSTRING& stream)
-{
-	EgprsUlMacDataHeader ret_val;
-
-	fprintf(stderr, "FIXME: Not implemented! %s (%s:%u)\n", __func__, __FILE__, __LINE__);
-
-	return ret_val;
 }
 
-static
-EgprsUlMacDataHeader dec__EgprsUlMacDataHeader_type2(const OCTETSTRING& stream)
+RlcmacUlDataBlock dec__RlcmacUlDataBlock(const OCTETSTRING& stream)
 {
-	EgprsUlMacDataHeader ret_val;
+	RlcmacUlDataBlock ret_val;
 
-	fprintf(stderr, "FIXME: Not implemented! %s (%s:%u)\n", __func__, __FILE__, __LINE__);
+	dec_RlcmacUlDataBlock(stream, payload_len_2_coding_scheme(stream.lengthof()), ret_val);
 
 	return ret_val;
 }
 
-static
-EgprsUlMacDataHeader dec__EgprsUlMacDataHeader_type3(const OCTETSTRING& stream)
+template <const struct egprs_ul_hdr_desc &D>
+static EgprsUlMacDataHeader dec_EgprsUlMacDataHeader(const uint8_t *data)
 {
-	TTCN_Buffer ttcn_buffer(stream);
 	EgprsUlMacDataHeader ret_val;
-	const struct gprs_rlc_ul_header_egprs_3 *egprs3;
+	const uint64_t w = egprs_hdr_load<D.len>(data);
 	uint8_t tmp;
 
-	egprs3 = static_cast<const struct gprs_rlc_ul_header_egprs_3 *>
-		((const void *)ttcn_buffer.get_data());
-
-	ret_val.header__type() = EgprsHeaderType::RLCMAC__HDR__TYPE__3;
-	ret_val.tfi() = egprs3->tfi_lo << 2 | egprs3->tfi_hi << 0;
-	ret_val.countdown() = egprs3->cv;
-	tmp = egprs3->si;
+	ret_val.header__type() = egprs_hdr_type(D.type);
+	ret_val.tfi() = egprs_hdr_get(w, D.tfi);
+	ret_val.countdown() = egprs_hdr_get(w, D.cv);
+	tmp = egprs_hdr_get(w, D.si);
 	ret_val.foi__si() = BITSTRING(1, &tmp);
-	tmp = egprs3->r;
+	tmp = egprs_hdr_get(w, D.r);
 	ret_val.r__ri() = BITSTRING(1, &tmp);
-	ret_val.bsn1() = egprs3->bsn1_lo << 5 | egprs3->bsn1_hi << 0;
-	ret_val.cps() = egprs3->cps_lo << 2 | egprs3->cps_hi << 0;
-	ret_val.pfi__ind() = egprs3->pi;
-	tmp = egprs3->rsb;
+	ret_val.bsn1() = egprs_hdr_get(w, D.bsn1);
+	ret_val.bsn2__offset() = egprs_hdr_get(w, D.bsn2);
+	ret_val.cps() = egprs_hdr_get(w, D.cps);
+	ret_val.pfi__ind() = egprs_hdr_get(w, D.pi);
+	tmp = egprs_hdr_get(w, D.rsb);
 	ret_val.rsb() = BITSTRING(1, &tmp);
-	tmp = egprs3->spb;
-	ret_val.spb() = BITSTRING(2, &tmp);
+	if (D.spb.width) {
+		tmp = egprs_hdr_get(w, D.spb);
+		ret_val.spb() = BITSTRING(2, &tmp);
+	} else {
+		ret_val.spb() = OMIT_VALUE;
+	}
 
-	ttcn_buffer.increase_pos(sizeof(*egprs3));
 	return ret_val;
 }
 
-RlcmacUlEgprsDataBlock dec__RlcmacUlEgprsDataBlock(const OCTETSTRING& stream)
+/* decode the EGPRS UL data block of 'len' octets at 'data', using header type D */
+template <const struct egprs_ul_hdr_desc &D>
+static void dec_RlcmacUlEgprsDataBlock(const uint8_t *data, size_t len, CodingScheme::enum_type cs_mcs,
+	RlcmacUlEgprsDataBlock& ret_val)
 {
-	RlcmacUlEgprsDataBlock ret_val;
-	TTCN_Buffer ttcn_buffer(stream);
 	TTCN_Buffer aligned_buffer;
 	int num_llc_blocks = 0;
 	unsigned int data_block_bits, data_block_offsets[2];
 	unsigned int num_calls;
 	const uint8_t *ti_e;
 
-	ret_val.mcs() = payload_len_2_coding_scheme(stream.lengthof());
-	switch (ret_val.mcs()) {
-	case CodingScheme::MCS__1:
-	case CodingScheme::MCS__2:
-	case CodingScheme::MCS__3:
-	case CodingScheme::MCS__4:
-		ret_val.mac__hdr() = dec__EgprsUlMacDataHeader_type3(stream);
-		break;
-	case CodingScheme::MCS__5:
-	case CodingScheme::MCS__6:
-		ret_val.mac__hdr() = dec__EgprsUlMacDataHeader_type2(stream);
-		break;
-	case CodingScheme::MCS__7:
-	case CodingScheme::MCS__8:
-	case CodingScheme::MCS__9:
-		ret_val.mac__hdr() = dec__EgprsUlMacDataHeader_type1(stream);
-		break;
-	}
-	setup_rlc_mac_priv(ret_val.mcs(), ret_val.mac__hdr().header__type(), true,
-			   &num_calls, &data_block_bits, data_block_offsets);
-	get_egprs_data_block(ttcn_buffer, data_block_offsets[0], data_block_bits, aligned_buffer);
+	if (len < D.len)
+		TTCN_error("dec_RlcmacUlEgprsDataBlock(): block too short (%zu bytes)", len);
+
+	ret_val.mcs() = cs_mcs;
+	ret_val.mac__hdr() = dec_EgprsUlMacDataHeader<D>(data);
+	setup_rlc_mac_priv(cs_mcs, egprs_hdr_type(D.type), true, &num_calls, &data_block_bits, data_block_offsets);
+	get_egprs_data_block(data, len, data_block_offsets[0], data_block_bits, aligned_buffer);
 
 	ti_e = aligned_buffer.get_read_data();
 	ret_val.tlli__ind() = *ti_e & 0x02 ? true : false;
@@ -975,6 +792,38 @@ RlcmacUlEgprsDataBlock dec__RlcmacUlEgprsDataBlock(const OCTETSTRING& stream)
 			}
 		}
 	}
+}
+
+typedef void (*ul_egprs_dec_fn)(const uint8_t *data, size_t len, CodingScheme::enum_type cs_mcs,
+				RlcmacUlEgprsDataBlock& ret_val);
+
+/* select the EGPRS UL data block decoder for the header type used by 'cs_mcs' */
+static ul_egprs_dec_fn ul_egprs_decoder(CodingScheme::enum_type cs_mcs)
+{
+	switch (cs_mcs) {
+	case CodingScheme::MCS__1:
+	case CodingScheme::MCS__2:
+	case CodingScheme::MCS__3:
+	case CodingScheme::MCS__4:
+		return dec_RlcmacUlEgprsDataBlock<egprs_ul_hdr_3>;
+	case CodingScheme::MCS__5:
+	case CodingScheme::MCS__6:
+		return dec_RlcmacUlEgprsDataBlock<egprs_ul_hdr_2>;
+	case CodingScheme::MCS__7:
+	case CodingScheme::MCS__8:
+	case CodingScheme::MCS__9:
+		return dec_RlcmacUlEgprsDataBlock<egprs_ul_hdr_1>;
+	default:
+		TTCN_error("%s is not an EGPRS coding scheme", CodingScheme::enum_to_str(cs_mcs));
+	}
+}
+
+RlcmacUlEgprsDataBlock dec__RlcmacUlEgprsDataBlock(const OCTETSTRING& stream)
+{
+	RlcmacUlEgprsDataBlock ret_val;
+	CodingScheme::enum_type cs_mcs = payload_len_2_coding_scheme(stream.lengthof());
+
+	ul_egprs_decoder(cs_mcs)((const uint8_t *)stream, stream.lengthof(), cs_mcs, ret_val);
 
 	return ret_val;
 }
@@ -1013,6 +862,164 @@ RlcmacUlBlock dec__RlcmacUlBlock(const OCTETSTRING& stream)
 	return ret_val;
 }
 
+/* PEEK */
+
+template <const struct egprs_dl_hdr_desc &D>
+static void peek_egprs_dl_header(const uint8_t *data, RlcmacDlBlockPeek& ret_val)
+{
+	const uint64_t w = egprs_hdr_load<D.len>(data);
+	uint8_t tmp;
+
+	ret_val.usf() = egprs_hdr_get(w, D.usf);
+	ret_val.rrbp() = egprs_hdr_get(w, D.rrbp);
+	tmp = egprs_hdr_get(w, D.es_p);
+	ret_val.rrbp__valid() = tmp != 0;
+	ret_val.esp() = BITSTRING(2, &tmp);
+	ret_val.tfi() = egprs_hdr_get(w, D.tfi);
+	ret_val.bsn() = egprs_hdr_get(w, D.bsn1);
+}
+
+/* Extract only the fields needed to route a downlink block (coding scheme,
+ * USF, RRBP + S/P or ES/P, TFI and BSN) straight from the packed header,
+ * without realigning the payload or decoding any LLC blocks */
+RlcmacDlBlockPeek dec__RlcmacDlBlockPeek(const OCTETSTRING& stream)
+{
+	RlcmacDlBlockPeek ret_val;
+	const uint8_t *data = (const uint8_t *)stream;
+	size_t stream_len = stream.lengthof();
+	CodingScheme::enum_type cs_mcs;
+
+	if (stream_len < egprs_dl_hdr_1.len)
+		TTCN_error("dec_RlcmacDlBlockPeek(): block too short (%zu bytes)", stream_len);
+
+	cs_mcs = payload_len_2_coding_scheme(stream_len);
+	ret_val.cs() = cs_mcs;
+
+	switch (cs_mcs) {
+	case CodingScheme::CS__1:
+	case CodingScheme::CS__2:
+	case CodingScheme::CS__3:
+	case CodingScheme::CS__4:
+		/* TS 44.060 10.2.1 / 10.3.1: PT, RRBP, S/P, USF */
+		ret_val.payload__type() = data[0] >> 6;
+		ret_val.rrbp() = (data[0] >> 4) & 0x03;
+		ret_val.rrbp__valid() = (data[0] >> 3) & 0x01;
+		ret_val.usf() = data[0] & 0x07;
+		ret_val.esp() = OMIT_VALUE;
+		if ((data[0] >> 6) == MacPayloadType::MAC__PT__RLC__DATA) {
+			/* PR, TFI, FBI + BSN, E */
+			ret_val.tfi() = (data[1] >> 1) & 0x1f;
+			ret_val.bsn() = data[2] >> 1;
+		} else {
+			ret_val.tfi() = OMIT_VALUE;
+			ret_val.bsn() = OMIT_VALUE;
+		}
+		break;
+	case CodingScheme::MCS__7:
+	case CodingScheme::MCS__8:
+	case CodingScheme::MCS__9:
+		ret_val.payload__type() = MacPayloadType::MAC__PT__RLC__DATA;
+		peek_egprs_dl_header<egprs_dl_hdr_1>(data, ret_val);
+		break;
+	case CodingScheme::MCS__5:
+	case CodingScheme::MCS__6:
+		ret_val.payload__type() = MacPayloadType::MAC__PT__RLC__DATA;
+		peek_egprs_dl_header<egprs_dl_hdr_2>(data, ret_val);
+		break;
+	default:
+		ret_val.payload__type() = MacPayloadType::MAC__PT__RLC__DATA;
+		peek_egprs_dl_header<egprs_dl_hdr_3>(data, ret_val);
+		break;
+	}
+
+	return ret_val;
+}
+
+/* BATCH DECODE */
+
+/* Decode a stream of concatenated RLC/MAC blocks of 'block_len' octets each,
+ * such as all blocks received on one PDCH during a multiframe.  The coding
+ * scheme (and with it GPRS vs. EGPRS and the EGPRS header type) is derived
+ * only once from the block length, rather than once per block.  EGPRS blocks
+ * are decoded directly from 'stream' at their offset. */
+static int batch_num_blocks(const char *fn, const OCTETSTRING& stream, const INTEGER& block_len)
+{
+	int stream_len = stream.lengthof();
+	int blk_len = block_len;
+
+	if (blk_len <= 0 || stream_len % blk_len != 0)
+		TTCN_error("%s(): stream length %d is not a multiple of block length %d",
+			   fn, stream_len, blk_len);
+
+	return stream_len / blk_len;
+}
+
+RlcmacDlBlocks dec__RlcmacDlBlocks(const OCTETSTRING& stream, const INTEGER& block_len)
+{
+	RlcmacDlBlocks ret_val;
+	const unsigned char *data = (const unsigned char *)stream;
+	int num_blocks = batch_num_blocks("dec_RlcmacDlBlocks", stream, block_len);
+	int blk_len = block_len;
+	CodingScheme::enum_type cs_mcs = payload_len_2_coding_scheme(blk_len);
+
+	ret_val.set_size(num_blocks);
+
+	if (cs_mcs >= CodingScheme::MCS__0) {
+		/* EGPRS data blocks are decoded in place from 'stream' */
+		dl_egprs_dec_fn dec_fn = dl_egprs_decoder(cs_mcs);
+
+		for (int i = 0; i < num_blocks; i++)
+			dec_fn(data + i * blk_len, blk_len, cs_mcs, ret_val[i].data__egprs());
+		return ret_val;
+	}
+
+	/* GPRS blocks are RAW decoded, which requires a buffer per block */
+	for (int i = 0; i < num_blocks; i++) {
+		const unsigned char *blk_data = data + i * blk_len;
+		OCTETSTRING blk(blk_len, blk_data);
+
+		if ((blk_data[0] >> 6) == MacPayloadType::MAC__PT__RLC__DATA)
+			dec_RlcmacDlDataBlock(blk, cs_mcs, ret_val[i].data());
+		else
+			ret_val[i].ctrl() = dec__RlcmacDlCtrlBlock(blk);
+	}
+
+	return ret_val;
+}
+
+RlcmacUlBlocks dec__RlcmacUlBlocks(const OCTETSTRING& stream, const INTEGER& block_len)
+{
+	RlcmacUlBlocks ret_val;
+	const unsigned char *data = (const unsigned char *)stream;
+	int num_blocks = batch_num_blocks("dec_RlcmacUlBlocks", stream, block_len);
+	int blk_len = block_len;
+	CodingScheme::enum_type cs_mcs = payload_len_2_coding_scheme(blk_len);
+
+	ret_val.set_size(num_blocks);
+
+	if (cs_mcs >= CodingScheme::MCS__0) {
+		/* EGPRS data blocks are decoded in place from 'stream' */
+		ul_egprs_dec_fn dec_fn = ul_egprs_decoder(cs_mcs);
+
+		for (int i = 0; i < num_blocks; i++)
+			dec_fn(data + i * blk_len, blk_len, cs_mcs, ret_val[i].data__egprs());
+		return ret_val;
+	}
+
+	/* GPRS blocks are RAW decoded, which requires a buffer per block */
+	for (int i = 0; i < num_blocks; i++) {
+		const unsigned char *blk_data = data + i * blk_len;
+		OCTETSTRING blk(blk_len, blk_data);
+
+		if ((blk_data[0] >> 6) == MacPayloadType::MAC__PT__RLC__DATA)
+			dec_RlcmacUlDataBlock(blk, cs_mcs, ret_val[i].data());
+		else
+			ret_val[i].ctrl() = dec__RlcmacUlCtrlBlock(blk);
+	}
+
+	return ret_val;
+}
+
 
 /////////////////////
 // ENCODE
@@ -1231,74 +1238,28 @@ OCTETSTRING enc__RlcmacUlDataBlock(const RlcmacUlDataBlock& si)
 	return ret_val;
 }
 
-static
-void enc__RlcmacUlEgprsDataHeader_type1(const EgprsUlMacDataHeader& si, TTCN_Buffer& ttcn_buffer)
-{
-	struct gprs_rlc_ul_header_egprs_1 egprs1;
-
-	egprs1.r = bs2uint8(si.r__ri());
-	egprs1.si = bs2uint8(si.foi__si());
-	egprs1.cv = si.countdown();
-	egprs1.tfi_hi = si.tfi() >> 0;
-	egprs1.tfi_lo = si.tfi() >> 2;
-	egprs1.bsn1_hi = si.bsn1() >> 0;
-	egprs1.bsn1_lo = si.bsn1() >> 5;
-	egprs1.bsn2_hi = si.bsn2__offset() >> 0;
-	egprs1.bsn2_lo = si.bsn2__offset() >> 2;
-	egprs1.cps = si.cps();
-	egprs1.rsb = bs2uint8(si.rsb());
-	egprs1.pi = si.pfi__ind();
-	egprs1.spare_hi = 0;
-	egprs1.spare_lo = 0;
-	egprs1.dummy = 0;
-
-	ttcn_buffer.put_s(sizeof(egprs1), (const unsigned char *)&egprs1);
-}
-
-static
-void enc__RlcmacUlEgprsDataHeader_type2(const EgprsUlMacDataHeader& si, TTCN_Buffer& ttcn_buffer)
-{
-	struct gprs_rlc_ul_header_egprs_2 egprs2;
-
-	egprs2.r = bs2uint8(si.r__ri());
-	egprs2.si = bs2uint8(si.foi__si());
-	egprs2.cv = si.countdown();
-	egprs2.tfi_hi = si.tfi() >> 0;
-	egprs2.tfi_lo = si.tfi() >> 2;
-	egprs2.bsn1_hi = si.bsn1() >> 0;
-	egprs2.bsn1_lo = si.bsn1() >> 5;
-	egprs2.cps_hi = si.cps() >> 0;
-	egprs2.cps_lo = si.cps() >> 2;
-	egprs2.rsb = bs2uint8(si.rsb());
-	egprs2.pi = si.pfi__ind();
-	egprs2.spare_hi = 0;
-	egprs2.spare_lo = 0;
-	egprs2.dummy = 0;
-
-	ttcn_buffer.put_s(sizeof(egprs2), (const unsigned char *)&egprs2);
-}
-
-static
-void enc__RlcmacUlEgprsDataHeader_type3(const EgprsUlMacDataHeader& si, TTCN_Buffer& ttcn_buffer)
+template <const struct egprs_ul_hdr_desc &D>
+static void enc_RlcmacUlEgprsDataHeader(const EgprsUlMacDataHeader& si, TTCN_Buffer& ttcn_buffer)
 {
-	struct gprs_rlc_ul_header_egprs_3 egprs3;
-
-	egprs3.r = bs2uint8(si.r__ri());
-	egprs3.si = bs2uint8(si.foi__si());
-	egprs3.cv = si.countdown();
-	egprs3.tfi_hi = si.tfi() >> 0;
-	egprs3.tfi_lo = si.tfi() >> 2;
-	egprs3.bsn1_hi = si.bsn1() >> 0;
-	egprs3.bsn1_lo = si.bsn1() >> 5;
-	egprs3.cps_hi = si.cps() >> 0;
-	egprs3.cps_lo = si.cps() >> 2;
-	egprs3.spb = bs2uint8(si.spb());
-	egprs3.rsb = bs2uint8(si.rsb());
-	egprs3.pi = si.pfi__ind();
-	egprs3.spare = 0;
-	egprs3.dummy = 0;
-
-	ttcn_buffer.put_s(sizeof(egprs3), (const unsigned char *)&egprs3);
+	uint8_t hdr[D.len];
+	uint64_t w = 0;
+
+	/* spare and dummy bits remain zero */
+	w = egprs_hdr_put(w, D.r, bs2uint8(si.r__ri()));
+	w = egprs_hdr_put(w, D.si, bs2uint8(si.foi__si()));
+	w = egprs_hdr_put(w, D.cv, si.countdown());
+	w = egprs_hdr_put(w, D.tfi, si.tfi());
+	w = egprs_hdr_put(w, D.bsn1, si.bsn1());
+	if (D.bsn2.width)
+		w = egprs_hdr_put(w, D.bsn2, si.bsn2__offset());
+	w = egprs_hdr_put(w, D.cps, si.cps());
+	if (D.spb.width)
+		w = egprs_hdr_put(w, D.spb, bs2uint8(si.spb()));
+	w = egprs_hdr_put(w, D.rsb, bs2uint8(si.rsb()));
+	w = egprs_hdr_put(w, D.pi, si.pfi__ind());
+
+	egprs_hdr_store<D.len>(hdr, w);
+	ttcn_buffer.put_s(sizeof(hdr), hdr);
 }
 
 OCTETSTRING enc__RlcmacUlEgprsDataBlock(const RlcmacUlEgprsDataBlock& si)
@@ -1331,13 +1292,13 @@ OCTETSTRING enc__RlcmacUlEgprsDataBlock(const RlcmacUlEgprsDataBlock& si)
 
 	switch (in.mac__hdr().header__type()) {
 	case EgprsHeaderType::RLCMAC__HDR__TYPE__1:
-		enc__RlcmacUlEgprsDataHeader_type1(in.mac__hdr(), ttcn_buffer);
+		enc_RlcmacUlEgprsDataHeader<egprs_ul_hdr_1>(in.mac__hdr(), ttcn_buffer);
 		break;
 	case EgprsHeaderType::RLCMAC__HDR__TYPE__2:
-		enc__RlcmacUlEgprsDataHeader_type2(in.mac__hdr(), ttcn_buffer);
+		enc_RlcmacUlEgprsDataHeader<egprs_ul_hdr_2>(in.mac__hdr(), ttcn_buffer);
 		break;
 	case EgprsHeaderType::RLCMAC__HDR__TYPE__3:
-		enc__RlcmacUlEgprsDataHeader_type3(in.mac__hdr(), ttcn_buffer);
+		enc_RlcmacUlEgprsDataHeader<egprs_ul_hdr_3>(in.mac__hdr(), ttcn_buffer);
 	default:
 		break; /* TODO: error */
 	}
@@ -1,6 +1,27 @@
 #include "IPL4asp_PortType.hh"
 #include "RTP_CodecPort.hh"
 #include "IPL4asp_PT.hh"
+#include "RTP_CodecPort_CtrlFunct.hh"
+
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace RTP__CodecPort__CtrlFunct {
 
@@ -52,5 +73,763 @@ namespace RTP__CodecPort__CtrlFunct {
     return f__IPL4__PROVIDER__getUserData(portRef, connId, userData);
   }
   
+
+  /* Native RTP stream engine, see RTP_CodecPort_CtrlFunct.ttcn.
+   *
+   * A single thread per component process waits (epoll) on the RTP sockets
+   * and on one timerfd per stream, which paces transmission. The TTCN-3
+   * side only configures streams and collects counters/events, all under
+   * rtp_native_lock. */
+
+  #define RTP_NATIVE_HDR_LEN	12
+  #define RTP_NATIVE_MAX_EVENTS	64
+  /* limit of frames sent at once to catch up after the thread was delayed */
+  #define RTP_NATIVE_MAX_CATCHUP	10
+  /* sequence number jumps considered as loss resp. reordering (RFC 3550 A.1) */
+  #define RTP_NATIVE_MAX_DROPOUT	3000
+  #define RTP_NATIVE_MAX_MISORDER	100
+  /* transmit times remembered per SSRC for the latency, indexed by the
+   * sequence number modulo this (a power of 2) */
+  #define RTP_NATIVE_TX_LOG_LEN	4096
+  /* latencies beyond this are not sampled (an entry of the transmit log
+   * from a previous wrap-around of the sequence number) */
+  #define RTP_NATIVE_MAX_LATENCY_US	10000000
+
+  /* upper bounds of the histogram buckets, plus one bucket for anything
+   * above; copied from c_RtpNative*Buckets of RTP_CodecPort_CtrlFunct.ttcn
+   * when the engine is started */
+  static std::vector<long long> rtp_native_loss_run_buckets;
+  static std::vector<long long> rtp_native_latency_buckets_us;
+
+  struct rtp_native_payload {
+    int payload_type;
+    bool has_fixed;
+    std::vector<unsigned char> fixed;
+  };
+
+  struct rtp_native_stats {
+    long long num_pkts_tx;
+    long long bytes_payload_tx;
+    long long num_pkts_rx;
+    long long bytes_payload_rx;
+    long long num_pkts_rx_err_pt;
+    long long num_pkts_rx_err_disabled;
+    long long num_pkts_rx_err_payload;
+
+    /* reception quality */
+    double jitter_us;
+    double jitter_max_us;
+    long long num_pkts_reordered;
+    long long max_reorder_depth;
+    long long max_loss_run;
+    std::vector<long long> loss_run_hist;
+    long long num_pkts_latency_unknown;
+    long long latency_min_us;
+    long long latency_max_us;
+    std::vector<long long> latency_hist;
+  };
+
+  struct rtp_native_tx_time {
+    int seq;	/* -1: unused */
+    long long time_ns;
+  };
+
+  struct rtp_native_event {
+    RtpNativeEventType::enum_type ev_type;
+    int seq;
+    long long ts;
+    int payload_type;
+  };
+
+  struct rtp_native_stream {
+    bool in_use;
+    int fd;
+    int tfd;
+
+    bool connected;
+    bool tx_enabled;
+    bool rx_enabled;
+    bool loopback;
+
+    /* configuration */
+    uint32_t ssrc;
+    int samplerate_hz;
+    int duration_ms;
+    uint32_t ts_inc;
+    std::vector<struct rtp_native_payload> tx_payloads;
+    std::vector<struct rtp_native_payload> rx_payloads;
+
+    /* transmit state */
+    bool tx_running;
+    uint16_t tx_next_seq;
+    uint32_t tx_next_ts;
+
+    /* receive state, for checking seq/ts increments; the timestamp
+     * increment is learned from the received stream (0: not yet known) */
+    bool rx_synced;
+    uint32_t rx_ssrc;
+    uint16_t rx_last_seq;
+    uint32_t rx_last_ts;
+    int rx_last_pt;
+    uint32_t rx_ts_inc;
+
+    /* receive state of the current source for the quality statistics,
+     * sequence numbers extended by the number of wrap-arounds */
+    long long rx_base_seq;
+    long long rx_max_seq;
+    long long rx_received;
+    long long rx_lost_prev;	/* lost from earlier sources */
+    bool rx_have_transit;
+    double rx_transit;	/* in timestamp units */
+
+    struct rtp_native_stats stats;
+    std::deque<struct rtp_native_event> events;
+  };
+
+  static std::mutex rtp_native_lock;
+  static std::vector<struct rtp_native_stream> rtp_native_streams;
+  static int rtp_native_epfd = -1;
+  /* Transmit times of the frames sent by all streams of this process, per
+   * SSRC, so that the latency is known for frames which are received by
+   * another stream of this process, or which the peer reflects. Streams
+   * sharing an SSRC overwrite each other's entries, the sequence number
+   * check then mostly makes the latency unknown. */
+  static std::unordered_map<uint32_t, std::vector<struct rtp_native_tx_time>> rtp_native_tx_log;
+
+  static struct rtp_native_stream &rtp_native_get(const INTEGER& stream)
+  {
+    int i = stream;
+
+    if (i < 0 || (size_t)i >= rtp_native_streams.size() || !rtp_native_streams[i].in_use)
+      TTCN_error("RTP native engine: invalid stream %d", i);
+    return rtp_native_streams[i];
+  }
+
+  static void rtp_native_event(struct rtp_native_stream &st, RtpNativeEventType::enum_type ev_type,
+                               int seq, long long ts, int payload_type)
+  {
+    /* the counters are authoritative, events are details for the log */
+    if (st.events.size() >= RTP_NATIVE_MAX_EVENTS)
+      return;
+    st.events.push_back({ev_type, seq, ts, payload_type});
+  }
+
+  static long long rtp_native_now_ns()
+  {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+  }
+
+  /* forget the transmit times of ssrc, unless another stream still uses it */
+  static void rtp_native_tx_log_del(uint32_t ssrc)
+  {
+    for (const struct rtp_native_stream &st : rtp_native_streams) {
+      if (st.in_use && st.ssrc == ssrc)
+        return;
+    }
+    rtp_native_tx_log.erase(ssrc);
+  }
+
+  /* (re-)arm or disarm the transmit timer according to the stream state */
+  static void rtp_native_timer_update(struct rtp_native_stream &st)
+  {
+    bool run = st.tx_enabled && st.connected && st.duration_ms > 0;
+    struct itimerspec its;
+
+    if (run == st.tx_running)
+      return;
+    memset(&its, 0, sizeof(its));
+    if (run) {
+      its.it_interval.tv_sec = st.duration_ms / 1000;
+      its.it_interval.tv_nsec = (st.duration_ms % 1000) * 1000000L;
+      its.it_value = its.it_interval;
+    }
+    timerfd_settime(st.tfd, 0, &its, NULL);
+    st.tx_running = run;
+  }
+
+  static void rtp_native_tx(struct rtp_native_stream &st, int payload_type,
+                            const unsigned char *payload, size_t payload_len)
+  {
+    unsigned char buf[RTP_NATIVE_HDR_LEN + 65536];
+    ssize_t rc;
+
+    if (payload_len > sizeof(buf) - RTP_NATIVE_HDR_LEN)
+      return;
+    buf[0] = 0x80; /* version 2, no padding/extension/CSRC */
+    buf[1] = payload_type & 0x7f;
+    buf[2] = st.tx_next_seq >> 8;
+    buf[3] = st.tx_next_seq;
+    buf[4] = st.tx_next_ts >> 24;
+    buf[5] = st.tx_next_ts >> 16;
+    buf[6] = st.tx_next_ts >> 8;
+    buf[7] = st.tx_next_ts;
+    buf[8] = st.ssrc >> 24;
+    buf[9] = st.ssrc >> 16;
+    buf[10] = st.ssrc >> 8;
+    buf[11] = st.ssrc;
+    if (payload_len)
+      memcpy(buf + RTP_NATIVE_HDR_LEN, payload, payload_len);
+
+    rc = send(st.fd, buf, RTP_NATIVE_HDR_LEN + payload_len, 0);
+    if (rc < 0) {
+      if (errno == ECONNREFUSED)
+        rtp_native_event(st, RtpNativeEventType::RTP__NATIVE__EV__CONN__REFUSED, -1, -1, -1);
+      return;
+    }
+
+    std::vector<struct rtp_native_tx_time> &log = rtp_native_tx_log[st.ssrc];
+    if (log.empty())
+      log.assign(RTP_NATIVE_TX_LOG_LEN, {-1, 0});
+    log[st.tx_next_seq % RTP_NATIVE_TX_LOG_LEN] = {st.tx_next_seq, rtp_native_now_ns()};
+
+    /* like RTP_Emulation.f_tx_rtp() */
+    st.tx_next_seq++;
+    st.tx_next_ts += st.ts_inc;
+    st.stats.num_pkts_tx++;
+    st.stats.bytes_payload_tx += payload_len;
+  }
+
+  static void rtp_native_tx_timer(struct rtp_native_stream &st)
+  {
+    uint64_t expirations;
+
+    if (read(st.tfd, &expirations, sizeof(expirations)) != sizeof(expirations))
+      return;
+    if (!st.tx_enabled || !st.connected || st.tx_payloads.empty())
+      return;
+    if (expirations > RTP_NATIVE_MAX_CATCHUP)
+      expirations = RTP_NATIVE_MAX_CATCHUP;
+    while (expirations--) {
+      const struct rtp_native_payload &pl = st.tx_payloads[st.tx_next_seq % st.tx_payloads.size()];
+      rtp_native_tx(st, pl.payload_type, pl.fixed.data(), pl.fixed.size());
+    }
+  }
+
+  /* same rules as RTP_Emulation.f_check_fixed_rx_payloads() */
+  static void rtp_native_check_payload(struct rtp_native_stream &st, int seq, uint32_t ts, int payload_type,
+                                       const unsigned char *payload, size_t payload_len)
+  {
+    bool payload_type_match = false;
+
+    if (st.rx_payloads.empty())
+      return;
+
+    for (const struct rtp_native_payload &pl : st.rx_payloads) {
+      if (pl.payload_type != payload_type)
+        continue;
+      if (!pl.has_fixed)
+        return;
+      if (pl.fixed.size() == payload_len && (payload_len == 0 || !memcmp(pl.fixed.data(), payload, payload_len)))
+        return;
+      payload_type_match = true;
+    }
+
+    st.stats.num_pkts_rx_err_payload++;
+    if (!payload_type_match) {
+      st.stats.num_pkts_rx_err_pt++;
+      rtp_native_event(st, RtpNativeEventType::RTP__NATIVE__EV__ERR__PT, seq, ts, payload_type);
+    } else {
+      rtp_native_event(st, RtpNativeEventType::RTP__NATIVE__EV__ERR__PAYLOAD, seq, ts, payload_type);
+    }
+  }
+
+  static void rtp_native_hist_add(std::vector<long long> &hist, const std::vector<long long> &bounds, long long val)
+  {
+    size_t i;
+
+    for (i = 0; i < bounds.size() && val > bounds[i]; i++)
+      ;
+    hist[i]++;
+  }
+
+  static long long rtp_native_rx_lost(const struct rtp_native_stream &st)
+  {
+    long long lost = 0;
+
+    if (st.rx_synced)
+      lost = st.rx_max_seq - st.rx_base_seq + 1 - st.rx_received;
+    /* duplicates may exceed the number of expected packets */
+    return st.rx_lost_prev + (lost > 0 ? lost : 0);
+  }
+
+  /* start over with the sequence number of a new source */
+  static void rtp_native_rx_sync(struct rtp_native_stream &st, uint16_t seq)
+  {
+    st.rx_lost_prev = rtp_native_rx_lost(st);
+    st.rx_synced = true;
+    st.rx_base_seq = seq;
+    st.rx_max_seq = seq;
+    st.rx_received = 0;
+    st.rx_have_transit = false;
+  }
+
+  /* loss runs and reordering, RFC 3550 A.1 */
+  static void rtp_native_rx_seq(struct rtp_native_stream &st, uint16_t seq)
+  {
+    uint16_t udelta = seq - (uint16_t)st.rx_max_seq;
+    long long depth;
+
+    if (udelta == 0) {
+      /* duplicate */
+    } else if (udelta < RTP_NATIVE_MAX_DROPOUT) {
+      if (udelta > 1) {
+        rtp_native_hist_add(st.stats.loss_run_hist, rtp_native_loss_run_buckets, udelta - 1);
+        if (udelta - 1 > st.stats.max_loss_run)
+          st.stats.max_loss_run = udelta - 1;
+      }
+      st.rx_max_seq += udelta;
+    } else if (udelta >= 65536 - RTP_NATIVE_MAX_MISORDER) {
+      depth = 65536 - udelta;
+      st.stats.num_pkts_reordered++;
+      if (depth > st.stats.max_reorder_depth)
+        st.stats.max_reorder_depth = depth;
+    } else {
+      /* the source restarted without changing its SSRC */
+      rtp_native_rx_sync(st, seq);
+    }
+    st.rx_received++;
+  }
+
+  /* interarrival jitter (RFC 3550 A.8), and the latency since the frame
+   * was sent if it was sent by this process, see rtp_native_tx_log */
+  static void rtp_native_rx_timing(struct rtp_native_stream &st, uint32_t ssrc, uint16_t seq, uint32_t ts)
+  {
+    long long now_ns = rtp_native_now_ns();
+    double transit, d, latency_us;
+
+    if (st.samplerate_hz > 0) {
+      /* arrival time in timestamp units, modulo 2^32 as the timestamp */
+      transit = fmod((double)now_ns * st.samplerate_hz / 1e9, 4294967296.0) - ts;
+      if (transit < -2147483648.0)
+        transit += 4294967296.0;
+      else if (transit >= 2147483648.0)
+        transit -= 4294967296.0;
+
+      if (st.rx_have_transit) {
+        d = fabs(transit - st.rx_transit) * 1e6 / st.samplerate_hz;
+        st.stats.jitter_us += (d - st.stats.jitter_us) / 16;
+        if (st.stats.jitter_us > st.stats.jitter_max_us)
+          st.stats.jitter_max_us = st.stats.jitter_us;
+      }
+      st.rx_transit = transit;
+      st.rx_have_transit = true;
+    }
+
+    auto it = rtp_native_tx_log.find(ssrc);
+    if (it == rtp_native_tx_log.end() || it->second[seq % RTP_NATIVE_TX_LOG_LEN].seq != seq) {
+      st.stats.num_pkts_latency_unknown++;
+      return;
+    }
+    latency_us = (now_ns - it->second[seq % RTP_NATIVE_TX_LOG_LEN].time_ns) / 1000.0;
+    if (latency_us < 0 || latency_us > RTP_NATIVE_MAX_LATENCY_US) {
+      st.stats.num_pkts_latency_unknown++;
+      return;
+    }
+    if (st.stats.latency_min_us < 0 || latency_us < st.stats.latency_min_us)
+      st.stats.latency_min_us = latency_us;
+    if (latency_us > st.stats.latency_max_us)
+      st.stats.latency_max_us = latency_us;
+    rtp_native_hist_add(st.stats.latency_hist, rtp_native_latency_buckets_us, latency_us);
+  }
+
+  /* Like RTP_Emulation, which doesn't check seq/ts at all, irregular
+   * increments are no errors: they are only reported as events. The
+   * timestamp increment is the one between the first two consecutive frames
+   * of a source and payload type, as the peer may use another samplerate or
+   * frame duration than configured for transmission. */
+  static void rtp_native_check_seq_ts(struct rtp_native_stream &st, uint32_t ssrc, uint16_t seq,
+                                      uint32_t ts, bool marker, int payload_type)
+  {
+    uint16_t seq_delta = seq - st.rx_last_seq;
+    uint32_t ts_delta = ts - st.rx_last_ts;
+
+    /* the first frame, or a new source, (re-)synchronizes the checks */
+    if (!st.rx_synced || ssrc != st.rx_ssrc) {
+      rtp_native_rx_sync(st, seq);
+      st.rx_ts_inc = 0;
+    } else if (seq_delta != 1) {
+      rtp_native_event(st, RtpNativeEventType::RTP__NATIVE__EV__ERR__SEQ, seq, ts, payload_type);
+    } else if (payload_type != st.rx_last_pt) {
+      /* another codec, learn its increment from the next frame on */
+      st.rx_ts_inc = 0;
+    } else if (!st.rx_ts_inc) {
+      /* learn the increment, unless a talkspurt gap is in between */
+      st.rx_ts_inc = marker ? 0 : ts_delta;
+    } else if (marker ? ts_delta < st.rx_ts_inc || ts_delta >= 0x80000000 || ts_delta % st.rx_ts_inc
+                      : ts_delta != st.rx_ts_inc) {
+      /* at the start of a talkspurt, the timestamp also advanced by the
+       * frames not sent during silence (RFC 3550 5.1), but only by those */
+      rtp_native_event(st, RtpNativeEventType::RTP__NATIVE__EV__ERR__TS, seq, ts, payload_type);
+    }
+    st.rx_ssrc = ssrc;
+    st.rx_last_seq = seq;
+    st.rx_last_ts = ts;
+    st.rx_last_pt = payload_type;
+
+    rtp_native_rx_seq(st, seq);
+    rtp_native_rx_timing(st, ssrc, seq, ts);
+  }
+
+  static void rtp_native_rx_one(struct rtp_native_stream &st, const unsigned char *buf, size_t len)
+  {
+    size_t hdr_len, pad_len = 0;
+    bool marker;
+    int payload_type;
+    uint16_t seq;
+    uint32_t ts, ssrc;
+
+    if (!st.rx_enabled) {
+      st.stats.num_pkts_rx_err_disabled++;
+      rtp_native_event(st, RtpNativeEventType::RTP__NATIVE__EV__ERR__DISABLED, -1, -1, -1);
+      return;
+    }
+
+    /* fixed header, CSRCs, header extension and padding (RFC 3550 5.1) */
+    hdr_len = RTP_NATIVE_HDR_LEN + (buf[0] & 0x0f) * 4;
+    if (len < RTP_NATIVE_HDR_LEN || (buf[0] >> 6) != 2 || len < hdr_len)
+      goto malformed;
+    if (buf[0] & 0x10) {
+      if (len < hdr_len + 4)
+        goto malformed;
+      hdr_len += 4 + ((buf[hdr_len + 2] << 8) | buf[hdr_len + 3]) * 4;
+      if (len < hdr_len)
+        goto malformed;
+    }
+    if (buf[0] & 0x20) {
+      pad_len = buf[len - 1];
+      if (pad_len == 0 || len < hdr_len + pad_len)
+        goto malformed;
+    }
+
+    marker = buf[1] & 0x80;
+    payload_type = buf[1] & 0x7f;
+    seq = (buf[2] << 8) | buf[3];
+    ts = ((uint32_t)buf[4] << 24) | (buf[5] << 16) | (buf[6] << 8) | buf[7];
+    ssrc = ((uint32_t)buf[8] << 24) | (buf[9] << 16) | (buf[10] << 8) | buf[11];
+    len -= hdr_len + pad_len;
+    buf += hdr_len;
+
+    st.stats.num_pkts_rx++;
+    st.stats.bytes_payload_rx += len;
+
+    if (st.loopback) {
+      rtp_native_tx(st, payload_type, buf, len);
+      return;
+    }
+    rtp_native_check_seq_ts(st, ssrc, seq, ts, marker, payload_type);
+    rtp_native_check_payload(st, seq, ts, payload_type, buf, len);
+    return;
+
+  malformed:
+    st.stats.num_pkts_rx_err_payload++;
+    rtp_native_event(st, RtpNativeEventType::RTP__NATIVE__EV__ERR__MALFORMED, -1, -1, -1);
+  }
+
+  static void rtp_native_rx(struct rtp_native_stream &st)
+  {
+    unsigned char buf[65536];
+    ssize_t rc;
+
+    while ((rc = recv(st.fd, buf, sizeof(buf), 0)) >= 0 || errno == ECONNREFUSED) {
+      if (rc < 0) {
+        rtp_native_event(st, RtpNativeEventType::RTP__NATIVE__EV__CONN__REFUSED, -1, -1, -1);
+        continue;
+      }
+      rtp_native_rx_one(st, buf, rc);
+    }
+  }
+
+  /* epoll data: stream index in the upper, the fd in the lower 32 bits; the
+   * fd is checked against the stream as it may have been closed meanwhile */
+  static void rtp_native_thread()
+  {
+    struct epoll_event evs[64];
+    int n, i;
+
+    while (true) {
+      n = epoll_wait(rtp_native_epfd, evs, 64, -1);
+      if (n < 0)
+        continue;
+
+      std::lock_guard<std::mutex> guard(rtp_native_lock);
+      for (i = 0; i < n; i++) {
+        size_t idx = evs[i].data.u64 >> 32;
+        int fd = evs[i].data.u64 & 0xffffffff;
+
+        if (idx >= rtp_native_streams.size() || !rtp_native_streams[idx].in_use)
+          continue;
+        struct rtp_native_stream &st = rtp_native_streams[idx];
+        if (fd == st.tfd)
+          rtp_native_tx_timer(st);
+        else if (fd == st.fd)
+          rtp_native_rx(st);
+      }
+    }
+  }
+
+  static void rtp_native_buckets(std::vector<long long> &out, const RtpNativeHistogram& in)
+  {
+    out.resize(in.size_of());
+    for (int i = 0; i < in.size_of(); i++)
+      out[i] = in[i].get_long_long_val();
+  }
+
+  static void rtp_native_epoll_add(size_t idx, int fd)
+  {
+    struct epoll_event ev;
+
+    ev.events = EPOLLIN;
+    ev.data.u64 = ((uint64_t)idx << 32) | (uint32_t)fd;
+    if (epoll_ctl(rtp_native_epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+      TTCN_error("RTP native engine: epoll_ctl() failed: %s", strerror(errno));
+  }
+
+  static bool rtp_native_resolve(const char *host, int port, int family, struct sockaddr_storage *ss, socklen_t *len)
+  {
+    struct addrinfo hints, *res;
+    char serv[16];
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = family;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    snprintf(serv, sizeof(serv), "%d", port);
+    if (getaddrinfo(host, serv, &hints, &res) != 0)
+      return false;
+    memcpy(ss, res->ai_addr, res->ai_addrlen);
+    *len = res->ai_addrlen;
+    freeaddrinfo(res);
+    return true;
+  }
+
+  INTEGER f__rtp__native__bind(
+    const IPL4asp__Types::HostName& locName,
+    IPL4asp__Types::PortNumber& locPort)
+  {
+    struct sockaddr_storage ss;
+    socklen_t ss_len;
+    size_t idx;
+    int fd, tfd;
+
+    if (!rtp_native_resolve(locName, locPort, AF_UNSPEC, &ss, &ss_len)) {
+      TTCN_warning("RTP native engine: cannot resolve %s", (const char *)locName);
+      return -1;
+    }
+    fd = socket(ss.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+      return -1;
+    if (bind(fd, (struct sockaddr *)&ss, ss_len) < 0 ||
+        getsockname(fd, (struct sockaddr *)&ss, &ss_len) < 0) {
+      TTCN_warning("RTP native engine: cannot bind to %s:%d: %s", (const char *)locName,
+                   (int)locPort, strerror(errno));
+      close(fd);
+      return -1;
+    }
+    tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0) {
+      close(fd);
+      return -1;
+    }
+    locPort = ntohs(ss.ss_family == AF_INET6 ? ((struct sockaddr_in6 *)&ss)->sin6_port
+                                            : ((struct sockaddr_in *)&ss)->sin_port);
+
+    std::lock_guard<std::mutex> guard(rtp_native_lock);
+    if (rtp_native_epfd < 0) {
+      rtp_native_epfd = epoll_create1(EPOLL_CLOEXEC);
+      if (rtp_native_epfd < 0)
+        TTCN_error("RTP native engine: epoll_create1() failed: %s", strerror(errno));
+      rtp_native_buckets(rtp_native_loss_run_buckets, c__RtpNativeLossRunBuckets);
+      rtp_native_buckets(rtp_native_latency_buckets_us, c__RtpNativeLatencyBucketsUs);
+      std::thread(rtp_native_thread).detach();
+    }
+    for (idx = 0; idx < rtp_native_streams.size(); idx++) {
+      if (!rtp_native_streams[idx].in_use)
+        break;
+    }
+    if (idx == rtp_native_streams.size())
+      rtp_native_streams.emplace_back();
+
+    struct rtp_native_stream &st = rtp_native_streams[idx];
+    st = rtp_native_stream();
+    st.in_use = true;
+    st.stats.latency_min_us = -1;
+    st.stats.loss_run_hist.assign(rtp_native_loss_run_buckets.size() + 1, 0);
+    st.stats.latency_hist.assign(rtp_native_latency_buckets_us.size() + 1, 0);
+    st.fd = fd;
+    st.tfd = tfd;
+    rtp_native_epoll_add(idx, fd);
+    rtp_native_epoll_add(idx, tfd);
+    return (int)idx;
+  }
+
+  BOOLEAN f__rtp__native__connect(
+    const INTEGER& stream,
+    const IPL4asp__Types::HostName& remName,
+    const IPL4asp__Types::PortNumber& remPort)
+  {
+    struct sockaddr_storage ss;
+    socklen_t ss_len = sizeof(ss);
+    int fd;
+
+    {
+      std::lock_guard<std::mutex> guard(rtp_native_lock);
+      fd = rtp_native_get(stream).fd;
+    }
+    if (getsockname(fd, (struct sockaddr *)&ss, &ss_len) < 0 ||
+        !rtp_native_resolve(remName, remPort, ss.ss_family, &ss, &ss_len) ||
+        connect(fd, (struct sockaddr *)&ss, ss_len) < 0) {
+      TTCN_warning("RTP native engine: cannot connect to %s:%d", (const char *)remName, (int)remPort);
+      return false;
+    }
+
+    std::lock_guard<std::mutex> guard(rtp_native_lock);
+    struct rtp_native_stream &st = rtp_native_get(stream);
+    st.connected = true;
+    rtp_native_timer_update(st);
+    return true;
+  }
+
+  static void rtp_native_payloads(std::vector<struct rtp_native_payload> &out, const RtpNativePayloads& in)
+  {
+    out.resize(in.size_of());
+    for (int i = 0; i < in.size_of(); i++) {
+      out[i].payload_type = in[i].payload__type();
+      out[i].has_fixed = in[i].fixed__payload().ispresent();
+      if (out[i].has_fixed) {
+        const OCTETSTRING& fixed = in[i].fixed__payload()();
+        const unsigned char *data = fixed;
+        out[i].fixed.assign(data, data + fixed.lengthof());
+      } else {
+        out[i].fixed.clear();
+      }
+    }
+  }
+
+  void f__rtp__native__configure(
+    const INTEGER& stream,
+    const INTEGER& tx__samplerate__hz,
+    const INTEGER& tx__duration__ms,
+    const OCTETSTRING& tx__ssrc,
+    const RtpNativePayloads& tx__payloads,
+    const RtpNativePayloads& rx__payloads)
+  {
+    const unsigned char *ssrc = tx__ssrc;
+    int duration_ms = tx__duration__ms;
+    uint32_t old_ssrc;
+
+    if (duration_ms <= 0 || 1000 % duration_ms)
+      TTCN_error("RTP native engine: unsupported tx_duration_ms %d", duration_ms);
+
+    std::lock_guard<std::mutex> guard(rtp_native_lock);
+    struct rtp_native_stream &st = rtp_native_get(stream);
+    old_ssrc = st.ssrc;
+    st.ssrc = ((uint32_t)ssrc[0] << 24) | (ssrc[1] << 16) | (ssrc[2] << 8) | ssrc[3];
+    if (st.ssrc != old_ssrc)
+      rtp_native_tx_log_del(old_ssrc);
+    st.samplerate_hz = tx__samplerate__hz;
+    st.duration_ms = duration_ms;
+    /* same arithmetic as RTP_Emulation.f_tx_rtp() */
+    st.ts_inc = (int)tx__samplerate__hz / (1000 / duration_ms);
+    rtp_native_payloads(st.tx_payloads, tx__payloads);
+    rtp_native_payloads(st.rx_payloads, rx__payloads);
+    /* restart a running transmission with the new parameters */
+    st.tx_running = false;
+    rtp_native_timer_update(st);
+  }
+
+  void f__rtp__native__mode(
+    const INTEGER& stream,
+    const BOOLEAN& tx,
+    const BOOLEAN& rx,
+    const BOOLEAN& loopback)
+  {
+    std::lock_guard<std::mutex> guard(rtp_native_lock);
+    struct rtp_native_stream &st = rtp_native_get(stream);
+
+    if (rx && !st.rx_enabled && st.rx_synced) {
+      st.rx_lost_prev = rtp_native_rx_lost(st);
+      st.rx_synced = false;
+    }
+    st.tx_enabled = tx;
+    st.rx_enabled = rx;
+    st.loopback = loopback;
+    rtp_native_timer_update(st);
+  }
+
+  RtpNativeStats f__rtp__native__stats(const INTEGER& stream)
+  {
+    struct rtp_native_stats s;
+    long long lost;
+    RtpNativeStats ret_val;
+    size_t i;
+
+    {
+      std::lock_guard<std::mutex> guard(rtp_native_lock);
+      struct rtp_native_stream &st = rtp_native_get(stream);
+      s = st.stats;
+      lost = rtp_native_rx_lost(st);
+    }
+    ret_val.num__pkts__tx().set_long_long_val(s.num_pkts_tx);
+    ret_val.bytes__payload__tx().set_long_long_val(s.bytes_payload_tx);
+    ret_val.num__pkts__rx().set_long_long_val(s.num_pkts_rx);
+    ret_val.bytes__payload__rx().set_long_long_val(s.bytes_payload_rx);
+    ret_val.num__pkts__rx__err__pt().set_long_long_val(s.num_pkts_rx_err_pt);
+    ret_val.num__pkts__rx__err__disabled().set_long_long_val(s.num_pkts_rx_err_disabled);
+    ret_val.num__pkts__rx__err__payload().set_long_long_val(s.num_pkts_rx_err_payload);
+
+    RtpNativeQuality& q = ret_val.quality();
+    q.jitter__us() = (int)lround(s.jitter_us);
+    q.jitter__max__us() = (int)lround(s.jitter_max_us);
+    q.num__pkts__lost().set_long_long_val(lost);
+    q.num__pkts__reordered().set_long_long_val(s.num_pkts_reordered);
+    q.max__reorder__depth().set_long_long_val(s.max_reorder_depth);
+    q.max__loss__run().set_long_long_val(s.max_loss_run);
+    for (i = 0; i < s.loss_run_hist.size(); i++)
+      q.loss__run__hist()[i].set_long_long_val(s.loss_run_hist[i]);
+    q.num__pkts__latency__unknown().set_long_long_val(s.num_pkts_latency_unknown);
+    q.latency__min__us().set_long_long_val(s.latency_min_us);
+    q.latency__max__us().set_long_long_val(s.latency_max_us);
+    for (i = 0; i < s.latency_hist.size(); i++)
+      q.latency__hist()[i].set_long_long_val(s.latency_hist[i]);
+    return ret_val;
+  }
+
+  RtpNativeEvents f__rtp__native__events(const INTEGER& stream)
+  {
+    std::deque<struct rtp_native_event> events;
+    RtpNativeEvents ret_val(NULL_VALUE);
+    int i = 0;
+
+    {
+      std::lock_guard<std::mutex> guard(rtp_native_lock);
+      events.swap(rtp_native_get(stream).events);
+    }
+    for (const struct rtp_native_event &ev : events) {
+      ret_val[i].ev__type() = ev.ev_type;
+      ret_val[i].seq() = ev.seq;
+      ret_val[i].ts().set_long_long_val(ev.ts);
+      ret_val[i].payload__type() = ev.payload_type;
+      i++;
+    }
+    return ret_val;
+  }
+
+  void f__rtp__native__close(const INTEGER& stream)
+  {
+    std::lock_guard<std::mutex> guard(rtp_native_lock);
+    struct rtp_native_stream &st = rtp_native_get(stream);
+
+    epoll_ctl(rtp_native_epfd, EPOLL_CTL_DEL, st.fd, NULL);
+    epoll_ctl(rtp_native_epfd, EPOLL_CTL_DEL, st.tfd, NULL);
+    close(st.fd);
+    close(st.tfd);
+    st.in_use = false;
+    rtp_native_tx_log_del(st.ssrc);
+    st = rtp_native_stream();
+  }
+
 }
 
@@ -5,6 +5,10 @@
 #include <errno.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <vector>
+#include <thread>
+
 #include <Addfunc.hh>
 #include <Encdec.hh>
 #include <Boolean.hh>
@@ -12,7 +16,11 @@
 #include <Octetstring.hh>
 #include <Bitstring.hh>
 
+#include "Milenage_Functions.hh"
+
 #include "milenage.h"
+#include "key_derivation.h"
+#include "ng_key_derivation.h"
 
 namespace Milenage__Functions {
 
@@ -50,4 +58,240 @@ INTEGER f__milenage__check(const OCTETSTRING& opc, const OCTETSTRING& k,
 	return INTEGER(rc);
 }
 
+/* Contexts allocated by f__milenage__ctx__alloc(), indexed by ctx_id.
+ * Released slots are NULL and get re-used by subsequent allocations. */
+static std::vector<struct milenage_ctx *> milenage_ctxs;
+
+static struct milenage_ctx *milenage_ctx_get(const INTEGER& ctx_id)
+{
+	int id = (int)ctx_id;
+
+	if (id < 0 || (size_t)id >= milenage_ctxs.size() || !milenage_ctxs[id])
+		TTCN_error("Milenage ctx_id %d not allocated", id);
+	return milenage_ctxs[id];
+}
+
+INTEGER f__milenage__ctx__alloc(const OCTETSTRING& opc, const OCTETSTRING& k)
+{
+	struct milenage_ctx *ctx;
+	size_t id;
+
+	ctx = milenage_ctx_alloc((const u8 *)opc, (const u8 *)k);
+	if (!ctx)
+		TTCN_error("Failed to allocate Milenage context");
+
+	for (id = 0; id < milenage_ctxs.size(); id++) {
+		if (!milenage_ctxs[id])
+			break;
+	}
+	if (id == milenage_ctxs.size())
+		milenage_ctxs.push_back(ctx);
+	else
+		milenage_ctxs[id] = ctx;
+
+	return INTEGER((int)id);
+}
+
+void f__milenage__ctx__free(const INTEGER& ctx_id)
+{
+	int id = (int)ctx_id;
+
+	milenage_ctx_free(milenage_ctx_get(ctx_id));
+	milenage_ctxs[id] = NULL;
+}
+
+/* 3GPP TS 33.102 Figure 9, 3GPP TS 35.206 Annex 3 */
+INTEGER f__milenage__ctx__check(const INTEGER& ctx_id,
+				const OCTETSTRING& sqn, const OCTETSTRING& _rand, const OCTETSTRING& autn,
+				OCTETSTRING& ik, OCTETSTRING& ck, OCTETSTRING& res, OCTETSTRING& auts)
+{
+	struct milenage_ctx *ctx = milenage_ctx_get(ctx_id);
+	uint8_t buf_ik[16];
+	uint8_t buf_ck[16];
+	uint8_t buf_res[8];
+	uint8_t buf_auts[14];
+	size_t res_len = 0;
+	int rc;
+
+	rc = milenage_ctx_check(ctx, (const u8 *)sqn, (const u8 *)_rand, (const u8 *)autn,
+				buf_ik, buf_ck, buf_res, &res_len, buf_auts);
+
+	ik = OCTETSTRING(16, static_cast<const unsigned char*>(&buf_ik[0]));
+	ck = OCTETSTRING(16, static_cast<const unsigned char*>(&buf_ck[0]));
+	res = OCTETSTRING(res_len, static_cast<const unsigned char*>(&buf_res[0]));
+	auts = OCTETSTRING(14, static_cast<const unsigned char*>(&buf_auts[0]));
+
+	return INTEGER(rc);
+}
+
+/* 3GPP TS 33.102 Figure 7, 3GPP TS 35.206 Annex 3 */
+INTEGER f__milenage__ctx__generate(const INTEGER& ctx_id,
+				   const OCTETSTRING& sqn, const OCTETSTRING& _rand, const OCTETSTRING& amf,
+				   OCTETSTRING& autn, OCTETSTRING& ik, OCTETSTRING& ck, OCTETSTRING& res)
+{
+	struct milenage_ctx *ctx = milenage_ctx_get(ctx_id);
+	uint8_t buf_autn[16];
+	uint8_t buf_ik[16];
+	uint8_t buf_ck[16];
+	uint8_t buf_res[8];
+	size_t res_len = sizeof(buf_res);
+	int rc;
+
+	rc = milenage_ctx_generate(ctx, (const u8 *)amf, (const u8 *)sqn, (const u8 *)_rand,
+				   buf_autn, buf_ik, buf_ck, buf_res, &res_len);
+
+	autn = OCTETSTRING(16, static_cast<const unsigned char*>(&buf_autn[0]));
+	ik = OCTETSTRING(16, static_cast<const unsigned char*>(&buf_ik[0]));
+	ck = OCTETSTRING(16, static_cast<const unsigned char*>(&buf_ck[0]));
+	res = OCTETSTRING(res_len, static_cast<const unsigned char*>(&buf_res[0]));
+
+	return INTEGER(rc);
+}
+
+/* One element of f__milenage__gen__av__batch(), in plain buffers so that
+ * it can be processed by worker threads without touching TTCN-3 objects */
+struct milenage_av_job {
+	/* input */
+	uint8_t k[16];
+	uint8_t opc[16];
+	uint8_t sqn[6];
+	uint8_t rand[16];
+	uint8_t amf[2];
+	/* output */
+	uint8_t xres[8];
+	uint8_t ck[16];
+	uint8_t ik[16];
+	uint8_t autn[16];
+	uint8_t kasme[32];
+	uint8_t xres_star[16];
+	uint8_t kausf[32];
+	int rc;
+};
+
+struct milenage_av_batch {
+	std::vector<struct milenage_av_job> jobs;
+	const uint8_t *plmn_id;		/* NULL: no KASME */
+	const uint8_t *ssn;		/* NULL: no XRES*, KAUSF */
+	size_t ssn_len;
+};
+
+static void milenage_av_batch_run(struct milenage_av_batch *b, size_t first, size_t last)
+{
+	struct milenage_ctx *ctx = NULL;
+	const struct milenage_av_job *prev = NULL;
+
+	for (size_t i = first; i < last; i++) {
+		struct milenage_av_job *job = &b->jobs[i];
+		size_t res_len = sizeof(job->xres);
+		uint8_t ak[6];
+
+		/* Subscriber pools often carry several vectors per subscriber */
+		if (!prev || memcmp(prev->k, job->k, 16) || memcmp(prev->opc, job->opc, 16)) {
+			milenage_ctx_free(ctx);
+			ctx = milenage_ctx_alloc(job->opc, job->k);
+			if (!ctx) {
+				job->rc = -1;
+				prev = NULL;
+				continue;
+			}
+		}
+		prev = job;
+
+		job->rc = milenage_ctx_generate(ctx, job->amf, job->sqn, job->rand, job->autn,
+						job->ik, job->ck, job->xres, &res_len);
+		if (job->rc)
+			continue;
+
+		if (b->plmn_id) {
+			/* AUTN = (SQN ^ AK) || AMF || MAC */
+			for (int j = 0; j < 6; j++)
+				ak[j] = job->autn[j] ^ job->sqn[j];
+			hss_auc_kasme(job->ck, job->ik, b->plmn_id, job->sqn, ak, job->kasme);
+		}
+		if (b->ssn) {
+			kdf_xres_star(b->ssn, b->ssn_len, job->ck, job->ik, job->rand,
+				      job->xres, sizeof(job->xres), job->xres_star);
+			kdf_kausf(job->ck, job->ik, b->ssn, b->ssn_len, job->autn, job->kausf);
+		}
+	}
+	milenage_ctx_free(ctx);
+}
+
+/* 3GPP TS 33.102 Figure 7, TS 33.401 A.2, TS 33.501 A.2 + A.4 */
+MilenageAvList f__milenage__gen__av__batch(const MilenageAvParamsList& params,
+					   const OCTETSTRING& plmn_id, const OCTETSTRING& ssn,
+					   const INTEGER& num_threads)
+{
+	struct milenage_av_batch b;
+	MilenageAvList ret_val;
+	size_t num = params.size_of();
+	size_t n_threads = (int)num_threads > 1 ? (size_t)(int)num_threads : 1;
+
+	if (plmn_id.lengthof() != 0 && plmn_id.lengthof() != 3)
+		TTCN_error("PLMN-ID must be 3 octets, not %d", plmn_id.lengthof());
+	/* kdf_xres_star() and kdf_kausf() assemble their input on the stack */
+	if (ssn.lengthof() > c__milenage__av__ssn__max__len)
+		TTCN_error("Serving network name too long (%d octets, at most %d)",
+			   ssn.lengthof(), (int)c__milenage__av__ssn__max__len);
+
+	b.plmn_id = plmn_id.lengthof() ? (const uint8_t *)plmn_id : NULL;
+	b.ssn = ssn.lengthof() ? (const uint8_t *)ssn : NULL;
+	b.ssn_len = ssn.lengthof();
+
+	/* Copy all inputs out of the TTCN-3 objects before any thread is started */
+	b.jobs.resize(num);
+	for (size_t i = 0; i < num; i++) {
+		const MilenageAvParams& p = params[i];
+		struct milenage_av_job *job = &b.jobs[i];
+
+		memcpy(job->k, (const unsigned char *)p.k(), sizeof(job->k));
+		memcpy(job->opc, (const unsigned char *)p.opc(), sizeof(job->opc));
+		memcpy(job->sqn, (const unsigned char *)p.sqn(), sizeof(job->sqn));
+		memcpy(job->rand, (const unsigned char *)p.rand(), sizeof(job->rand));
+		memcpy(job->amf, (const unsigned char *)p.amf(), sizeof(job->amf));
+	}
+
+	if (n_threads > num)
+		n_threads = num;
+	if (n_threads <= 1) {
+		milenage_av_batch_run(&b, 0, num);
+	} else {
+		std::vector<std::thread> workers;
+		size_t chunk = (num + n_threads - 1) / n_threads;
+
+		for (size_t first = 0; first < num; first += chunk)
+			workers.emplace_back(milenage_av_batch_run, &b, first, std::min(first + chunk, num));
+		for (auto &w : workers)
+			w.join();
+	}
+
+	ret_val.set_size(num);
+	for (size_t i = 0; i < num; i++) {
+		const struct milenage_av_job *job = &b.jobs[i];
+		MilenageAv& av = ret_val[i];
+
+		if (job->rc)
+			TTCN_error("Milenage AV generation failed for element %zu", i);
+
+		av.rand() = OCTETSTRING(sizeof(job->rand), job->rand);
+		av.xres() = OCTETSTRING(sizeof(job->xres), job->xres);
+		av.ck() = OCTETSTRING(sizeof(job->ck), job->ck);
+		av.ik() = OCTETSTRING(sizeof(job->ik), job->ik);
+		av.autn() = OCTETSTRING(sizeof(job->autn), job->autn);
+		if (b.plmn_id)
+			av.kasme() = OCTETSTRING(sizeof(job->kasme), job->kasme);
+		else
+			av.kasme() = OMIT_VALUE;
+		if (b.ssn) {
+			av.xres__star() = OCTETSTRING(sizeof(job->xres_star), job->xres_star);
+			av.kausf() = OCTETSTRING(sizeof(job->kausf), job->kausf);
+		} else {
+			av.xres__star() = OMIT_VALUE;
+			av.kausf() = OMIT_VALUE;
+		}
+	}
+
+	return ret_val;
+}
+
 }
@@ -18,6 +18,9 @@
 
 #include "milenage.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+
 #include <openssl/err.h>            /* for ERR_print_errors_fp */
 #include <openssl/ssl.h>            /* for NID_sha1, RSA */
 #include <openssl/evp.h>            /* for EVP_PKEY, EVP_sha1(), ... */
@@ -77,12 +80,40 @@ int ast_aes_encrypt(const unsigned char *in, unsigned char *out, const struct as
 	return res;
 }
 
-static int aes_128_encrypt_block(const u8 *key, const u8 *plain, u8 *encr)
+/* Milenage context: AES-128 keyed with K once, re-used for all blocks of
+ * all f1..f5* invocations for the same subscriber. */
+struct milenage_ctx {
+	EVP_CIPHER_CTX *evp;
+	u8 opc[16];
+};
+
+static int milenage_ctx_init(struct milenage_ctx *ctx, const u8 *opc, const u8 *k)
+{
+	if ((ctx->evp = EVP_CIPHER_CTX_new()) == NULL)
+		return -1;
+	if (EVP_EncryptInit_ex(ctx->evp, EVP_aes_128_ecb(), NULL, k, NULL) <= 0) {
+		EVP_CIPHER_CTX_free(ctx->evp);
+		ctx->evp = NULL;
+		return -1;
+	}
+	/* ECB without padding: every 16 byte block passed to
+	 * EVP_EncryptUpdate() is encrypted independently and immediately */
+	EVP_CIPHER_CTX_set_padding(ctx->evp, 0);
+	memcpy(ctx->opc, opc, 16);
+	return 0;
+}
+
+static void milenage_ctx_cleanup(struct milenage_ctx *ctx)
 {
-	struct ast_aes aes_key;
+	EVP_CIPHER_CTX_free(ctx->evp);
+	ctx->evp = NULL;
+}
 
-	ast_aes_set_encrypt_key(key, &aes_key);
-	if (ast_aes_encrypt(plain, encr, &aes_key) <= 0) {
+static int aes_128_encrypt_block(struct milenage_ctx *ctx, const u8 *plain, u8 *encr)
+{
+	int outlen;
+
+	if (EVP_EncryptUpdate(ctx->evp, encr, &outlen, plain, 16) <= 0 || outlen != 16) {
 		printf("Failed to ecrypt AES 128.");
 		return -1;
 	}
@@ -90,6 +121,48 @@ static int aes_128_encrypt_block(const u8 *key, const u8 *plain, u8 *encr)
 	return 0;
 }
 
+/**
+ * milenage_ctx_alloc - Allocate a keyed Milenage context
+ * @opc: OPc = 128-bit value derived from OP and K
+ * @k: K = 128-bit subscriber key
+ * Returns: the context, to be released by milenage_ctx_free(), or %NULL
+ */
+struct milenage_ctx *milenage_ctx_alloc(const u8 *opc, const u8 *k)
+{
+	struct milenage_ctx *ctx = (struct milenage_ctx *) malloc(sizeof(*ctx));
+
+	if (!ctx)
+		return NULL;
+	if (milenage_ctx_init(ctx, opc, k)) {
+		free(ctx);
+		return NULL;
+	}
+	return ctx;
+}
+
+/**
+ * milenage_ctx_free - Release a context from milenage_ctx_alloc()
+ * @ctx: the context, or %NULL
+ */
+void milenage_ctx_free(struct milenage_ctx *ctx)
+{
+	if (!ctx)
+		return;
+	milenage_ctx_cleanup(ctx);
+	free(ctx);
+}
+
+/* TEMP = E_K(RAND XOR OP_C), common to f1 and f2..f5* */
+static int milenage_temp(struct milenage_ctx *ctx, const u8 *_rand, u8 *temp)
+{
+	u8 tmp[16];
+	int i;
+
+	for (i = 0; i < 16; i++)
+		tmp[i] = _rand[i] ^ ctx->opc[i];
+	return aes_128_encrypt_block(ctx, tmp, temp);
+}
+
 //#define DEBUG
 #ifdef DEBUG
 void hexdump(const char *text, const uint8_t *data, int len)
@@ -105,29 +178,13 @@ void hexdump(const char *text, const uint8_t *data, int len)
 #endif
 
 
-/**
- * milenage_f1 - Milenage f1 and f1* algorithms
- * @opc: OPc = 128-bit value derived from OP and K
- * @k: K = 128-bit subscriber key
- * @_rand: RAND = 128-bit random challenge
- * @sqn: SQN = 48-bit sequence number
- * @amf: AMF = 16-bit authentication management field
- * @mac_a: Buffer for MAC-A = 64-bit network authentication code, or %NULL
- * @mac_s: Buffer for MAC-S = 64-bit resync authentication code, or %NULL
- * Returns: 0 on success, -1 on failure
- */
-int milenage_f1(const u8 *opc, const u8 *k, const u8 *_rand,
-		const u8 *sqn, const u8 *amf, u8 *mac_a, u8 *mac_s)
+static int milenage_f1_temp(struct milenage_ctx *ctx, const u8 *temp,
+			    const u8 *sqn, const u8 *amf, u8 *mac_a, u8 *mac_s)
 {
+	const u8 *opc = ctx->opc;
 	u8 tmp1[16], tmp2[16], tmp3[16];
 	int i;
 
-	/* tmp1 = TEMP = E_K(RAND XOR OP_C) */
-	for (i = 0; i < 16; i++)
-		tmp1[i] = _rand[i] ^ opc[i];
-	if (aes_128_encrypt_block(k, tmp1, tmp1))
-		return -1;
-
 	/* tmp2 = IN1 = SQN || AMF || SQN || AMF */
 	memcpy(tmp2, sqn, 6);
 	memcpy(tmp2 + 6, amf, 2);
@@ -140,11 +197,11 @@ int milenage_f1(const u8 *opc, const u8 *k, const u8 *_rand,
 		tmp3[(i + 8) % 16] = tmp2[i] ^ opc[i];
 	/* XOR with TEMP = E_K(RAND XOR OP_C) */
 	for (i = 0; i < 16; i++)
-		tmp3[i] ^= tmp1[i];
+		tmp3[i] ^= temp[i];
 	/* XOR with c1 (= ..00, i.e., NOP) */
 
 	/* f1 || f1* = E_K(tmp3) XOR OP_c */
-	if (aes_128_encrypt_block(k, tmp3, tmp1))
+	if (aes_128_encrypt_block(ctx, tmp3, tmp1))
 		return -1;
 	for (i = 0; i < 16; i++)
 		tmp1[i] ^= opc[i];
@@ -155,30 +212,58 @@ int milenage_f1(const u8 *opc, const u8 *k, const u8 *_rand,
 	return 0;
 }
 
+/**
+ * milenage_ctx_f1 - Milenage f1 and f1* algorithms using a keyed context
+ * @ctx: context from milenage_ctx_alloc() for OPc and K
+ * @_rand: RAND = 128-bit random challenge
+ * @sqn: SQN = 48-bit sequence number
+ * @amf: AMF = 16-bit authentication management field
+ * @mac_a: Buffer for MAC-A = 64-bit network authentication code, or %NULL
+ * @mac_s: Buffer for MAC-S = 64-bit resync authentication code, or %NULL
+ * Returns: 0 on success, -1 on failure
+ */
+int milenage_ctx_f1(struct milenage_ctx *ctx, const u8 *_rand,
+		    const u8 *sqn, const u8 *amf, u8 *mac_a, u8 *mac_s)
+{
+	u8 temp[16];
+
+	/* TEMP = E_K(RAND XOR OP_C) */
+	if (milenage_temp(ctx, _rand, temp))
+		return -1;
+	return milenage_f1_temp(ctx, temp, sqn, amf, mac_a, mac_s);
+}
 
 /**
- * milenage_f2345 - Milenage f2, f3, f4, f5, f5* algorithms
+ * milenage_f1 - Milenage f1 and f1* algorithms
  * @opc: OPc = 128-bit value derived from OP and K
  * @k: K = 128-bit subscriber key
  * @_rand: RAND = 128-bit random challenge
- * @res: Buffer for RES = 64-bit signed response (f2), or %NULL
- * @ck: Buffer for CK = 128-bit confidentiality key (f3), or %NULL
- * @ik: Buffer for IK = 128-bit integrity key (f4), or %NULL
- * @ak: Buffer for AK = 48-bit anonymity key (f5), or %NULL
- * @akstar: Buffer for AK = 48-bit anonymity key (f5*), or %NULL
+ * @sqn: SQN = 48-bit sequence number
+ * @amf: AMF = 16-bit authentication management field
+ * @mac_a: Buffer for MAC-A = 64-bit network authentication code, or %NULL
+ * @mac_s: Buffer for MAC-S = 64-bit resync authentication code, or %NULL
  * Returns: 0 on success, -1 on failure
  */
-int milenage_f2345(const u8 *opc, const u8 *k, const u8 *_rand,
-		   u8 *res, u8 *ck, u8 *ik, u8 *ak, u8 *akstar)
+int milenage_f1(const u8 *opc, const u8 *k, const u8 *_rand,
+		const u8 *sqn, const u8 *amf, u8 *mac_a, u8 *mac_s)
 {
-	u8 tmp1[16], tmp2[16], tmp3[16];
-	int i;
+	struct milenage_ctx ctx;
+	int rc;
 
-	/* tmp2 = TEMP = E_K(RAND XOR OP_C) */
-	for (i = 0; i < 16; i++)
-		tmp1[i] = _rand[i] ^ opc[i];
-	if (aes_128_encrypt_block(k, tmp1, tmp2))
+	if (milenage_ctx_init(&ctx, opc, k))
 		return -1;
+	rc = milenage_ctx_f1(&ctx, _rand, sqn, amf, mac_a, mac_s);
+	milenage_ctx_cleanup(&ctx);
+	return rc;
+}
+
+
+static int milenage_f2345_temp(struct milenage_ctx *ctx, const u8 *temp,
+			       u8 *res, u8 *ck, u8 *ik, u8 *ak, u8 *akstar)
+{
+	const u8 *opc = ctx->opc;
+	u8 tmp1[16], tmp3[16];
+	int i;
 
 	/* OUT2 = E_K(rot(TEMP XOR OP_C, r2) XOR c2) XOR OP_C */
 	/* OUT3 = E_K(rot(TEMP XOR OP_C, r3) XOR c3) XOR OP_C */
@@ -188,10 +273,10 @@ int milenage_f2345(const u8 *opc, const u8 *k, const u8 *_rand,
 	/* f2 and f5 */
 	/* rotate by r2 (= 0, i.e., NOP) */
 	for (i = 0; i < 16; i++)
-		tmp1[i] = tmp2[i] ^ opc[i];
+		tmp1[i] = temp[i] ^ opc[i];
 	tmp1[15] ^= 1; /* XOR c2 (= ..01) */
 	/* f5 || f2 = E_K(tmp1) XOR OP_c */
-	if (aes_128_encrypt_block(k, tmp1, tmp3))
+	if (aes_128_encrypt_block(ctx, tmp1, tmp3))
 		return -1;
 	for (i = 0; i < 16; i++)
 		tmp3[i] ^= opc[i];
@@ -204,9 +289,9 @@ int milenage_f2345(const u8 *opc, const u8 *k, const u8 *_rand,
 	if (ck) {
 		/* rotate by r3 = 0x20 = 4 bytes */
 		for (i = 0; i < 16; i++)
-			tmp1[(i + 12) % 16] = tmp2[i] ^ opc[i];
+			tmp1[(i + 12) % 16] = temp[i] ^ opc[i];
 		tmp1[15] ^= 2; /* XOR c3 (= ..02) */
-		if (aes_128_encrypt_block(k, tmp1, ck))
+		if (aes_128_encrypt_block(ctx, tmp1, ck))
 			return -1;
 		for (i = 0; i < 16; i++)
 			ck[i] ^= opc[i];
@@ -216,9 +301,9 @@ int milenage_f2345(const u8 *opc, const u8 *k, const u8 *_rand,
 	if (ik) {
 		/* rotate by r4 = 0x40 = 8 bytes */
 		for (i = 0; i < 16; i++)
-			tmp1[(i + 8) % 16] = tmp2[i] ^ opc[i];
+			tmp1[(i + 8) % 16] = temp[i] ^ opc[i];
 		tmp1[15] ^= 4; /* XOR c4 (= ..04) */
-		if (aes_128_encrypt_block(k, tmp1, ik))
+		if (aes_128_encrypt_block(ctx, tmp1, ik))
 			return -1;
 		for (i = 0; i < 16; i++)
 			ik[i] ^= opc[i];
@@ -228,9 +313,9 @@ int milenage_f2345(const u8 *opc, const u8 *k, const u8 *_rand,
 	if (akstar) {
 		/* rotate by r5 = 0x60 = 12 bytes */
 		for (i = 0; i < 16; i++)
-			tmp1[(i + 4) % 16] = tmp2[i] ^ opc[i];
+			tmp1[(i + 4) % 16] = temp[i] ^ opc[i];
 		tmp1[15] ^= 8; /* XOR c5 (= ..08) */
-		if (aes_128_encrypt_block(k, tmp1, tmp1))
+		if (aes_128_encrypt_block(ctx, tmp1, tmp1))
 			return -1;
 		for (i = 0; i < 6; i++)
 			akstar[i] = tmp1[i] ^ opc[i];
@@ -239,12 +324,58 @@ int milenage_f2345(const u8 *opc, const u8 *k, const u8 *_rand,
 	return 0;
 }
 
+/**
+ * milenage_ctx_f2345 - Milenage f2, f3, f4, f5, f5* algorithms using a keyed context
+ * @ctx: context from milenage_ctx_alloc() for OPc and K
+ * @_rand: RAND = 128-bit random challenge
+ * @res: Buffer for RES = 64-bit signed response (f2), or %NULL
+ * @ck: Buffer for CK = 128-bit confidentiality key (f3), or %NULL
+ * @ik: Buffer for IK = 128-bit integrity key (f4), or %NULL
+ * @ak: Buffer for AK = 48-bit anonymity key (f5), or %NULL
+ * @akstar: Buffer for AK = 48-bit anonymity key (f5*), or %NULL
+ * Returns: 0 on success, -1 on failure
+ */
+int milenage_ctx_f2345(struct milenage_ctx *ctx, const u8 *_rand,
+		       u8 *res, u8 *ck, u8 *ik, u8 *ak, u8 *akstar)
+{
+	u8 temp[16];
+
+	/* TEMP = E_K(RAND XOR OP_C) */
+	if (milenage_temp(ctx, _rand, temp))
+		return -1;
+	return milenage_f2345_temp(ctx, temp, res, ck, ik, ak, akstar);
+}
 
 /**
- * milenage_generate - Generate AKA AUTN,IK,CK,RES
- * @opc: OPc = 128-bit operator variant algorithm configuration field (encr.)
- * @amf: AMF = 16-bit authentication management field
+ * milenage_f2345 - Milenage f2, f3, f4, f5, f5* algorithms
+ * @opc: OPc = 128-bit value derived from OP and K
  * @k: K = 128-bit subscriber key
+ * @_rand: RAND = 128-bit random challenge
+ * @res: Buffer for RES = 64-bit signed response (f2), or %NULL
+ * @ck: Buffer for CK = 128-bit confidentiality key (f3), or %NULL
+ * @ik: Buffer for IK = 128-bit integrity key (f4), or %NULL
+ * @ak: Buffer for AK = 48-bit anonymity key (f5), or %NULL
+ * @akstar: Buffer for AK = 48-bit anonymity key (f5*), or %NULL
+ * Returns: 0 on success, -1 on failure
+ */
+int milenage_f2345(const u8 *opc, const u8 *k, const u8 *_rand,
+		   u8 *res, u8 *ck, u8 *ik, u8 *ak, u8 *akstar)
+{
+	struct milenage_ctx ctx;
+	int rc;
+
+	if (milenage_ctx_init(&ctx, opc, k))
+		return -1;
+	rc = milenage_ctx_f2345(&ctx, _rand, res, ck, ik, ak, akstar);
+	milenage_ctx_cleanup(&ctx);
+	return rc;
+}
+
+
+/**
+ * milenage_ctx_generate - Generate AKA AUTN,IK,CK,RES using a keyed context
+ * @ctx: context from milenage_ctx_alloc() for OPc and K
+ * @amf: AMF = 16-bit authentication management field
  * @sqn: SQN = 48-bit sequence number
  * @_rand: RAND = 128-bit random challenge
  * @autn: Buffer for AUTN = 128-bit authentication token
@@ -252,22 +383,25 @@ int milenage_f2345(const u8 *opc, const u8 *k, const u8 *_rand,
  * @ck: Buffer for CK = 128-bit confidentiality key (f3), or %NULL
  * @res: Buffer for RES = 64-bit signed response (f2), or %NULL
  * @res_len: Max length for res; set to used length or 0 on failure
+ * Returns: 0 on success, -1 on failure
  */
-void milenage_generate(const u8 *opc, const u8 *amf, const u8 *k,
-		       const u8 *sqn, const u8 *_rand, u8 *autn, u8 *ik,
-		       u8 *ck, u8 *res, size_t *res_len)
+int milenage_ctx_generate(struct milenage_ctx *ctx, const u8 *amf,
+			  const u8 *sqn, const u8 *_rand, u8 *autn, u8 *ik,
+			  u8 *ck, u8 *res, size_t *res_len)
 {
 	int i;
-	u8 mac_a[8], ak[6];
+	u8 temp[16], mac_a[8], ak[6];
 
 	if (*res_len < 8) {
 		*res_len = 0;
-		return;
+		return -1;
 	}
-	if (milenage_f1(opc, k, _rand, sqn, amf, mac_a, NULL) ||
-	    milenage_f2345(opc, k, _rand, res, ck, ik, ak, NULL)) {
+	/* TEMP = E_K(RAND XOR OP_C) is shared by f1 and f2..f5 */
+	if (milenage_temp(ctx, _rand, temp) ||
+	    milenage_f1_temp(ctx, temp, sqn, amf, mac_a, NULL) ||
+	    milenage_f2345_temp(ctx, temp, res, ck, ik, ak, NULL)) {
 		*res_len = 0;
-		return;
+		return -1;
 	}
 	*res_len = 8;
 
@@ -276,6 +410,34 @@ void milenage_generate(const u8 *opc, const u8 *amf, const u8 *k,
 		autn[i] = sqn[i] ^ ak[i];
 	memcpy(autn + 6, amf, 2);
 	memcpy(autn + 8, mac_a, 8);
+	return 0;
+}
+
+/**
+ * milenage_generate - Generate AKA AUTN,IK,CK,RES
+ * @opc: OPc = 128-bit operator variant algorithm configuration field (encr.)
+ * @amf: AMF = 16-bit authentication management field
+ * @k: K = 128-bit subscriber key
+ * @sqn: SQN = 48-bit sequence number
+ * @_rand: RAND = 128-bit random challenge
+ * @autn: Buffer for AUTN = 128-bit authentication token
+ * @ik: Buffer for IK = 128-bit integrity key (f4), or %NULL
+ * @ck: Buffer for CK = 128-bit confidentiality key (f3), or %NULL
+ * @res: Buffer for RES = 64-bit signed response (f2), or %NULL
+ * @res_len: Max length for res; set to used length or 0 on failure
+ */
+void milenage_generate(const u8 *opc, const u8 *amf, const u8 *k,
+		       const u8 *sqn, const u8 *_rand, u8 *autn, u8 *ik,
+		       u8 *ck, u8 *res, size_t *res_len)
+{
+	struct milenage_ctx ctx;
+
+	if (milenage_ctx_init(&ctx, opc, k)) {
+		*res_len = 0;
+		return;
+	}
+	milenage_ctx_generate(&ctx, amf, sqn, _rand, autn, ik, ck, res, res_len);
+	milenage_ctx_cleanup(&ctx);
 }
 
 
@@ -337,9 +499,8 @@ int gsm_milenage(const u8 *opc, const u8 *k, const u8 *_rand, u8 *sres, u8 *kc)
 
 
 /**
- * milenage_generate - Generate AKA AUTN,IK,CK,RES
- * @opc: OPc = 128-bit operator variant algorithm configuration field (encr.)
- * @k: K = 128-bit subscriber key
+ * milenage_ctx_check - Check AKA AUTN and generate IK,CK,RES using a keyed context
+ * @ctx: context from milenage_ctx_alloc() for OPc and K
  * @sqn: SQN = 48-bit sequence number
  * @_rand: RAND = 128-bit random challenge
  * @autn: AUTN = 128-bit authentication token
@@ -350,22 +511,24 @@ int gsm_milenage(const u8 *opc, const u8 *k, const u8 *_rand, u8 *sres, u8 *kc)
  * @auts: 112-bit buffer for AUTS
  * Returns: 0 on success, -1 on failure, or -2 on synchronization failure
  */
-int milenage_check(const u8 *opc, const u8 *k, const u8 *sqn, const u8 *_rand,
-		   const u8 *autn, u8 *ik, u8 *ck, u8 *res, size_t *res_len,
-		   u8 *auts)
+int milenage_ctx_check(struct milenage_ctx *ctx, const u8 *sqn, const u8 *_rand,
+		       const u8 *autn, u8 *ik, u8 *ck, u8 *res, size_t *res_len,
+		       u8 *auts)
 {
 	int i;
-	u8 mac_a[8], ak[6], rx_sqn[6];
+	u8 temp[16], mac_a[8], ak[6], rx_sqn[6];
 	const u8 *amf;
 
 #ifdef DEBUG
-	hexdump("Milenage: OPC", opc, 16);
-	hexdump("Milenage: K", k, 16);
+	hexdump("Milenage: OPC", ctx->opc, 16);
 	hexdump("Milenage: AUTN", autn, 16);
 	hexdump("Milenage: RAND", _rand, 16);
 #endif
 
-	if (milenage_f2345(opc, k, _rand, res, ck, ik, ak, NULL))
+	/* TEMP = E_K(RAND XOR OP_C) is shared by f1 and f2..f5* */
+	if (milenage_temp(ctx, _rand, temp))
+		return -1;
+	if (milenage_f2345_temp(ctx, temp, res, ck, ik, ak, NULL))
 		return -1;
 
 	*res_len = 8;
@@ -386,14 +549,14 @@ int milenage_check(const u8 *opc, const u8 *k, const u8 *sqn, const u8 *_rand,
 
 	if (memcmp(rx_sqn, sqn, 6) <= 0) {
 		u8 auts_amf[2] = { 0x00, 0x00 }; /* TS 33.102 v7.0.0, 6.3.3 */
-		if (milenage_f2345(opc, k, _rand, NULL, NULL, NULL, NULL, ak))
+		if (milenage_f2345_temp(ctx, temp, NULL, NULL, NULL, NULL, ak))
 			return -1;
 #ifdef DEBUG
 		hexdump("Milenage: AK*", ak, 6);
 #endif
 		for (i = 0; i < 6; i++)
 			auts[i] = sqn[i] ^ ak[i];
-		if (milenage_f1(opc, k, _rand, sqn, auts_amf, NULL, auts + 6))
+		if (milenage_f1_temp(ctx, temp, sqn, auts_amf, NULL, auts + 6))
 			return -1;
 #ifdef DEBUG
 		hexdump("Milenage: AUTS", auts, 14);
@@ -405,7 +568,7 @@ int milenage_check(const u8 *opc, const u8 *k, const u8 *sqn, const u8 *_rand,
 #ifdef DEBUG
 	hexdump("Milenage: AMF", amf, 2);
 #endif
-	if (milenage_f1(opc, k, _rand, rx_sqn, amf, mac_a, NULL))
+	if (milenage_f1_temp(ctx, temp, rx_sqn, amf, mac_a, NULL))
 		return -1;
 
 #ifdef DEBUG
@@ -422,3 +585,31 @@ int milenage_check(const u8 *opc, const u8 *k, const u8 *sqn, const u8 *_rand,
 
 	return 0;
 }
+
+/**
+ * milenage_check - Check AKA AUTN and generate IK,CK,RES
+ * @opc: OPc = 128-bit operator variant algorithm configuration field (encr.)
+ * @k: K = 128-bit subscriber key
+ * @sqn: SQN = 48-bit sequence number
+ * @_rand: RAND = 128-bit random challenge
+ * @autn: AUTN = 128-bit authentication token
+ * @ik: Buffer for IK = 128-bit integrity key (f4), or %NULL
+ * @ck: Buffer for CK = 128-bit confidentiality key (f3), or %NULL
+ * @res: Buffer for RES = 64-bit signed response (f2), or %NULL
+ * @res_len: Variable that will be set to RES length
+ * @auts: 112-bit buffer for AUTS
+ * Returns: 0 on success, -1 on failure, or -2 on synchronization failure
+ */
+int milenage_check(const u8 *opc, const u8 *k, const u8 *sqn, const u8 *_rand,
+		   const u8 *autn, u8 *ik, u8 *ck, u8 *res, size_t *res_len,
+		   u8 *auts)
+{
+	struct milenage_ctx ctx;
+	int rc;
+
+	if (milenage_ctx_init(&ctx, opc, k))
+		return -1;
+	rc = milenage_ctx_check(&ctx, sqn, _rand, autn, ik, ck, res, res_len, auts);
+	milenage_ctx_cleanup(&ctx);
+	return rc;
+}
@@ -20,3 +20,20 @@ int gsm_milenage(const u8 *opc, const u8 *k, const u8 *_rand, u8 *sres, u8 *kc);
 int milenage_check(const u8 *opc, const u8 *k, const u8 *sqn, const u8 *_rand,
 		   const u8 *autn, u8 *ik, u8 *ck, u8 *res, size_t *res_len,
 		   u8 *auts);
+
+/* Keyed Milenage context: OPc and K are set once, and the AES key schedule
+ * and cipher context are re-used for any number of invocations. */
+struct milenage_ctx;
+
+struct milenage_ctx *milenage_ctx_alloc(const u8 *opc, const u8 *k);
+void milenage_ctx_free(struct milenage_ctx *ctx);
+int milenage_ctx_f1(struct milenage_ctx *ctx, const u8 *_rand,
+		    const u8 *sqn, const u8 *amf, u8 *mac_a, u8 *mac_s);
+int milenage_ctx_f2345(struct milenage_ctx *ctx, const u8 *_rand,
+		       u8 *res, u8 *ck, u8 *ik, u8 *ak, u8 *akstar);
+int milenage_ctx_generate(struct milenage_ctx *ctx, const u8 *amf,
+			  const u8 *sqn, const u8 *_rand, u8 *autn, u8 *ik,
+			  u8 *ck, u8 *res, size_t *res_len);
+int milenage_ctx_check(struct milenage_ctx *ctx, const u8 *sqn, const u8 *_rand,
+		       const u8 *autn, u8 *ik, u8 *ck, u8 *res, size_t *res_len,
+		       u8 *auts);
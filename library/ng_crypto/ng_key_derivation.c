@@ -3,7 +3,7 @@
 #include <arpa/inet.h>
 #include <gnutls/crypto.h>
 
-#include "key_derivation.h"
+#include "ng_key_derivation.h"
 
 /* 3GPP TS 33.501 A.2 KAUSF derivation function */
 void kdf_kausf(const uint8_t *ck, const uint8_t *ik,
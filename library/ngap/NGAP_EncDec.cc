@@ -1,232 +1,87 @@
-
-#include <string.h>
-#include <stdarg.h>
 #include "NGAP_IEs.hh"
 #include "NGAP_PDU_Descriptions.hh"
+#include "NGAP_Types.hh"
+#include "ASN1_Codec.hh"
 
 namespace NGAP__Types {
 
 TTCN_Module NGAP__EncDec("NGAP_EncDec", __DATE__, __TIME__);
 
-OCTETSTRING enc__NGAP__PDU(const NGAP__PDU__Descriptions::NGAP__PDU &pdu)
-{
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	pdu.encode(NGAP__PDU__Descriptions::NGAP__PDU_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(TTCN_buf.get_len(), TTCN_buf.get_data());
-}
-
-NGAP__PDU__Descriptions::NGAP__PDU dec__NGAP__PDU(const OCTETSTRING &stream)
-{
-	NGAP__PDU__Descriptions::NGAP__PDU pdu;
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	pdu.decode(NGAP__PDU__Descriptions::NGAP__PDU_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return pdu;
-}
-
-OCTETSTRING enc__NGAP__PDUSessionResourceSetupRequestTransfer(const NGAP__IEs::PDUSessionResourceSetupRequestTransfer &p)
-{
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	p.encode(NGAP__IEs::PDUSessionResourceSetupRequestTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(TTCN_buf.get_len(), TTCN_buf.get_data());
-}
-
-NGAP__IEs::PDUSessionResourceSetupRequestTransfer dec__NGAP__PDUSessionResourceSetupRequestTransfer(const OCTETSTRING &stream)
-{
-	NGAP__IEs::PDUSessionResourceSetupRequestTransfer ret;
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	ret.decode(NGAP__IEs::PDUSessionResourceSetupRequestTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return ret;
-
-}
-
-OCTETSTRING enc__NGAP__PDUSessionResourceSetupResponseTransfer(const NGAP__IEs::PDUSessionResourceSetupResponseTransfer &p)
-{
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	p.encode(NGAP__IEs::PDUSessionResourceSetupResponseTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(TTCN_buf.get_len(), TTCN_buf.get_data());
-}
-
-NGAP__IEs::PDUSessionResourceSetupResponseTransfer dec__NGAP__PDUSessionResourceSetupResponseTransfer(const OCTETSTRING &stream)
-{
-	NGAP__IEs::PDUSessionResourceSetupResponseTransfer ret;
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	ret.decode(NGAP__IEs::PDUSessionResourceSetupResponseTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return ret;
-}
-
-OCTETSTRING enc__NGAP__PDUSessionResourceModifyRequestTransfer(const NGAP__IEs::PDUSessionResourceModifyRequestTransfer &p)
-{
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	p.encode(NGAP__IEs::PDUSessionResourceModifyRequestTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(TTCN_buf.get_len(), TTCN_buf.get_data());
-}
-
-NGAP__IEs::PDUSessionResourceModifyRequestTransfer dec__NGAP__PDUSessionResourceModifyRequestTransfer(const OCTETSTRING &stream)
-{
-	NGAP__IEs::PDUSessionResourceModifyRequestTransfer ret;
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	ret.decode(NGAP__IEs::PDUSessionResourceModifyRequestTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return ret;
-}
-
-OCTETSTRING enc__NGAP__PDUSessionResourceModifyResponseTransfer(const NGAP__IEs::PDUSessionResourceModifyResponseTransfer &p)
-{
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	p.encode(NGAP__IEs::PDUSessionResourceModifyResponseTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(TTCN_buf.get_len(), TTCN_buf.get_data());
-}
-
-NGAP__IEs::PDUSessionResourceModifyResponseTransfer dec__NGAP__PDUSessionResourceModifyResponseTransfer(const OCTETSTRING &stream)
-{
-	NGAP__IEs::PDUSessionResourceModifyResponseTransfer ret;
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	ret.decode(NGAP__IEs::PDUSessionResourceModifyResponseTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return ret;
-}
-
-OCTETSTRING enc__NGAP__PDUSessionResourceModifyIndicationTransfer(const NGAP__IEs::PDUSessionResourceModifyIndicationTransfer &p)
-{
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	p.encode(NGAP__IEs::PDUSessionResourceModifyIndicationTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(TTCN_buf.get_len(), TTCN_buf.get_data());
-}
-
-NGAP__IEs::PDUSessionResourceModifyIndicationTransfer dec__NGAP__PDUSessionResourceModifyIndicationTransfer(const OCTETSTRING &stream)
-{
-	NGAP__IEs::PDUSessionResourceModifyIndicationTransfer ret;
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	ret.decode(NGAP__IEs::PDUSessionResourceModifyIndicationTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return ret;
-}
-
-OCTETSTRING enc__NGAP__UEContextSuspendRequestTransfer(const NGAP__IEs::UEContextSuspendRequestTransfer &p)
-{
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	p.encode(NGAP__IEs::UEContextSuspendRequestTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(TTCN_buf.get_len(), TTCN_buf.get_data());
-}
-
-NGAP__IEs::UEContextSuspendRequestTransfer dec__NGAP__UEContextSuspendRequestTransfer(const OCTETSTRING &stream)
-{
-	NGAP__IEs::UEContextSuspendRequestTransfer ret;
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	ret.decode(NGAP__IEs::UEContextSuspendRequestTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return ret;
-}
-
-OCTETSTRING enc__NGAP__PathSwitchRequestTransfer(const NGAP__IEs::PathSwitchRequestTransfer &p)
-{
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	p.encode(NGAP__IEs::PathSwitchRequestTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(TTCN_buf.get_len(), TTCN_buf.get_data());
-}
-
-NGAP__IEs::PathSwitchRequestTransfer dec__NGAP__PathSwitchRequestTransfer(const OCTETSTRING &stream)
-{
-	NGAP__IEs::PathSwitchRequestTransfer ret;
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	ret.decode(NGAP__IEs::PathSwitchRequestTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return ret;
-}
-
-OCTETSTRING enc__NGAP__HandoverRequiredTransfer(const NGAP__IEs::HandoverRequiredTransfer &p)
-{
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	p.encode(NGAP__IEs::HandoverRequiredTransfer_descr_, TTCN_buf,
-		 TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(TTCN_buf.get_len(), TTCN_buf.get_data());
-}
-
-NGAP__IEs::HandoverRequiredTransfer dec__NGAP__HandoverRequiredTransfer(const OCTETSTRING &stream)
-{
-	NGAP__IEs::HandoverRequiredTransfer ret;
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	ret.decode(NGAP__IEs::HandoverRequiredTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return ret;
-}
-
-OCTETSTRING enc__NGAP__HandoverRequestAcknowledgeTransfer(const NGAP__IEs::HandoverRequestAcknowledgeTransfer &p)
-{
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	p.encode(NGAP__IEs::HandoverRequestAcknowledgeTransfer_descr_, TTCN_buf,
-		 TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(TTCN_buf.get_len(), TTCN_buf.get_data());
-}
-
-NGAP__IEs::HandoverRequestAcknowledgeTransfer dec__NGAP__HandoverRequestAcknowledgeTransfer(const OCTETSTRING &stream)
-{
-	NGAP__IEs::HandoverRequestAcknowledgeTransfer ret;
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	ret.decode(NGAP__IEs::HandoverRequestAcknowledgeTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return ret;
-}
-
-OCTETSTRING enc__NGAP__SecondaryRATDataUsageReportTransfer(const NGAP__IEs::SecondaryRATDataUsageReportTransfer &p)
-{
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	p.encode(NGAP__IEs::SecondaryRATDataUsageReportTransfer_descr_, TTCN_buf,
-		 TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(TTCN_buf.get_len(), TTCN_buf.get_data());
-}
-
-NGAP__IEs::SecondaryRATDataUsageReportTransfer dec__NGAP__SecondaryRATDataUsageReportTransfer(const OCTETSTRING &stream)
-{
-	NGAP__IEs::SecondaryRATDataUsageReportTransfer ret;
-	TTCN_Buffer TTCN_buf;
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	ret.decode(NGAP__IEs::SecondaryRATDataUsageReportTransfer_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return ret;
+ASN1_CODEC_APER(NGAP__PDU, NGAP__PDU__Descriptions::NGAP__PDU)
+
+ASN1_CODEC_APER(NGAP__PDUSessionResourceSetupRequestTransfer, NGAP__IEs::PDUSessionResourceSetupRequestTransfer)
+ASN1_CODEC_APER(NGAP__PDUSessionResourceSetupResponseTransfer, NGAP__IEs::PDUSessionResourceSetupResponseTransfer)
+ASN1_CODEC_APER(NGAP__PDUSessionResourceModifyRequestTransfer, NGAP__IEs::PDUSessionResourceModifyRequestTransfer)
+ASN1_CODEC_APER(NGAP__PDUSessionResourceModifyResponseTransfer, NGAP__IEs::PDUSessionResourceModifyResponseTransfer)
+ASN1_CODEC_APER(NGAP__PDUSessionResourceModifyIndicationTransfer, NGAP__IEs::PDUSessionResourceModifyIndicationTransfer)
+ASN1_CODEC_APER(NGAP__UEContextSuspendRequestTransfer, NGAP__IEs::UEContextSuspendRequestTransfer)
+ASN1_CODEC_APER(NGAP__PathSwitchRequestTransfer, NGAP__IEs::PathSwitchRequestTransfer)
+ASN1_CODEC_APER(NGAP__HandoverRequiredTransfer, NGAP__IEs::HandoverRequiredTransfer)
+ASN1_CODEC_APER(NGAP__HandoverRequestAcknowledgeTransfer, NGAP__IEs::HandoverRequestAcknowledgeTransfer)
+ASN1_CODEC_APER(NGAP__SecondaryRATDataUsageReportTransfer, NGAP__IEs::SecondaryRATDataUsageReportTransfer)
+
+/* NGAP_Constants.asn */
+#define NGAP_PROC_PRIVATE_MESSAGE	31
+#define NGAP_IE_AMF_UE_NGAP_ID		10
+#define NGAP_IE_RAN_UE_NGAP_ID		85
+#define NGAP_IE_UE_NGAP_IDS		114
+
+#define NGAP_AMF_UE_NGAP_ID_MAX		1099511627775ULL
+#define NGAP_RAN_UE_NGAP_ID_MAX		4294967295ULL
+
+/* Obtain what's needed to dispatch a NGAP PDU (type, procedure and UE NGAP
+ * IDs) by walking its outer APER encoding, skipping the value of all IEs
+ * other than the UE IDs. */
+NGAP__PDU__Peek dec__NGAP__PDU__peek(const OCTETSTRING &stream)
+{
+	using namespace ASN1__Codec;
+	struct aper_reader r, ie;
+	struct aper_ap_hdr hdr;
+	NGAP__PDU__Peek ret_val;
+	unsigned int i, num_ies;
+
+	aper_init(&r, (const unsigned char *) stream, stream.lengthof());
+	aper_get_ap_hdr(&r, &hdr);
+
+	ret_val.pdu__type() = (NGAP__PDU__Peek__Type::enum_type) hdr.pdu_type;
+	ret_val.procedureCode() = hdr.procedure_code;
+	ret_val.criticality() = hdr.criticality;
+	ret_val.amf__ue__ngap__id() = OMIT_VALUE;
+	ret_val.ran__ue__ngap__id() = OMIT_VALUE;
+
+	/* the PrivateMessage has a PrivateIE-Container instead */
+	if (hdr.procedure_code == NGAP_PROC_PRIVATE_MESSAGE)
+		return ret_val;
+
+	num_ies = aper_get_num_ies(&hdr.msg);
+	for (i = 0; i < num_ies; i++) {
+		switch (aper_get_ie(&hdr.msg, &ie)) {
+		case NGAP_IE_AMF_UE_NGAP_ID:
+			ret_val.amf__ue__ngap__id() = aper_int(aper_get_constrained(&ie, NGAP_AMF_UE_NGAP_ID_MAX));
+			break;
+		case NGAP_IE_RAN_UE_NGAP_ID:
+			ret_val.ran__ue__ngap__id() = aper_int(aper_get_constrained(&ie, NGAP_RAN_UE_NGAP_ID_MAX));
+			break;
+		case NGAP_IE_UE_NGAP_IDS:
+			/* CHOICE { uE-NGAP-ID-pair, aMF-UE-NGAP-ID, choice-Extensions } */
+			switch (aper_get_bits(&ie, 2)) {
+			case 0:
+				/* extension bit, iE-Extensions presence bit */
+				aper_get_bits(&ie, 2);
+				ret_val.amf__ue__ngap__id() = aper_int(aper_get_constrained(&ie, NGAP_AMF_UE_NGAP_ID_MAX));
+				ret_val.ran__ue__ngap__id() = aper_int(aper_get_constrained(&ie, NGAP_RAN_UE_NGAP_ID_MAX));
+				break;
+			case 1:
+				ret_val.amf__ue__ngap__id() = aper_int(aper_get_constrained(&ie, NGAP_AMF_UE_NGAP_ID_MAX));
+				break;
+			}
+			break;
+		}
+		if (ret_val.amf__ue__ngap__id().is_present() && ret_val.ran__ue__ngap__id().is_present())
+			break;
+	}
+
+	return ret_val;
 }
 
 }
@@ -1,4 +1,6 @@
 #include "S1AP_PDU_Descriptions.hh"
+#include "S1AP_Types.hh"
+#include "ASN1_Codec.hh"
 
 /* 3GPP TS 36.413, section 9.4 Message transfer syntax:
  * S1AP shall use the ASN.1 Basic Packed Encoding Rules (BASIC-PER) Aligned Variant
@@ -8,48 +10,70 @@ namespace S1AP__Types {
 
 TTCN_Module S1AP__EncDec("S1AP_EncDec", __DATE__, __TIME__);
 
-OCTETSTRING enc__S1AP__PDU(const S1AP__PDU__Descriptions::S1AP__PDU &pdu)
-{
-	TTCN_Buffer buf;
+ASN1_CODEC_APER(S1AP__PDU, S1AP__PDU__Descriptions::S1AP__PDU)
+ASN1_CODEC_APER(S1AP__Global__ENB__ID, S1AP__IEs::Global__ENB__ID)
 
-	buf.clear();
-	pdu.encode(S1AP__PDU__Descriptions::S1AP__PDU_descr_, buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(buf.get_len(), buf.get_data());
-}
+/* S1AP_Constants.asn */
+#define S1AP_PROC_PRIVATE_MESSAGE	39
+#define S1AP_IE_MME_UE_S1AP_ID		0
+#define S1AP_IE_ENB_UE_S1AP_ID		8
+#define S1AP_IE_UE_S1AP_IDS		99
 
-S1AP__PDU__Descriptions::S1AP__PDU dec__S1AP__PDU(const OCTETSTRING &stream)
-{
-	S1AP__PDU__Descriptions::S1AP__PDU pdu;
-	TTCN_Buffer TTCN_buf;
-
-	TTCN_buf.clear();
-	TTCN_buf.put_os(stream);
-	pdu.decode(S1AP__PDU__Descriptions::S1AP__PDU_descr_, TTCN_buf,
-		   TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return pdu;
-}
+#define S1AP_MME_UE_S1AP_ID_MAX		4294967295ULL
+#define S1AP_ENB_UE_S1AP_ID_MAX		16777215ULL
 
-OCTETSTRING enc__S1AP__Global__ENB__ID(const S1AP__IEs::Global__ENB__ID &ie)
+/* Obtain what's needed to dispatch a S1AP PDU (type, procedure and UE S1AP
+ * IDs) by walking its outer APER encoding, skipping the value of all IEs
+ * other than the UE IDs. */
+S1AP__PDU__Peek dec__S1AP__PDU__peek(const OCTETSTRING &stream)
 {
-	TTCN_Buffer buf;
+	using namespace ASN1__Codec;
+	struct aper_reader r, ie;
+	struct aper_ap_hdr hdr;
+	S1AP__PDU__Peek ret_val;
+	unsigned int i, num_ies;
 
-	buf.clear();
-	ie.encode(S1AP__IEs::Global__ENB__ID_descr_, buf,
-		  TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return OCTETSTRING(buf.get_len(), buf.get_data());
-}
+	aper_init(&r, (const unsigned char *) stream, stream.lengthof());
+	aper_get_ap_hdr(&r, &hdr);
 
-S1AP__IEs::Global__ENB__ID dec__S1AP__Global__ENB__ID(const OCTETSTRING &stream)
-{
-	S1AP__IEs::Global__ENB__ID ie;
-	TTCN_Buffer buf;
-
-	buf.clear();
-	buf.put_os(stream);
-	ie.decode(S1AP__IEs::Global__ENB__ID_descr_, buf,
-		  TTCN_EncDec::CT_PER, PER_ALIGNED);
-	return ie;
+	ret_val.pdu__type() = (S1AP__PDU__Peek__Type::enum_type) hdr.pdu_type;
+	ret_val.procedureCode() = hdr.procedure_code;
+	ret_val.criticality() = hdr.criticality;
+	ret_val.mme__ue__s1ap__id() = OMIT_VALUE;
+	ret_val.enb__ue__s1ap__id() = OMIT_VALUE;
+
+	/* the PrivateMessage has a PrivateIE-Container instead */
+	if (hdr.procedure_code == S1AP_PROC_PRIVATE_MESSAGE)
+		return ret_val;
+
+	num_ies = aper_get_num_ies(&hdr.msg);
+	for (i = 0; i < num_ies; i++) {
+		switch (aper_get_ie(&hdr.msg, &ie)) {
+		case S1AP_IE_MME_UE_S1AP_ID:
+			ret_val.mme__ue__s1ap__id() = aper_int(aper_get_constrained(&ie, S1AP_MME_UE_S1AP_ID_MAX));
+			break;
+		case S1AP_IE_ENB_UE_S1AP_ID:
+			ret_val.enb__ue__s1ap__id() = aper_int(aper_get_constrained(&ie, S1AP_ENB_UE_S1AP_ID_MAX));
+			break;
+		case S1AP_IE_UE_S1AP_IDS:
+			/* CHOICE { uE-S1AP-ID-pair, mME-UE-S1AP-ID, ... } */
+			if (aper_get_bits(&ie, 1))
+				break;
+			if (aper_get_bits(&ie, 1) == 0) {
+				/* extension bit, iE-Extensions presence bit */
+				aper_get_bits(&ie, 2);
+				ret_val.mme__ue__s1ap__id() = aper_int(aper_get_constrained(&ie, S1AP_MME_UE_S1AP_ID_MAX));
+				ret_val.enb__ue__s1ap__id() = aper_int(aper_get_constrained(&ie, S1AP_ENB_UE_S1AP_ID_MAX));
+			} else {
+				ret_val.mme__ue__s1ap__id() = aper_int(aper_get_constrained(&ie, S1AP_MME_UE_S1AP_ID_MAX));
+			}
+			break;
+		}
+		if (ret_val.mme__ue__s1ap__id().is_present() && ret_val.enb__ue__s1ap__id().is_present())
+			break;
+	}
+
+	return ret_val;
 }
 
 }
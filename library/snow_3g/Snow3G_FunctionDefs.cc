@@ -14,6 +14,8 @@
 #include <errno.h>
 #include <stdint.h>
 
+#include <vector>
+
 #include <Boolean.hh>
 #include <Integer.hh>
 #include <Octetstring.hh>
@@ -77,11 +79,10 @@ namespace Snow3G__Functions {
 * Input count:32-bit Count, Frame dependent input as INTEGER.
 * Input bearer: 5-bit Bearer identity (in the LSB side) as BIT5.
 * Input is_dlwnlink: Direction of transmission.
-* Input data: length number of bits, input bit stream as OCTETSTRING.
-* Output data: Output bit stream. Assumes data is suitably memory
-* allocated.
-* Encrypts/decrypts blocks of data between 1 and 2^32 bits in length as
-* defined in Section 3.
+* Input data: input bit stream as OCTETSTRING, all lengthof(data) * 8 bits
+* are encrypted/decrypted.
+* Output data: Output bit stream.
+* Encrypts/decrypts blocks of data as defined in Section 3.
 */
 OCTETSTRING f__snow__3g__f8(const OCTETSTRING& key, const INTEGER& count, const INTEGER & bearer,
 			    const BOOLEAN& is_downlink, const OCTETSTRING& data)
@@ -91,7 +92,7 @@ OCTETSTRING f__snow__3g__f8(const OCTETSTRING& key, const INTEGER& count, const
 	uint32_t direction = (uint32_t)is_downlink;
 
 	snow_3g_f8((u8 *)ttcn_buf_key.get_data(), (u32) count, (u32)bearer, direction,
-		   (u8 *)ttcn_buf_data.get_data(), ttcn_buf_data.get_len());
+		   (u8 *)ttcn_buf_data.get_data(), ttcn_buf_data.get_len() * 8);
 
 	return OCTETSTRING(ttcn_buf_data.get_len(), ttcn_buf_data.get_data());
 }
@@ -130,4 +131,71 @@ OCTETSTRING f__snow__3g__f9(const OCTETSTRING& key, const INTEGER& count, const
 	return OCTETSTRING(4, tmp);
 }
 
+/* Keys loaded by f__snow__3g__key__load(), indexed by key_id.  Released
+ * slots are NULL and get re-used by subsequent loads. */
+static std::vector<struct snow3g_key *> snow3g_keys;
+
+static const struct snow3g_key *snow3g_key_get(const INTEGER& key_id)
+{
+	int id = (int)key_id;
+
+	if (id < 0 || (size_t)id >= snow3g_keys.size() || !snow3g_keys[id])
+		TTCN_error("SNOW 3G key_id %d not loaded", id);
+	return snow3g_keys[id];
+}
+
+INTEGER f__snow__3g__key__load(const OCTETSTRING& key)
+{
+	struct snow3g_key *k = new struct snow3g_key;
+	size_t id;
+
+	snow_3g_key_load(k, (const u8 *)key);
+
+	for (id = 0; id < snow3g_keys.size(); id++) {
+		if (!snow3g_keys[id])
+			break;
+	}
+	if (id == snow3g_keys.size())
+		snow3g_keys.push_back(k);
+	else
+		snow3g_keys[id] = k;
+
+	return INTEGER((int)id);
+}
+
+void f__snow__3g__key__free(const INTEGER& key_id)
+{
+	int id = (int)key_id;
+
+	snow3g_key_get(key_id);
+	delete snow3g_keys[id];
+	snow3g_keys[id] = NULL;
+}
+
+OCTETSTRING f__snow__3g__f8__key(const INTEGER& key_id, const INTEGER& count, const INTEGER& bearer,
+				 const BOOLEAN& is_downlink, const OCTETSTRING& data)
+{
+	const struct snow3g_key *k = snow3g_key_get(key_id);
+	TTCN_Buffer ttcn_buf_data(data);
+	uint32_t direction = (uint32_t)is_downlink;
+
+	snow_3g_f8_key(k, (u32)count, (u32)bearer, direction,
+		       (u8 *)ttcn_buf_data.get_data(), ttcn_buf_data.get_len() * 8);
+
+	return OCTETSTRING(ttcn_buf_data.get_len(), ttcn_buf_data.get_data());
+}
+
+OCTETSTRING f__snow__3g__f9__key(const INTEGER& key_id, const INTEGER& count, const INTEGER& fresh,
+				 const BOOLEAN& is_downlink, const OCTETSTRING& data)
+{
+	const struct snow3g_key *k = snow3g_key_get(key_id);
+	uint32_t direction = (uint32_t)is_downlink;
+	uint8_t tmp[4];
+
+	snow_3g_f9_key(k, (u32)count, (u32)fresh, direction,
+		       (const u8 *)data, (u64)data.lengthof() * 8, tmp);
+
+	return OCTETSTRING(4, tmp);
+}
+
 } // namespace
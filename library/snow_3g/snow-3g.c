@@ -4,131 +4,181 @@
 
 #include "snow-3g.h"
 
-/* LFSR */
-
-static u32 LFSR_S0 = 0x00;
-static u32 LFSR_S1 = 0x00;
-static u32 LFSR_S2 = 0x00;
-static u32 LFSR_S3 = 0x00;
-static u32 LFSR_S4 = 0x00;
-static u32 LFSR_S5 = 0x00;
-static u32 LFSR_S6 = 0x00;
-static u32 LFSR_S7 = 0x00;
-static u32 LFSR_S8 = 0x00;
-static u32 LFSR_S9 = 0x00;
-static u32 LFSR_S10 = 0x00;
-static u32 LFSR_S11 = 0x00;
-static u32 LFSR_S12 = 0x00;
-static u32 LFSR_S13 = 0x00;
-static u32 LFSR_S14 = 0x00;
-static u32 LFSR_S15 = 0x00;
-
-/* FSM */
-
-static u32 FSM_R1 = 0x00;
-static u32 FSM_R2 = 0x00;
-static u32 FSM_R3 = 0x00;
-
-/* Rijndael S-box SR */
-
-static const u8 SR[256] = {
-0x63,0x7C,0x77,0x7B,0xF2,0x6B,0x6F,0xC5,0x30,0x01,0x67,0x2B,0xFE,0xD7,0xAB,0x76,
-0xCA,0x82,0xC9,0x7D,0xFA,0x59,0x47,0xF0,0xAD,0xD4,0xA2,0xAF,0x9C,0xA4,0x72,0xC0,
-0xB7,0xFD,0x93,0x26,0x36,0x3F,0xF7,0xCC,0x34,0xA5,0xE5,0xF1,0x71,0xD8,0x31,0x15,
-0x04,0xC7,0x23,0xC3,0x18,0x96,0x05,0x9A,0x07,0x12,0x80,0xE2,0xEB,0x27,0xB2,0x75,
-0x09,0x83,0x2C,0x1A,0x1B,0x6E,0x5A,0xA0,0x52,0x3B,0xD6,0xB3,0x29,0xE3,0x2F,0x84,
-0x53,0xD1,0x00,0xED,0x20,0xFC,0xB1,0x5B,0x6A,0xCB,0xBE,0x39,0x4A,0x4C,0x58,0xCF,
-0xD0,0xEF,0xAA,0xFB,0x43,0x4D,0x33,0x85,0x45,0xF9,0x02,0x7F,0x50,0x3C,0x9F,0xA8,
-0x51,0xA3,0x40,0x8F,0x92,0x9D,0x38,0xF5,0xBC,0xB6,0xDA,0x21,0x10,0xFF,0xF3,0xD2,
-0xCD,0x0C,0x13,0xEC,0x5F,0x97,0x44,0x17,0xC4,0xA7,0x7E,0x3D,0x64,0x5D,0x19,0x73,
-0x60,0x81,0x4F,0xDC,0x22,0x2A,0x90,0x88,0x46,0xEE,0xB8,0x14,0xDE,0x5E,0x0B,0xDB,
-0xE0,0x32,0x3A,0x0A,0x49,0x06,0x24,0x5C,0xC2,0xD3,0xAC,0x62,0x91,0x95,0xE4,0x79,
-0xE7,0xC8,0x37,0x6D,0x8D,0xD5,0x4E,0xA9,0x6C,0x56,0xF4,0xEA,0x65,0x7A,0xAE,0x08,
-0xBA,0x78,0x25,0x2E,0x1C,0xA6,0xB4,0xC6,0xE8,0xDD,0x74,0x1F,0x4B,0xBD,0x8B,0x8A,
-0x70,0x3E,0xB5,0x66,0x48,0x03,0xF6,0x0E,0x61,0x35,0x57,0xB9,0x86,0xC1,0x1D,0x9E,
-0xE1,0xF8,0x98,0x11,0x69,0xD9,0x8E,0x94,0x9B,0x1E,0x87,0xE9,0xCE,0x55,0x28,0xDF,
-0x8C,0xA1,0x89,0x0D,0xBF,0xE6,0x42,0x68,0x41,0x99,0x2D,0x0F,0xB0,0x54,0xBB,0x16
-};
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <wmmintrin.h>
+#endif
 
-/* S-box SQ */
-
-static const u8 SQ[256] = {
-0x25,0x24,0x73,0x67,0xD7,0xAE,0x5C,0x30,0xA4,0xEE,0x6E,0xCB,0x7D,0xB5,0x82,0xDB,
-0xE4,0x8E,0x48,0x49,0x4F,0x5D,0x6A,0x78,0x70,0x88,0xE8,0x5F,0x5E,0x84,0x65,0xE2,
-0xD8,0xE9,0xCC,0xED,0x40,0x2F,0x11,0x28,0x57,0xD2,0xAC,0xE3,0x4A,0x15,0x1B,0xB9,
-0xB2,0x80,0x85,0xA6,0x2E,0x02,0x47,0x29,0x07,0x4B,0x0E,0xC1,0x51,0xAA,0x89,0xD4,
-0xCA,0x01,0x46,0xB3,0xEF,0xDD,0x44,0x7B,0xC2,0x7F,0xBE,0xC3,0x9F,0x20,0x4C,0x64,
-0x83,0xA2,0x68,0x42,0x13,0xB4,0x41,0xCD,0xBA,0xC6,0xBB,0x6D,0x4D,0x71,0x21,0xF4,
-0x8D,0xB0,0xE5,0x93,0xFE,0x8F,0xE6,0xCF,0x43,0x45,0x31,0x22,0x37,0x36,0x96,0xFA,
-0xBC,0x0F,0x08,0x52,0x1D,0x55,0x1A,0xC5,0x4E,0x23,0x69,0x7A,0x92,0xFF,0x5B,0x5A,
-0xEB,0x9A,0x1C,0xA9,0xD1,0x7E,0x0D,0xFC,0x50,0x8A,0xB6,0x62,0xF5,0x0A,0xF8,0xDC,
-0x03,0x3C,0x0C,0x39,0xF1,0xB8,0xF3,0x3D,0xF2,0xD5,0x97,0x66,0x81,0x32,0xA0,0x00,
-0x06,0xCE,0xF6,0xEA,0xB7,0x17,0xF7,0x8C,0x79,0xD6,0xA7,0xBF,0x8B,0x3F,0x1F,0x53,
-0x63,0x75,0x35,0x2C,0x60,0xFD,0x27,0xD3,0x94,0xA5,0x7C,0xA1,0x05,0x58,0x2D,0xBD,
-0xD9,0xC7,0xAF,0x6B,0x54,0x0B,0xE0,0x38,0x04,0xC8,0x9D,0xE7,0x14,0xB1,0x87,0x9C,
-0xDF,0x6F,0xF9,0xDA,0x2A,0xC4,0x59,0x16,0x74,0x91,0xAB,0x26,0x61,0x76,0x34,0x2B,
-0xAD,0x99,0xFB,0x72,0xEC,0x33,0x12,0xDE,0x98,0x3B,0xC0,0x9B,0x3E,0x18,0x10,0x3A,
-0x56,0xE1,0x77,0xC9,0x1E,0x9E,0x95,0xA3,0x90,0x19,0xA8,0x6C,0x09,0xD0,0xF0,0x86
-};
+/* State of the generator used by the legacy, non-reentrant
+ * snow_3g_initialize() / snow_3g_generate_key_stream() API. */
+
+static struct snow3g_ctx legacy_ctx;
 
-/* MULx.
-* Input V: an 8-bit input.
-* Input c: an 8-bit input.
-* Output : an 8-bit output.
-* See section 3.1.1 for details.
+/* The 32x32-bit S-Box S1 as lookup table.
+* S1_T[x] is the contribution of the most significant input byte x to the
+* output of S1, i.e. the mixing of SR[x] (SR being the Rijndael S-box).
+* The contributions of the other input bytes are the same words rotated
+* right by 8, 16 and 24 bits.  See section 3.3.1.
 */
 
-static u8 MULx(u8 V, u8 c)
-{
-	if ( V & 0x80 )
-		return ( (V << 1) ^ c);
-	else
-		return ( V << 1);
-}
+static const u32 S1_T[256] = {
+0xC6A56363,0xF8847C7C,0xEE997777,0xF68D7B7B,0xFF0DF2F2,0xD6BD6B6B,0xDEB16F6F,0x9154C5C5,
+0x60503030,0x02030101,0xCEA96767,0x567D2B2B,0xE719FEFE,0xB562D7D7,0x4DE6ABAB,0xEC9A7676,
+0x8F45CACA,0x1F9D8282,0x8940C9C9,0xFA877D7D,0xEF15FAFA,0xB2EB5959,0x8EC94747,0xFB0BF0F0,
+0x41ECADAD,0xB367D4D4,0x5FFDA2A2,0x45EAAFAF,0x23BF9C9C,0x53F7A4A4,0xE4967272,0x9B5BC0C0,
+0x75C2B7B7,0xE11CFDFD,0x3DAE9393,0x4C6A2626,0x6C5A3636,0x7E413F3F,0xF502F7F7,0x834FCCCC,
+0x685C3434,0x51F4A5A5,0xD134E5E5,0xF908F1F1,0xE2937171,0xAB73D8D8,0x62533131,0x2A3F1515,
+0x080C0404,0x9552C7C7,0x46652323,0x9D5EC3C3,0x30281818,0x37A19696,0x0A0F0505,0x2FB59A9A,
+0x0E090707,0x24361212,0x1B9B8080,0xDF3DE2E2,0xCD26EBEB,0x4E692727,0x7FCDB2B2,0xEA9F7575,
+0x121B0909,0x1D9E8383,0x58742C2C,0x342E1A1A,0x362D1B1B,0xDCB26E6E,0xB4EE5A5A,0x5BFBA0A0,
+0xA4F65252,0x764D3B3B,0xB761D6D6,0x7DCEB3B3,0x527B2929,0xDD3EE3E3,0x5E712F2F,0x13978484,
+0xA6F55353,0xB968D1D1,0x00000000,0xC12CEDED,0x40602020,0xE31FFCFC,0x79C8B1B1,0xB6ED5B5B,
+0xD4BE6A6A,0x8D46CBCB,0x67D9BEBE,0x724B3939,0x94DE4A4A,0x98D44C4C,0xB0E85858,0x854ACFCF,
+0xBB6BD0D0,0xC52AEFEF,0x4FE5AAAA,0xED16FBFB,0x86C54343,0x9AD74D4D,0x66553333,0x11948585,
+0x8ACF4545,0xE910F9F9,0x04060202,0xFE817F7F,0xA0F05050,0x78443C3C,0x25BA9F9F,0x4BE3A8A8,
+0xA2F35151,0x5DFEA3A3,0x80C04040,0x058A8F8F,0x3FAD9292,0x21BC9D9D,0x70483838,0xF104F5F5,
+0x63DFBCBC,0x77C1B6B6,0xAF75DADA,0x42632121,0x20301010,0xE51AFFFF,0xFD0EF3F3,0xBF6DD2D2,
+0x814CCDCD,0x18140C0C,0x26351313,0xC32FECEC,0xBEE15F5F,0x35A29797,0x88CC4444,0x2E391717,
+0x9357C4C4,0x55F2A7A7,0xFC827E7E,0x7A473D3D,0xC8AC6464,0xBAE75D5D,0x322B1919,0xE6957373,
+0xC0A06060,0x19988181,0x9ED14F4F,0xA37FDCDC,0x44662222,0x547E2A2A,0x3BAB9090,0x0B838888,
+0x8CCA4646,0xC729EEEE,0x6BD3B8B8,0x283C1414,0xA779DEDE,0xBCE25E5E,0x161D0B0B,0xAD76DBDB,
+0xDB3BE0E0,0x64563232,0x744E3A3A,0x141E0A0A,0x92DB4949,0x0C0A0606,0x486C2424,0xB8E45C5C,
+0x9F5DC2C2,0xBD6ED3D3,0x43EFACAC,0xC4A66262,0x39A89191,0x31A49595,0xD337E4E4,0xF28B7979,
+0xD532E7E7,0x8B43C8C8,0x6E593737,0xDAB76D6D,0x018C8D8D,0xB164D5D5,0x9CD24E4E,0x49E0A9A9,
+0xD8B46C6C,0xACFA5656,0xF307F4F4,0xCF25EAEA,0xCAAF6565,0xF48E7A7A,0x47E9AEAE,0x10180808,
+0x6FD5BABA,0xF0887878,0x4A6F2525,0x5C722E2E,0x38241C1C,0x57F1A6A6,0x73C7B4B4,0x9751C6C6,
+0xCB23E8E8,0xA17CDDDD,0xE89C7474,0x3E211F1F,0x96DD4B4B,0x61DCBDBD,0x0D868B8B,0x0F858A8A,
+0xE0907070,0x7C423E3E,0x71C4B5B5,0xCCAA6666,0x90D84848,0x06050303,0xF701F6F6,0x1C120E0E,
+0xC2A36161,0x6A5F3535,0xAEF95757,0x69D0B9B9,0x17918686,0x9958C1C1,0x3A271D1D,0x27B99E9E,
+0xD938E1E1,0xEB13F8F8,0x2BB39898,0x22331111,0xD2BB6969,0xA970D9D9,0x07898E8E,0x33A79494,
+0x2DB69B9B,0x3C221E1E,0x15928787,0xC920E9E9,0x8749CECE,0xAAFF5555,0x50782828,0xA57ADFDF,
+0x038F8C8C,0x59F8A1A1,0x09808989,0x1A170D0D,0x65DABFBF,0xD731E6E6,0x84C64242,0xD0B86868,
+0x82C34141,0x29B09999,0x5A772D2D,0x1E110F0F,0x7BCBB0B0,0xA8FC5454,0x6DD6BBBB,0x2C3A1616
+};
 
-/* MULxPOW.
-* Input V: an 8-bit input.
-* Input i: a positive integer.
-* Input c: an 8-bit input.
-* Output : an 8-bit output.
-* See section 3.1.2 for details.
+/* The 32x32-bit S-Box S2 as lookup table.
+* S2_T[x] is the contribution of the most significant input byte x to the
+* output of S2, i.e. the mixing of SQ[x], analogous to S1_T.
+* See section 3.3.2.
 */
 
-static u8 MULxPOW(u8 V, u8 i, u8 c)
-{
-	if ( i == 0)
-		return V;
-	else
-		return MULx( MULxPOW( V, i-1, c ), c);
-}
+static const u32 S2_T[256] = {
+0x4A6F2525,0x486C2424,0xE6957373,0xCEA96767,0xC710D7D7,0x359BAEAE,0xB8E45C5C,0x60503030,
+0x2185A4A4,0xB55BEEEE,0xDCB26E6E,0xFF34CBCB,0xFA877D7D,0x03B6B5B5,0x6DEF8282,0xDF04DBDB,
+0xA145E4E4,0x75FB8E8E,0x90D84848,0x92DB4949,0x9ED14F4F,0xBAE75D5D,0xD4BE6A6A,0xF0887878,
+0xE0907070,0x79F18888,0xB951E8E8,0xBEE15F5F,0xBCE25E5E,0x61E58484,0xCAAF6565,0xAD4FE2E2,
+0xD901D8D8,0xBB52E9E9,0xF13DCCCC,0xB35EEDED,0x80C04040,0x5E712F2F,0x22331111,0x50782828,
+0xAEF95757,0xCD1FD2D2,0x319DACAC,0xAF4CE3E3,0x94DE4A4A,0x2A3F1515,0x362D1B1B,0x1BA2B9B9,
+0x0DBFB2B2,0x69E98080,0x63E68585,0x2583A6A6,0x5C722E2E,0x04060202,0x8EC94747,0x527B2929,
+0x0E090707,0x96DD4B4B,0x1C120E0E,0xEB2AC1C1,0xA2F35151,0x3D97AAAA,0x7BF28989,0xC115D4D4,
+0xFD37CACA,0x02030101,0x8CCA4646,0x0FBCB3B3,0xB758EFEF,0xD30EDDDD,0x88CC4444,0xF68D7B7B,
+0xED2FC2C2,0xFE817F7F,0x15ABBEBE,0xEF2CC3C3,0x57C89F9F,0x40602020,0x98D44C4C,0xC8AC6464,
+0x6FEC8383,0x2D8FA2A2,0xD0B86868,0x84C64242,0x26351313,0x01B5B4B4,0x82C34141,0xF33ECDCD,
+0x1DA7BABA,0xE523C6C6,0x1FA4BBBB,0xDAB76D6D,0x9AD74D4D,0xE2937171,0x42632121,0x8175F4F4,
+0x73FE8D8D,0x09B9B0B0,0xA346E5E5,0x4FDC9393,0x956BFEFE,0x77F88F8F,0xA543E6E6,0xF738CFCF,
+0x86C54343,0x8ACF4545,0x62533131,0x44662222,0x6E593737,0x6C5A3636,0x45D39696,0x9D67FAFA,
+0x11ADBCBC,0x1E110F0F,0x10180808,0xA4F65252,0x3A271D1D,0xAAFF5555,0x342E1A1A,0xE326C5C5,
+0x9CD24E4E,0x46652323,0xD2BB6969,0xF48E7A7A,0x4DDF9292,0x9768FFFF,0xB6ED5B5B,0xB4EE5A5A,
+0xBF54EBEB,0x5DC79A9A,0x38241C1C,0x3B92A9A9,0xCB1AD1D1,0xFC827E7E,0x1A170D0D,0x916DFCFC,
+0xA0F05050,0x7DF78A8A,0x05B3B6B6,0xC4A66262,0x8376F5F5,0x141E0A0A,0x9961F8F8,0xD10DDCDC,
+0x06050303,0x78443C3C,0x18140C0C,0x724B3939,0x8B7AF1F1,0x19A1B8B8,0x8F7CF3F3,0x7A473D3D,
+0x8D7FF2F2,0xC316D5D5,0x47D09797,0xCCAA6666,0x6BEA8181,0x64563232,0x2989A0A0,0x00000000,
+0x0C0A0606,0xF53BCECE,0x8573F6F6,0xBD57EAEA,0x07B0B7B7,0x2E391717,0x8770F7F7,0x71FD8C8C,
+0xF28B7979,0xC513D6D6,0x2780A7A7,0x17A8BFBF,0x7FF48B8B,0x7E413F3F,0x3E211F1F,0xA6F55353,
+0xC6A56363,0xEA9F7575,0x6A5F3535,0x58742C2C,0xC0A06060,0x936EFDFD,0x4E692727,0xCF1CD3D3,
+0x41D59494,0x2386A5A5,0xF8847C7C,0x2B8AA1A1,0x0A0F0505,0xB0E85858,0x5A772D2D,0x13AEBDBD,
+0xDB02D9D9,0xE720C7C7,0x3798AFAF,0xD6BD6B6B,0xA8FC5454,0x161D0B0B,0xA949E0E0,0x70483838,
+0x080C0404,0xF931C8C8,0x53CE9D9D,0xA740E7E7,0x283C1414,0x0BBAB1B1,0x67E08787,0x51CD9C9C,
+0xD708DFDF,0xDEB16F6F,0x9B62F9F9,0xDD07DADA,0x547E2A2A,0xE125C4C4,0xB2EB5959,0x2C3A1616,
+0xE89C7474,0x4BDA9191,0x3F94ABAB,0x4C6A2626,0xC2A36161,0xEC9A7676,0x685C3434,0x567D2B2B,
+0x339EADAD,0x5BC29999,0x9F64FBFB,0xE4967272,0xB15DECEC,0x66553333,0x24361212,0xD50BDEDE,
+0x59C19898,0x764D3B3B,0xE929C0C0,0x5FC49B9B,0x7C423E3E,0x30281818,0x20301010,0x744E3A3A,
+0xACFA5656,0xAB4AE1E1,0xEE997777,0xFB32C9C9,0x3C221E1E,0x55CB9E9E,0x43D69595,0x2F8CA3A3,
+0x49D99090,0x322B1919,0x3991A8A8,0xD8B46C6C,0x121B0909,0xC919D0D0,0x8979F0F0,0x65E38686
+};
 
-/* The function MUL alpha.
-* Input c: 8-bit input.
-* Output : 32-bit output.
+/* The function MUL alpha as lookup table.
+* MULalpha_T[c] = MULxPOW(c, 23, 0xa9) || MULxPOW(c, 245, 0xa9) ||
+*                 MULxPOW(c, 48, 0xa9) || MULxPOW(c, 239, 0xa9)
 * See section 3.4.2 for details.
 */
 
-static u32 MULalpha(u8 c)
-{
-	return ( ( ((u32)MULxPOW(c, 23, 0xa9)) << 24 ) |
-		( ((u32)MULxPOW(c, 245, 0xa9)) << 16 ) |
-		( ((u32)MULxPOW(c, 48, 0xa9)) << 8 ) |
-		( ((u32)MULxPOW(c, 239, 0xa9)) ) ) ;
-}
+static const u32 MULalpha_T[256] = {
+0x00000000,0xE19FCF13,0x6B973726,0x8A08F835,0xD6876E4C,0x3718A15F,0xBD10596A,0x5C8F9679,
+0x05A7DC98,0xE438138B,0x6E30EBBE,0x8FAF24AD,0xD320B2D4,0x32BF7DC7,0xB8B785F2,0x59284AE1,
+0x0AE71199,0xEB78DE8A,0x617026BF,0x80EFE9AC,0xDC607FD5,0x3DFFB0C6,0xB7F748F3,0x566887E0,
+0x0F40CD01,0xEEDF0212,0x64D7FA27,0x85483534,0xD9C7A34D,0x38586C5E,0xB250946B,0x53CF5B78,
+0x1467229B,0xF5F8ED88,0x7FF015BD,0x9E6FDAAE,0xC2E04CD7,0x237F83C4,0xA9777BF1,0x48E8B4E2,
+0x11C0FE03,0xF05F3110,0x7A57C925,0x9BC80636,0xC747904F,0x26D85F5C,0xACD0A769,0x4D4F687A,
+0x1E803302,0xFF1FFC11,0x75170424,0x9488CB37,0xC8075D4E,0x2998925D,0xA3906A68,0x420FA57B,
+0x1B27EF9A,0xFAB82089,0x70B0D8BC,0x912F17AF,0xCDA081D6,0x2C3F4EC5,0xA637B6F0,0x47A879E3,
+0x28CE449F,0xC9518B8C,0x435973B9,0xA2C6BCAA,0xFE492AD3,0x1FD6E5C0,0x95DE1DF5,0x7441D2E6,
+0x2D699807,0xCCF65714,0x46FEAF21,0xA7616032,0xFBEEF64B,0x1A713958,0x9079C16D,0x71E60E7E,
+0x22295506,0xC3B69A15,0x49BE6220,0xA821AD33,0xF4AE3B4A,0x1531F459,0x9F390C6C,0x7EA6C37F,
+0x278E899E,0xC611468D,0x4C19BEB8,0xAD8671AB,0xF109E7D2,0x109628C1,0x9A9ED0F4,0x7B011FE7,
+0x3CA96604,0xDD36A917,0x573E5122,0xB6A19E31,0xEA2E0848,0x0BB1C75B,0x81B93F6E,0x6026F07D,
+0x390EBA9C,0xD891758F,0x52998DBA,0xB30642A9,0xEF89D4D0,0x0E161BC3,0x841EE3F6,0x65812CE5,
+0x364E779D,0xD7D1B88E,0x5DD940BB,0xBC468FA8,0xE0C919D1,0x0156D6C2,0x8B5E2EF7,0x6AC1E1E4,
+0x33E9AB05,0xD2766416,0x587E9C23,0xB9E15330,0xE56EC549,0x04F10A5A,0x8EF9F26F,0x6F663D7C,
+0x50358897,0xB1AA4784,0x3BA2BFB1,0xDA3D70A2,0x86B2E6DB,0x672D29C8,0xED25D1FD,0x0CBA1EEE,
+0x5592540F,0xB40D9B1C,0x3E056329,0xDF9AAC3A,0x83153A43,0x628AF550,0xE8820D65,0x091DC276,
+0x5AD2990E,0xBB4D561D,0x3145AE28,0xD0DA613B,0x8C55F742,0x6DCA3851,0xE7C2C064,0x065D0F77,
+0x5F754596,0xBEEA8A85,0x34E272B0,0xD57DBDA3,0x89F22BDA,0x686DE4C9,0xE2651CFC,0x03FAD3EF,
+0x4452AA0C,0xA5CD651F,0x2FC59D2A,0xCE5A5239,0x92D5C440,0x734A0B53,0xF942F366,0x18DD3C75,
+0x41F57694,0xA06AB987,0x2A6241B2,0xCBFD8EA1,0x977218D8,0x76EDD7CB,0xFCE52FFE,0x1D7AE0ED,
+0x4EB5BB95,0xAF2A7486,0x25228CB3,0xC4BD43A0,0x9832D5D9,0x79AD1ACA,0xF3A5E2FF,0x123A2DEC,
+0x4B12670D,0xAA8DA81E,0x2085502B,0xC11A9F38,0x9D950941,0x7C0AC652,0xF6023E67,0x179DF174,
+0x78FBCC08,0x9964031B,0x136CFB2E,0xF2F3343D,0xAE7CA244,0x4FE36D57,0xC5EB9562,0x24745A71,
+0x7D5C1090,0x9CC3DF83,0x16CB27B6,0xF754E8A5,0xABDB7EDC,0x4A44B1CF,0xC04C49FA,0x21D386E9,
+0x721CDD91,0x93831282,0x198BEAB7,0xF81425A4,0xA49BB3DD,0x45047CCE,0xCF0C84FB,0x2E934BE8,
+0x77BB0109,0x9624CE1A,0x1C2C362F,0xFDB3F93C,0xA13C6F45,0x40A3A056,0xCAAB5863,0x2B349770,
+0x6C9CEE93,0x8D032180,0x070BD9B5,0xE69416A6,0xBA1B80DF,0x5B844FCC,0xD18CB7F9,0x301378EA,
+0x693B320B,0x88A4FD18,0x02AC052D,0xE333CA3E,0xBFBC5C47,0x5E239354,0xD42B6B61,0x35B4A472,
+0x667BFF0A,0x87E43019,0x0DECC82C,0xEC73073F,0xB0FC9146,0x51635E55,0xDB6BA660,0x3AF46973,
+0x63DC2392,0x8243EC81,0x084B14B4,0xE9D4DBA7,0xB55B4DDE,0x54C482CD,0xDECC7AF8,0x3F53B5EB
+};
 
-/* The function DIV alpha.
-* Input c: 8-bit input.
-* Output : 32-bit output.
+/* The function DIV alpha as lookup table.
+* DIValpha_T[c] = MULxPOW(c, 16, 0xa9) || MULxPOW(c, 39, 0xa9) ||
+*                 MULxPOW(c, 6, 0xa9) || MULxPOW(c, 64, 0xa9)
 * See section 3.4.3 for details.
 */
 
-static u32 DIValpha(u8 c)
-{
-	return ( ( ((u32)MULxPOW(c, 16, 0xa9)) << 24 ) |
-		( ((u32)MULxPOW(c, 39, 0xa9)) << 16 ) |
-		( ((u32)MULxPOW(c, 6, 0xa9)) << 8 ) |
-		( ((u32)MULxPOW(c, 64, 0xa9)) ) ) ;
-}
+static const u32 DIValpha_T[256] = {
+0x00000000,0x180F40CD,0x301E8033,0x2811C0FE,0x603CA966,0x7833E9AB,0x50222955,0x482D6998,
+0xC078FBCC,0xD877BB01,0xF0667BFF,0xE8693B32,0xA04452AA,0xB84B1267,0x905AD299,0x88559254,
+0x29F05F31,0x31FF1FFC,0x19EEDF02,0x01E19FCF,0x49CCF657,0x51C3B69A,0x79D27664,0x61DD36A9,
+0xE988A4FD,0xF187E430,0xD99624CE,0xC1996403,0x89B40D9B,0x91BB4D56,0xB9AA8DA8,0xA1A5CD65,
+0x5249BE62,0x4A46FEAF,0x62573E51,0x7A587E9C,0x32751704,0x2A7A57C9,0x026B9737,0x1A64D7FA,
+0x923145AE,0x8A3E0563,0xA22FC59D,0xBA208550,0xF20DECC8,0xEA02AC05,0xC2136CFB,0xDA1C2C36,
+0x7BB9E153,0x63B6A19E,0x4BA76160,0x53A821AD,0x1B854835,0x038A08F8,0x2B9BC806,0x339488CB,
+0xBBC11A9F,0xA3CE5A52,0x8BDF9AAC,0x93D0DA61,0xDBFDB3F9,0xC3F2F334,0xEBE333CA,0xF3EC7307,
+0xA492D5C4,0xBC9D9509,0x948C55F7,0x8C83153A,0xC4AE7CA2,0xDCA13C6F,0xF4B0FC91,0xECBFBC5C,
+0x64EA2E08,0x7CE56EC5,0x54F4AE3B,0x4CFBEEF6,0x04D6876E,0x1CD9C7A3,0x34C8075D,0x2CC74790,
+0x8D628AF5,0x956DCA38,0xBD7C0AC6,0xA5734A0B,0xED5E2393,0xF551635E,0xDD40A3A0,0xC54FE36D,
+0x4D1A7139,0x551531F4,0x7D04F10A,0x650BB1C7,0x2D26D85F,0x35299892,0x1D38586C,0x053718A1,
+0xF6DB6BA6,0xEED42B6B,0xC6C5EB95,0xDECAAB58,0x96E7C2C0,0x8EE8820D,0xA6F942F3,0xBEF6023E,
+0x36A3906A,0x2EACD0A7,0x06BD1059,0x1EB25094,0x569F390C,0x4E9079C1,0x6681B93F,0x7E8EF9F2,
+0xDF2B3497,0xC724745A,0xEF35B4A4,0xF73AF469,0xBF179DF1,0xA718DD3C,0x8F091DC2,0x97065D0F,
+0x1F53CF5B,0x075C8F96,0x2F4D4F68,0x37420FA5,0x7F6F663D,0x676026F0,0x4F71E60E,0x577EA6C3,
+0xE18D0321,0xF98243EC,0xD1938312,0xC99CC3DF,0x81B1AA47,0x99BEEA8A,0xB1AF2A74,0xA9A06AB9,
+0x21F5F8ED,0x39FAB820,0x11EB78DE,0x09E43813,0x41C9518B,0x59C61146,0x71D7D1B8,0x69D89175,
+0xC87D5C10,0xD0721CDD,0xF863DC23,0xE06C9CEE,0xA841F576,0xB04EB5BB,0x985F7545,0x80503588,
+0x0805A7DC,0x100AE711,0x381B27EF,0x20146722,0x68390EBA,0x70364E77,0x58278E89,0x4028CE44,
+0xB3C4BD43,0xABCBFD8E,0x83DA3D70,0x9BD57DBD,0xD3F81425,0xCBF754E8,0xE3E69416,0xFBE9D4DB,
+0x73BC468F,0x6BB30642,0x43A2C6BC,0x5BAD8671,0x1380EFE9,0x0B8FAF24,0x239E6FDA,0x3B912F17,
+0x9A34E272,0x823BA2BF,0xAA2A6241,0xB225228C,0xFA084B14,0xE2070BD9,0xCA16CB27,0xD2198BEA,
+0x5A4C19BE,0x42435973,0x6A52998D,0x725DD940,0x3A70B0D8,0x227FF015,0x0A6E30EB,0x12617026,
+0x451FD6E5,0x5D109628,0x750156D6,0x6D0E161B,0x25237F83,0x3D2C3F4E,0x153DFFB0,0x0D32BF7D,
+0x85672D29,0x9D686DE4,0xB579AD1A,0xAD76EDD7,0xE55B844F,0xFD54C482,0xD545047C,0xCD4A44B1,
+0x6CEF89D4,0x74E0C919,0x5CF109E7,0x44FE492A,0x0CD320B2,0x14DC607F,0x3CCDA081,0x24C2E04C,
+0xAC977218,0xB49832D5,0x9C89F22B,0x8486B2E6,0xCCABDB7E,0xD4A49BB3,0xFCB55B4D,0xE4BA1B80,
+0x17566887,0x0F59284A,0x2748E8B4,0x3F47A879,0x776AC1E1,0x6F65812C,0x477441D2,0x5F7B011F,
+0xD72E934B,0xCF21D386,0xE7301378,0xFF3F53B5,0xB7123A2D,0xAF1D7AE0,0x870CBA1E,0x9F03FAD3,
+0x3EA637B6,0x26A9777B,0x0EB8B785,0x16B7F748,0x5E9A9ED0,0x4695DE1D,0x6E841EE3,0x768B5E2E,
+0xFEDECC7A,0xE6D18CB7,0xCEC04C49,0xD6CF0C84,0x9EE2651C,0x86ED25D1,0xAEFCE52F,0xB6F3A5E2
+};
+
+#define ROR32(w, n) ( ( (w) >> (n) ) | ( (w) << (32 - (n)) ) )
 
 /* The 32x32-bit S-Box S1
 * Input: a 32-bit input.
@@ -136,36 +186,12 @@ static u32 DIValpha(u8 c)
 * See section 3.3.1.
 */
 
-static u32 S1(u32 w)
+static inline u32 S1(u32 w)
 {
-	u8 r0=0, r1=0, r2=0, r3=0;
-	u8 srw0 = SR[ (u8)((w >> 24) & 0xff) ];
-	u8 srw1 = SR[ (u8)((w >> 16) & 0xff) ];
-	u8 srw2 = SR[ (u8)((w >> 8) & 0xff) ];
-	u8 srw3 = SR[ (u8)((w) & 0xff) ];
-	r0 = ( ( MULx( srw0 , 0x1b) ) ^
-		( srw1 ) ^
-		( srw2 ) ^
-		( (MULx( srw3, 0x1b)) ^ srw3 )
-	);
-	r1 = ( ( ( MULx( srw0 , 0x1b) ) ^ srw0 ) ^
-		( MULx(srw1, 0x1b) ) ^
-		( srw2 ) ^
-		( srw3 )
-	);
-	r2 = ( ( srw0 ) ^
-		( ( MULx( srw1 , 0x1b) ) ^ srw1 ) ^
-		( MULx(srw2, 0x1b) ) ^
-		( srw3 )
-	);
-	r3 = ( ( srw0 ) ^
-		( srw1 ) ^
-		( ( MULx( srw2 , 0x1b) ) ^ srw2 ) ^
-		( MULx( srw3, 0x1b) )
-	);
-
-	return ( ( ((u32)r0) << 24 ) | ( ((u32)r1) << 16 ) | ( ((u32)r2) << 8 ) |
-		( ((u32)r3) ) );
+	return S1_T[ (w >> 24) & 0xff ] ^
+		ROR32( S1_T[ (w >> 16) & 0xff ], 8 ) ^
+		ROR32( S1_T[ (w >> 8) & 0xff ], 16 ) ^
+		ROR32( S1_T[ w & 0xff ], 24 );
 }
 
 /* The 32x32-bit S-Box S2
@@ -174,115 +200,117 @@ static u32 S1(u32 w)
 * See section 3.3.2.
 */
 
-static u32 S2(u32 w)
+static inline u32 S2(u32 w)
 {
-	u8 r0=0, r1=0, r2=0, r3=0;
-	u8 sqw0 = SQ[ (u8)((w >> 24) & 0xff) ];
-	u8 sqw1 = SQ[ (u8)((w >> 16) & 0xff) ];
-	u8 sqw2 = SQ[ (u8)((w >> 8) & 0xff) ];
-	u8 sqw3 = SQ[ (u8)((w) & 0xff) ];
-	r0 = ( ( MULx( sqw0 , 0x69) ) ^
-		( sqw1 ) ^
-		( sqw2 ) ^
-		( (MULx( sqw3, 0x69)) ^ sqw3 )
-	);
-	r1 = ( ( ( MULx( sqw0 , 0x69) ) ^ sqw0 ) ^
-		( MULx(sqw1, 0x69) ) ^
-		( sqw2 ) ^
-		( sqw3 )
-	);
-	r2 = ( ( sqw0 ) ^
-		( ( MULx( sqw1 , 0x69) ) ^ sqw1 ) ^
-		( MULx(sqw2, 0x69) ) ^
-		( sqw3 )
-	);
-	r3 = ( ( sqw0 ) ^
-		( sqw1 ) ^
-		( ( MULx( sqw2 , 0x69) ) ^ sqw2 ) ^
-		( MULx( sqw3, 0x69) )
-	);
-	return ( ( ((u32)r0) << 24 ) | ( ((u32)r1) << 16 ) | ( ((u32)r2) << 8 ) |
-		( ((u32)r3) ) );
+	return S2_T[ (w >> 24) & 0xff ] ^
+		ROR32( S2_T[ (w >> 16) & 0xff ], 8 ) ^
+		ROR32( S2_T[ (w >> 8) & 0xff ], 16 ) ^
+		ROR32( S2_T[ w & 0xff ], 24 );
 }
 
-/* Clocking LFSR in initialization mode.
-* LFSR Registers S0 to S15 are updated as the LFSR receives a single clock.
-* Input F: a 32-bit word comes from output of FSM.
-* See section 3.4.4.
+/* Clocking FSM and LFSR.
+* Input ctx: the cipher state.
+* Input j: the LFSR is used as circular buffer, S_i is located at
+* lfsr[(j + i) % 16].  After the clock, the new S15 replaces the old S0,
+* so the caller advances j by one instead of shifting all registers.
+* Input init: clock the LFSR in initialization mode (feeding back the
+* FSM output F) if set, in keystream mode otherwise.
+* Output : F XOR S0 (prior to clocking), i.e. the keystream word z.
+* Updates FSM registers R1, R2, R3 and one LFSR register.
+* See sections 3.4.4, 3.4.5, 3.4.6 and 4.2.
 */
 
-static void ClockLFSRInitializationMode(u32 F)
+static inline u32 ClockSNOW3G(struct snow3g_ctx *ctx, unsigned int j, int init)
 {
-	u32 v = ( ( (LFSR_S0 << 8) & 0xffffff00 ) ^
-		( MULalpha( (u8)((LFSR_S0>>24) & 0xff) ) ) ^
-		( LFSR_S2 ) ^
-		( (LFSR_S11 >> 8) & 0x00ffffff ) ^
-		( DIValpha( (u8)( ( LFSR_S11) & 0xff ) ) ) ^
-		( F )
-	);
-	LFSR_S0 = LFSR_S1;
-	LFSR_S1 = LFSR_S2;
-	LFSR_S2 = LFSR_S3;
-	LFSR_S3 = LFSR_S4;
-	LFSR_S4 = LFSR_S5;
-	LFSR_S5 = LFSR_S6;
-	LFSR_S6 = LFSR_S7;
-	LFSR_S7 = LFSR_S8;
-	LFSR_S8 = LFSR_S9;
-	LFSR_S9 = LFSR_S10;
-	LFSR_S10 = LFSR_S11;
-	LFSR_S11 = LFSR_S12;
-	LFSR_S12 = LFSR_S13;
-	LFSR_S13 = LFSR_S14;
-	LFSR_S14 = LFSR_S15;
-	LFSR_S15 = v;
+	u32 *S = ctx->lfsr;
+	u32 s0 = S[j & 15];
+	u32 s11 = S[(j + 11) & 15];
+	u32 F = ( S[(j + 15) & 15] + ctx->r1 ) ^ ctx->r2;
+	u32 r = ctx->r2 + ( ctx->r3 ^ S[(j + 5) & 15] );
+
+	ctx->r3 = S2(ctx->r2);
+	ctx->r2 = S1(ctx->r1);
+	ctx->r1 = r;
+
+	S[j & 15] = ( s0 << 8 ) ^ MULalpha_T[ s0 >> 24 ] ^ S[(j + 2) & 15] ^
+		( s11 >> 8 ) ^ DIValpha_T[ s11 & 0xff ] ^ ( init ? F : 0 );
+
+	return F ^ s0;
 }
 
-/* Clocking LFSR in keystream mode.
-* LFSR Registers S0 to S15 are updated as the LFSR receives a single clock.
-* See section 3.4.5.
+/* Re-align the circular LFSR buffer of ctx after j clocks, so that
+* lfsr[i] holds S_i again.
 */
 
-static void ClockLFSRKeyStreamMode()
+static void RealignLFSR(struct snow3g_ctx *ctx, unsigned int j)
 {
-	u32 v = ( ( (LFSR_S0 << 8) & 0xffffff00 ) ^
-		( MULalpha( (u8)((LFSR_S0>>24) & 0xff) ) ) ^
-		( LFSR_S2 ) ^
-		( (LFSR_S11 >> 8) & 0x00ffffff ) ^
-		( DIValpha( (u8)( ( LFSR_S11) & 0xff ) ) )
-	);
-	LFSR_S0 = LFSR_S1;
-	LFSR_S1 = LFSR_S2;
-	LFSR_S2 = LFSR_S3;
-	LFSR_S3 = LFSR_S4;
-	LFSR_S4 = LFSR_S5;
-	LFSR_S5 = LFSR_S6;
-	LFSR_S6 = LFSR_S7;
-	LFSR_S7 = LFSR_S8;
-	LFSR_S8 = LFSR_S9;
-	LFSR_S9 = LFSR_S10;
-	LFSR_S10 = LFSR_S11;
-	LFSR_S11 = LFSR_S12;
-	LFSR_S12 = LFSR_S13;
-	LFSR_S13 = LFSR_S14;
-	LFSR_S14 = LFSR_S15;
-	LFSR_S15 = v;
+	u32 tmp[16];
+	int i;
+
+	if ((j & 15) == 0)
+		return;
+	for (i = 0; i < 16; i++)
+		tmp[i] = ctx->lfsr[(j + i) & 15];
+	for (i = 0; i < 16; i++)
+		ctx->lfsr[i] = tmp[i];
 }
 
-/* Clocking FSM.
-* Produces a 32-bit word F.
-* Updates FSM registers R1, R2, R3.
-* See Section 3.4.6.
+/* Initialization of an explicit cipher state.
+* Input ctx: the cipher state to be initialized.
+* Input k[4]: Four 32-bit words making up 128-bit key.
+* Input IV[4]: Four 32-bit words making 128-bit initialization variable.
+* Output: All the LFSRs and FSM of ctx are initialized for key generation.
+* See Section 4.1.
+*/
+
+void snow_3g_ctx_initialize(struct snow3g_ctx *ctx, const u32 k[4], const u32 IV[4])
+{
+	u32 *S = ctx->lfsr;
+	unsigned int j;
+	S[15] = k[3] ^ IV[0];
+	S[14] = k[2];
+	S[13] = k[1];
+	S[12] = k[0] ^ IV[1];
+	S[11] = k[3] ^ 0xffffffff;
+	S[10] = k[2] ^ 0xffffffff ^ IV[2];
+	S[9] = k[1] ^ 0xffffffff ^ IV[3];
+	S[8] = k[0] ^ 0xffffffff;
+	S[7] = k[3];
+	S[6] = k[2];
+	S[5] = k[1];
+	S[4] = k[0];
+	S[3] = k[3] ^ 0xffffffff;
+	S[2] = k[2] ^ 0xffffffff;
+	S[1] = k[1] ^ 0xffffffff;
+	S[0] = k[0] ^ 0xffffffff;
+	ctx->r1 = 0x0;
+	ctx->r2 = 0x0;
+	ctx->r3 = 0x0;
+	/* 32 clocks, i.e. two full turns of the circular LFSR buffer */
+	for (j = 0; j < 32; j++)
+		ClockSNOW3G(ctx, j, 1);
+}
+
+/* Generation of Keystream from an explicit cipher state.
+* input ctx: the cipher state, as initialized by snow_3g_ctx_initialize().
+* input n: number of 32-bit words of keystream.
+* input z: space for the generated keystream, assumes
+* memory is allocated already.
+* output: generated keystream which is filled in z
+* See section 4.2.
 */
 
-static u32 ClockFSM()
+void snow_3g_ctx_generate_key_stream(struct snow3g_ctx *ctx, u32 n, u32 *ks)
 {
-	u32 F = ( ( LFSR_S15 + FSM_R1 ) & 0xffffffff ) ^ FSM_R2 ;
-	u32 r = ( FSM_R2 + ( FSM_R3 ^ LFSR_S5 ) ) & 0xffffffff ;
-	FSM_R3 = S2(FSM_R2);
-	FSM_R2 = S1(FSM_R1);
-	FSM_R1 = r;
-	return F;
+	u32 t;
+
+	/* Clock FSM once, discard the output, and the LFSR in keystream mode */
+	ClockSNOW3G(ctx, 0, 0);
+	for (t = 0; t < n; t++) {
+		/* Note that ks[t] corresponds to z_{t+1} in section 4.2 */
+		ks[t] = ClockSNOW3G(ctx, t + 1, 0);
+	}
+	RealignLFSR(ctx, n + 1);
 }
 
 /* Initialization.
@@ -294,32 +322,7 @@ static u32 ClockFSM()
 
 void snow_3g_initialize(u32 k[4], u32 IV[4])
 {
-	u8 i=0;
-	u32 F = 0x0;
-	LFSR_S15 = k[3] ^ IV[0];
-	LFSR_S14 = k[2];
-	LFSR_S13 = k[1];
-	LFSR_S12 = k[0] ^ IV[1];
-	LFSR_S11 = k[3] ^ 0xffffffff;
-	LFSR_S10 = k[2] ^ 0xffffffff ^ IV[2];
-	LFSR_S9 = k[1] ^ 0xffffffff ^ IV[3];
-	LFSR_S8 = k[0] ^ 0xffffffff;
-	LFSR_S7 = k[3];
-	LFSR_S6 = k[2];
-	LFSR_S5 = k[1];
-	LFSR_S4 = k[0];
-	LFSR_S3 = k[3] ^ 0xffffffff;
-	LFSR_S2 = k[2] ^ 0xffffffff;
-	LFSR_S1 = k[1] ^ 0xffffffff;
-	LFSR_S0 = k[0] ^ 0xffffffff;
-	FSM_R1 = 0x0;
-	FSM_R2 = 0x0;
-	FSM_R3 = 0x0;
-	for(i=0;i<32;i++)
-	{
-		F = ClockFSM();
-		ClockLFSRInitializationMode(F);
-	}
+	snow_3g_ctx_initialize(&legacy_ctx, k, IV);
 }
 
 /* Generation of Keystream.
@@ -332,18 +335,23 @@ void snow_3g_initialize(u32 k[4], u32 IV[4])
 
 void snow_3g_generate_key_stream(u32 n, u32 *ks)
 {
-	u32 t = 0;
-	u32 F = 0x0;
-	ClockFSM(); /* Clock FSM once. Discard the output. */
-	ClockLFSRKeyStreamMode(); /* Clock LFSR in keystream mode once. */
-	for ( t=0; t<n; t++)
-	{
-		F = ClockFSM(); /* STEP 1 */
-		ks[t] = F ^ LFSR_S0; /* STEP 2 */
-		/* Note that ks[t] corresponds to z_{t+1} in section 4.2
-		*/
-		ClockLFSRKeyStreamMode(); /* STEP 3 */
-	}
+	snow_3g_ctx_generate_key_stream(&legacy_ctx, n, ks);
+}
+
+/* Key loading.
+* Input key_bytes: 128 bit key, most significant byte first.
+* Output key: the key as the four 32-bit words expected by
+* snow_3g_ctx_initialize(), to be re-used for any number of f8/f9 runs.
+* See sections 3.4 and 4.4.
+*/
+
+void snow_3g_key_load(struct snow3g_key *key, const u8 *key_bytes)
+{
+	int i;
+
+	for (i=0; i<4; i++)
+		key->k[3-i] = ((u32)key_bytes[4*i] << 24) ^ ((u32)key_bytes[4*i+1] << 16)
+			    ^ ((u32)key_bytes[4*i+2] << 8) ^ ((u32)key_bytes[4*i+3]);
 }
 
 /*-----------------------------------------------------------------------
@@ -377,41 +385,56 @@ void snow_3g_generate_key_stream(u32 n, u32 *ks)
 
 void snow_3g_f8(u8 *key, u32 count, u32 bearer, u32 dir, u8 *data, u32 length)
 {
-	u32 K[4],IV[4];
-	int n = ( length + 31 ) / 32;
-	int i=0;
+	struct snow3g_key K;
+
+	snow_3g_key_load(&K, key);
+	snow_3g_f8_key(&K, count, bearer, dir, data, length);
+}
+
+/* f8 with a pre-loaded key.
+* Input key: 128 bit Confidentiality Key, as loaded by snow_3g_key_load().
+* Other inputs and outputs as for snow_3g_f8().
+* Does not touch any global state and may be called concurrently.
+*/
+
+void snow_3g_f8_key(const struct snow3g_key *key, u32 count, u32 bearer, u32 dir,
+		    u8 *data, u32 length)
+{
+	struct snow3g_ctx ctx;
+	u32 IV[4];
+	u32 nbytes = ( length + 7 ) / 8;
+	u32 i, j, z;
 	int lastbits = (8-(length%8)) % 8;
-	u32 KS[n];
-	
-	/*Initialisation*/
-	/* Load the confidentiality key for SNOW 3G initialization as in section
-	3.4. */
-	for (i=0; i<4; i++)
-		K[3-i] = (key[4*i] << 24) ^ (key[4*i+1] << 16) 
-			   ^ (key[4*i+2] << 8) ^ (key[4*i+3]);
-	
+
 	/* Prepare the initialization vector (IV) for SNOW 3G initialization as in
 	section 3.4. */
 	IV[3] = count;
 	IV[2] = (bearer << 27) | ((dir & 0x1) << 26);
 	IV[1] = IV[3];
 	IV[0] = IV[2];
-	
-	/* Run SNOW 3G algorithm to generate sequence of key stream bits KS*/
-	snow_3g_initialize(K,IV);
-	snow_3g_generate_key_stream(n,(u32*)KS);
-	
-	/* Exclusive-OR the input data with keystream to generate the output bit
-	stream */
-	for (i=0; i<n; i++)
-	{
-		data[4*i+0] ^= (u8) (KS[i] >> 24) & 0xff;
-		data[4*i+1] ^= (u8) (KS[i] >> 16) & 0xff;
-		data[4*i+2] ^= (u8) (KS[i] >> 8) & 0xff;
-		data[4*i+3] ^= (u8) (KS[i] ) & 0xff;
+
+	snow_3g_ctx_initialize(&ctx, key->k, IV);
+
+	/* Run SNOW 3G algorithm to generate the key stream one word at a time
+	and Exclusive-OR it with the input data to generate the output bit
+	stream.  Unlike the reference code, no buffer for the complete key
+	stream is needed, and octets beyond the length of data are never
+	touched, as the caller's buffer need not be padded to 32 bits. */
+	ClockSNOW3G(&ctx, 0, 0);
+	for (i = 0, j = 1; i + 4 <= nbytes; i += 4, j++) {
+		z = ClockSNOW3G(&ctx, j, 0);
+		data[i+0] ^= (u8) (z >> 24);
+		data[i+1] ^= (u8) (z >> 16);
+		data[i+2] ^= (u8) (z >> 8);
+		data[i+3] ^= (u8) z;
 	}
-	
-	/* zero last bits of data in case its length is not byte-aligned 
+	if (i < nbytes) {
+		z = ClockSNOW3G(&ctx, j, 0);
+		for (; i < nbytes; i++, z <<= 8)
+			data[i] ^= (u8) (z >> 24);
+	}
+
+	/* zero last bits of data in case its length is not byte-aligned
 	   this is an addition to the C reference code, which did not handle it */
 	if (lastbits)
 		data[length/8] &= 256 - (1<<lastbits);
@@ -422,57 +445,80 @@ void snow_3g_f8(u8 *key, u32 count, u32 bearer, u32 dir, u8 *data, u32 length)
  *					f9.c
  *---------------------------------------------------------*/
 
-/* MUL64x.
- * Input V: a 64-bit input.
- * Input c: a 64-bit input.
- * Output : a 64-bit output.
- * A 64-bit memory is allocated which is to be freed by the calling 
- * function.
- * See section 4.3.2 for details.
+/* MUL64 by a constant multiplicand.
+ * Multiplication in GF(2^64) with the reduction polynomial of section 4.3,
+ * x^64 + x^4 + x^3 + x + 1 (c = 0x1b).  As f9 multiplies every message
+ * block by the same P (and the final result by Q), the per-multiplicand
+ * setup is done once by MUL64_init().  Where available (x86 PCLMULQDQ),
+ * a carry-less multiply is used, otherwise a 4-bit table of multiples.
+ * See section 4.3.4 for details.
  */
-static u64 MUL64x(u64 V, u64 c)
+struct mul64_ctx {
+	u64 P;
+	int clmul;
+	u64 T[16];	/* T[b] = b * P, only if !clmul */
+};
+
+/* R[h] = h * x^64 mod (x^64 + c), for the 4 bits h shifted out by x^4 */
+static const u64 MUL64_R[16] = {
+	0x00, 0x1b, 0x36, 0x2d, 0x6c, 0x77, 0x5a, 0x41,
+	0xd8, 0xc3, 0xee, 0xf5, 0xb4, 0xaf, 0x82, 0x99
+};
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HAVE_MUL64_CLMUL
+
+__attribute__((target("pclmul,sse2")))
+static u64 MUL64_clmul(u64 V, u64 P)
 {
-	if ( V & 0x8000000000000000 )
-		return (V << 1) ^ c;
-	else
-		return V << 1;
+	const __m128i c = _mm_cvtsi64_si128(0x1b);
+	__m128i prod = _mm_clmulepi64_si128(_mm_cvtsi64_si128(V), _mm_cvtsi64_si128(P), 0x00);
+	/* fold the upper 64 bits of the product: hi * x^64 = hi * c, which
+	 * overflows into at most 4 more bits, folded in the same way again */
+	__m128i t = _mm_clmulepi64_si128(prod, c, 0x01);
+	__m128i t2 = _mm_clmulepi64_si128(t, c, 0x01);
+
+	return (u64)_mm_cvtsi128_si64(prod) ^ (u64)_mm_cvtsi128_si64(t) ^
+	       (u64)_mm_cvtsi128_si64(t2);
 }
+#endif
 
-/* MUL64xPOW.
- * Input V: a 64-bit input.
- * Input i: a positive integer.
- * Input c: a 64-bit input.
- * Output : a 64-bit output.
- * A 64-bit memory is allocated which is to be freed by the calling function.
- * See section 4.3.3 for details.
- */
-static u64 MUL64xPOW(u64 V, u8 i, u64 c)
+static void MUL64_init(struct mul64_ctx *m, u64 P)
 {
-	if ( i == 0)
-		return V; 
-	else
-		return MUL64x( MUL64xPOW(V,i-1,c) , c);
+	int b;
+
+	m->P = P;
+#ifdef HAVE_MUL64_CLMUL
+	m->clmul = __builtin_cpu_supports("pclmul");
+	if (m->clmul)
+		return;
+#else
+	m->clmul = 0;
+#endif
+	/* T[b] for all 4-bit polynomials b; P * x^i for the single bits, XOR
+	 * of those for the others */
+	m->T[0] = 0;
+	m->T[1] = P;
+	for (b = 2; b < 16; b++) {
+		if (b & 1)
+			m->T[b] = m->T[b & ~1] ^ P;
+		else
+			m->T[b] = (m->T[b >> 1] << 1) ^ ((m->T[b >> 1] >> 63) ? 0x1b : 0);
+	}
 }
 
-/* MUL64.
- * Input V: a 64-bit input.
- * Input P: a 64-bit input.
- * Input c: a 64-bit input.
- * Output : a 64-bit output.
- * A 64-bit memory is allocated which is to be freed by the calling 
- * function.
- * See section 4.3.4 for details.
- */
-static u64 MUL64(u64 V, u64 P, u64 c)
+static inline u64 MUL64(u64 V, const struct mul64_ctx *m)
 {
 	u64 result = 0;
-	int i = 0;
-
-	for ( i=0; i<64; i++)
-	{
-		if( ( P>>i ) & 0x1 )
-			result ^= MUL64xPOW(V,i,c);
-	}
+	int i;
+
+#ifdef HAVE_MUL64_CLMUL
+	if (m->clmul)
+		return MUL64_clmul(V, m->P);
+#endif
+	/* Horner scheme over the nibbles of V, most significant first */
+	for (i = 60; i >= 0; i -= 4)
+		result = (result << 4) ^ MUL64_R[result >> 60] ^ m->T[(V >> i) & 0xf];
 	return result;
 }
 
@@ -496,27 +542,34 @@ static u8 mask8bit(int n)
  * Output  : 32 bit block used as MAC 
  * Generates 32-bit MAC using UIA2 algorithm as defined in Section 4.
  */
-void snow_3g_f9(u8* key, u32 count, u32 fresh, u32 dir, u8 *data, u64 length, 
+void snow_3g_f9(u8* key, u32 count, u32 fresh, u32 dir, u8 *data, u64 length,
         u8 *out)
 {
-	u32 K[4],IV[4], z[5];
+	struct snow3g_key K;
+
+	snow_3g_key_load(&K, key);
+	snow_3g_f9_key(&K, count, fresh, dir, data, length, out);
+}
+
+/* f9 with a pre-loaded key.
+ * Input key: 128 bit Integrity Key, as loaded by snow_3g_key_load().
+ * Other inputs and outputs as for snow_3g_f9().
+ * Does not touch any global state and may be called concurrently.
+ */
+void snow_3g_f9_key(const struct snow3g_key *key, u32 count, u32 fresh, u32 dir,
+		    const u8 *data, u64 length, u8 *out)
+{
+	struct snow3g_ctx ctx;
+	u32 IV[4], z[5];
 	u32 i=0, D;
 	u64 EVAL;
 	u64 V;
-	u64 P;
-	u64 Q;
-	u64 c;
+	struct mul64_ctx P;
+	struct mul64_ctx Q;
 	
 	u64 M_D_2;
 	int rem_bits = 0;
 	
-	/* Load the Integrity Key for SNOW3G initialization as in section 4.4. */
-	for (i=0; i<4; i++)
-    {
-		K[3-i] = (key[4*i] << 24) ^ (key[4*i+1] << 16) ^
-				 (key[4*i+2] << 8) ^ (key[4*i+3]);
-    }
-	
 	/* Prepare the Initialization Vector (IV) for SNOW3G initialization as 
 	   in section 4.4. */
 	IV[3] = count;
@@ -527,11 +580,11 @@ void snow_3g_f9(u8* key, u32 count, u32 fresh, u32 dir, u8 *data, u64 length,
 	z[0] = z[1] = z[2] = z[3] = z[4] = 0;
 	
 	/* Run SNOW 3G to produce 5 keystream words z_1, z_2, z_3, z_4 and z_5. */
-	snow_3g_initialize(K, IV);
-	snow_3g_generate_key_stream(5, z);
+	snow_3g_ctx_initialize(&ctx, key->k, IV);
+	snow_3g_ctx_generate_key_stream(&ctx, 5, z);
 	
-	P = (u64)z[0] << 32 | (u64)z[1];
-	Q = (u64)z[2] << 32 | (u64)z[3];
+	MUL64_init(&P, (u64)z[0] << 32 | (u64)z[1]);
+	MUL64_init(&Q, (u64)z[2] << 32 | (u64)z[3]);
 	
 	/* Calculation */
 	if ((length % 64) == 0)
@@ -539,7 +592,6 @@ void snow_3g_f9(u8* key, u32 count, u32 fresh, u32 dir, u8 *data, u64 length,
 	else
 		D = (length>>6) + 2;
 	EVAL = 0;
-	c = 0x1b;
 	
 	/* for 0 <= i <= D-3 */
 	for (i=0; i<D-2; i++)
@@ -548,7 +600,7 @@ void snow_3g_f9(u8* key, u32 count, u32 fresh, u32 dir, u8 *data, u64 length,
 				     (u64)data[8*i+2]<<40 | (u64)data[8*i+3]<<32 | 
                      (u64)data[8*i+4]<<24 | (u64)data[8*i+5]<<16 | 
 				     (u64)data[8*i+6]<< 8 | (u64)data[8*i+7] )   ;
-		EVAL = MUL64(V,P,c);
+		EVAL = MUL64(V,&P);
 	}
 	
 	/* for D-2 */
@@ -568,13 +620,13 @@ void snow_3g_f9(u8* key, u32 count, u32 fresh, u32 dir, u8 *data, u64 length,
 		M_D_2 |= (u64)(data[8*(D-2)+i] & mask8bit(rem_bits)) << (8*(7-i));
 	
 	V = EVAL ^ M_D_2;
-	EVAL = MUL64(V,P,c);
+	EVAL = MUL64(V,&P);
 	
 	/* for D-1 */
 	EVAL ^= length;
 	
 	/* Multiply by Q */
-	EVAL = MUL64(EVAL,Q,c);
+	EVAL = MUL64(EVAL,&Q);
 	
 	/* XOR with z_5: this is a modification to the reference C code, 
 	   which forgot to XOR z[5] */
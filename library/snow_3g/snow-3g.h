@@ -11,6 +11,27 @@ typedef uint8_t u8;
 typedef uint32_t u32;
 typedef uint64_t u64;
 
+/* Complete state of one SNOW 3G keystream generator (LFSR and FSM).
+* Each concurrent user of the cipher keeps its own instance, so the
+* snow_3g_ctx_*() and snow_3g_f{8,9}_key() functions are reentrant.
+*/
+
+struct snow3g_ctx {
+	u32 lfsr[16];	/* LFSR S0..S15 */
+	u32 r1;		/* FSM R1 */
+	u32 r2;		/* FSM R2 */
+	u32 r3;		/* FSM R3 */
+};
+
+/* A 128-bit key in the word representation used for initialization.
+* Load it once with snow_3g_key_load() and re-use it for any number of
+* COUNT/BEARER/FRESH/DIRECTION values.
+*/
+
+struct snow3g_key {
+	u32 k[4];
+};
+
 /* Initialization.
 * Input k[4]: Four 32-bit words making up 128-bit key.
 * Input IV[4]: Four 32-bit words making 128-bit initialization variable.
@@ -30,6 +51,21 @@ void snow_3g_initialize(u32 k[4], u32 IV[4]);
 
 void snow_3g_generate_key_stream(u32 n, u32 *z);
 
+/* Reentrant variants of snow_3g_initialize() and
+* snow_3g_generate_key_stream(), operating on an explicit state ctx.
+*/
+
+void snow_3g_ctx_initialize(struct snow3g_ctx *ctx, const u32 k[4], const u32 IV[4]);
+void snow_3g_ctx_generate_key_stream(struct snow3g_ctx *ctx, u32 n, u32 *z);
+
+/* Key loading.
+* Input key_bytes: 128 bit key, most significant byte first.
+* Output key: the key in the representation used by snow_3g_f8_key() and
+* snow_3g_f9_key().
+*/
+
+void snow_3g_key_load(struct snow3g_key *key, const u8 *key_bytes);
+
 /* f8.
 * Input key: 128 bit Confidentiality Key.
 * Input count:32-bit Count, Frame dependent input.
@@ -47,6 +83,11 @@ void snow_3g_generate_key_stream(u32 n, u32 *z);
 void snow_3g_f8( u8 *key, u32 count, u32 bearer, u32 dir,
                   u8 *data, u32 length );
 
+/* f8 with a key pre-loaded by snow_3g_key_load(); reentrant. */
+
+void snow_3g_f8_key(const struct snow3g_key *key, u32 count, u32 bearer, u32 dir,
+		    u8 *data, u32 length);
+
 /* f9.
 * Input key: 128 bit Integrity Key.
 * Input count:32-bit Count, Frame dependent input.
@@ -61,6 +102,11 @@ void snow_3g_f8( u8 *key, u32 count, u32 bearer, u32 dir,
 void snow_3g_f9( u8* key, u32 count, u32 fresh, u32 dir,
                  u8 *data, u64 length, u8 *out);
 
+/* f9 with a key pre-loaded by snow_3g_key_load(); reentrant. */
+
+void snow_3g_f9_key(const struct snow3g_key *key, u32 count, u32 fresh, u32 dir,
+		    const u8 *data, u64 length, u8 *out);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -10,6 +10,7 @@ FILES="
 	IPA_CodecPort_CtrlFunctDef.cc
 	IPL4asp_PT.cc
 	IPL4asp_discovery.cc
+	Index_FunctionDefs.cc
 	MAP_EncDec.cc
 	MGCP_CodecPort_CtrlFunctDef.cc
 	MNCC_EncDec.cc
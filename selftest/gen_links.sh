@@ -39,7 +39,23 @@ FILES="MobileL3_CC_Types.ttcn MobileL3_CommonIE_Types.ttcn MobileL3_GMM_SM_Types
 gen_links $DIR $FILES
 
 DIR=../library
-FILES="Misc_Helpers.ttcn General_Types.ttcn Osmocom_Types.ttcn GSM_Types.ttcn IPA_Types.ttcn IPA_CodecPort.ttcn IPA_CodecPort_CtrlFunct.ttcn IPA_CodecPort_CtrlFunctDef.cc IPA_Emulation.ttcnpp L3_Templates.ttcn BSSMAP_Templates.ttcn RLCMAC_CSN1_Templates.ttcn RLCMAC_CSN1_Types.ttcn GSM_RR_Types.ttcn GSM_RestOctets.ttcn RSL_Types.ttcn BSSAP_CodecPort.ttcn Osmocom_CTRL_Types.ttcn Osmocom_CTRL_Functions.ttcn PCO_Types.ttcn GSUP_Types.ttcn Native_Functions.ttcn Native_FunctionDefs.cc"
+FILES="Misc_Helpers.ttcn General_Types.ttcn Osmocom_Types.ttcn GSM_Types.ttcn IPA_Types.ttcn IPA_CodecPort.ttcn IPA_CodecPort_CtrlFunct.ttcn IPA_CodecPort_CtrlFunctDef.cc IPA_Emulation.ttcnpp L3_Templates.ttcn BSSMAP_Templates.ttcn RLCMAC_CSN1_Templates.ttcn RLCMAC_CSN1_Types.ttcn GSM_RR_Types.ttcn GSM_RestOctets.ttcn RSL_Types.ttcn BSSAP_CodecPort.ttcn Osmocom_CTRL_Types.ttcn Osmocom_CTRL_Functions.ttcn PCO_Types.ttcn GSUP_Types.ttcn Native_Functions.ttcn Native_FunctionDefs.cc Index_Functions.ttcn Index_FunctionDefs.cc"
+gen_links $DIR $FILES
+
+DIR=../library/snow_3g
+FILES="snow-3g.c snow-3g.h Snow3G_FunctionDefs.cc Snow3G_Functions.ttcn"
+gen_links $DIR $FILES
+
+DIR=../library/milenage
+FILES="milenage.c milenage.h Milenage_FunctionDefs.cc Milenage_Functions.ttcn "
+gen_links $DIR $FILES
+
+DIR=../library/ng_crypto
+FILES="ng_key_derivation.c ng_key_derivation.h "
+gen_links $DIR $FILES
+
+DIR=../library/lte_crypto
+FILES="key_derivation.c key_derivation.h "
 gen_links $DIR $FILES
 
 gen_links_finish
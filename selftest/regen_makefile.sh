@@ -3,12 +3,16 @@
 NAME=Selftest
 
 FILES="
+	*.c
 	*.ttcn
 	*.ttcnpp
 	IPA_CodecPort_CtrlFunctDef.cc
 	IPL4asp_PT.cc
 	IPL4asp_discovery.cc
+	Index_FunctionDefs.cc
+	Milenage_FunctionDefs.cc
 	Native_FunctionDefs.cc
+	Snow3G_FunctionDefs.cc
 	TCCConversion.cc
 	TCCInterface.cc
 "
@@ -20,3 +24,5 @@ CPPFLAGS_TTCN3="
 "
 
 . ../_buildsystem/regen_makefile.inc.sh
+
+sed -i -e 's/^LINUX_LIBS = -lxml2 -lsctp/LINUX_LIBS = -lxml2 -lsctp -lgnutls/' Makefile
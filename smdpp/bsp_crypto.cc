@@ -13,6 +13,14 @@
 #include <iomanip>
 #include <cassert>
 #include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <unistd.h>
+#include <exception>
+#include <algorithm>
 
 namespace BspCryptoNS {
 
@@ -103,28 +111,28 @@ void ReplaceSessionKeysRequest_outer_Deleter::operator()(ReplaceSessionKeysReque
     ReplaceSessionKeysRequest_outer_free(ss1);
 }
 
-// reusing a dirty pointer fails
-#define ossl_free_reset(add)                                                                                                                                   \
-	{                                                                                                                                                      \
-		OPENSSL_free(add);                                                                                                                             \
-		add = 0;                                                                                                                                       \
-}
-
 // BspCrypto implementation
 BspCrypto::BspCrypto(const std::vector<uint8_t>& s_enc_key, const std::vector<uint8_t>& s_mac_key, const std::vector<uint8_t>& initial_mcv)
     : s_enc(s_enc_key), s_mac(s_mac_key), mac_chain(initial_mcv), block_number(1) {
     assert(s_enc.size() == AES_KEY_SIZE);
     assert(s_mac.size() == AES_KEY_SIZE);
     assert(mac_chain.size() == AES_BLOCK_SIZE);
+
+    cmac_tmpl = new_cmac_ctx(s_mac);
+    enc_tmpl = new_cipher_ctx(s_enc, true);
+    dec_tmpl = new_cipher_ctx(s_enc, false);
 }
 
-std::vector<uint8_t> BspCrypto::compute_cmac(const std::vector<uint8_t>& key, const std::vector<uint8_t>& data, size_t output_size) {
-	EVP_MAC* mac = EVP_MAC_fetch(nullptr, "CMAC", nullptr);
+// fetched once per process, EVP_MAC_fetch() is a locked lookup
+EVP_MAC* BspCrypto::cmac_impl() {
+	static EVP_MAC_unique_ptr mac(EVP_MAC_fetch(nullptr, "CMAC", nullptr));
 	if (!mac)
 		throw std::runtime_error("Failed to fetch CMAC implementation");
+	return mac.get();
+}
 
-    EVP_MAC_CTX_unique_ptr mac_ctx(EVP_MAC_CTX_new(mac));
-    EVP_MAC_free(mac);
+EVP_MAC_CTX_unique_ptr BspCrypto::new_cmac_ctx(const std::vector<uint8_t>& key) {
+    EVP_MAC_CTX_unique_ptr mac_ctx(EVP_MAC_CTX_new(cmac_impl()));
 	if (!mac_ctx)
 		throw std::runtime_error("Failed to create MAC context");
 
@@ -135,8 +143,45 @@ std::vector<uint8_t> BspCrypto::compute_cmac(const std::vector<uint8_t>& key, co
         throw std::runtime_error("Failed to init MAC");
     }
 
-    if (EVP_MAC_update(mac_ctx.get(), data.data(), data.size()) != 1) {
-        throw std::runtime_error("Failed to update MAC");
+    return mac_ctx;
+}
+
+EVP_CIPHER_CTX_unique_ptr BspCrypto::new_cipher_ctx(const std::vector<uint8_t>& key, bool encrypt) {
+    if (key.size() != AES_KEY_SIZE) {
+        throw std::runtime_error("Invalid key size");
+    }
+
+    EVP_CIPHER_CTX_unique_ptr ctx(EVP_CIPHER_CTX_new());
+	if (!ctx)
+		throw std::runtime_error("Failed to create cipher context");
+
+    // the IV is set per operation
+    if (EVP_CipherInit_ex(ctx.get(), EVP_aes_128_cbc(), nullptr, key.data(), nullptr, encrypt ? 1 : 0) != 1) {
+        throw std::runtime_error(encrypt ? "Failed to init AES encryption" : "Failed to init AES decryption");
+    }
+
+    // Disable padding since we handle custom padding ourselves
+    if (EVP_CIPHER_CTX_set_padding(ctx.get(), 0) != 1) {
+        throw std::runtime_error("Failed to disable padding");
+    }
+
+    return ctx;
+}
+
+std::vector<uint8_t> BspCrypto::compute_cmac(const std::vector<uint8_t>& data, size_t output_size) const {
+    return compute_cmac({ { data.data(), data.size() } }, output_size);
+}
+
+std::vector<uint8_t> BspCrypto::compute_cmac(std::initializer_list<std::pair<const uint8_t*, size_t>> parts, size_t output_size) const {
+    // copy of the keyed context, leaves the template ready for the next one
+    EVP_MAC_CTX_unique_ptr mac_ctx(EVP_MAC_CTX_dup(cmac_tmpl.get()));
+	if (!mac_ctx)
+		throw std::runtime_error("Failed to create MAC context");
+
+    for (const auto& part : parts) {
+        if (EVP_MAC_update(mac_ctx.get(), part.first, part.second) != 1) {
+            throw std::runtime_error("Failed to update MAC");
+        }
     }
 
     std::vector<uint8_t> output(output_size);
@@ -149,45 +194,41 @@ std::vector<uint8_t> BspCrypto::compute_cmac(const std::vector<uint8_t>& key, co
     return output;
 }
 
-std::vector<uint8_t> BspCrypto::aes_cipher_operation(const std::vector<uint8_t>& input, const std::vector<uint8_t>& key, const std::vector<uint8_t>& iv,
-						     bool encrypt) {
-    if (key.size() != AES_KEY_SIZE) {
-        throw std::runtime_error("Invalid key size");
-    }
+std::vector<uint8_t> BspCrypto::aes_cipher_operation(const std::vector<uint8_t>& input, const std::vector<uint8_t>& iv, bool encrypt) const {
     if (iv.size() != AES_BLOCK_SIZE) {
         throw std::runtime_error("Invalid IV size");
     }
 
+    std::vector<uint8_t> output(input.size());
+    output.resize(aes_cipher_operation(input.data(), input.size(), iv.data(), encrypt, output.data()));
+    return output;
+}
+
+EVP_CIPHER_CTX_unique_ptr BspCrypto::copy_cipher_ctx(bool encrypt) const {
     EVP_CIPHER_CTX_unique_ptr ctx(EVP_CIPHER_CTX_new());
-	if (!ctx)
+	if (!ctx || EVP_CIPHER_CTX_copy(ctx.get(), encrypt ? enc_tmpl.get() : dec_tmpl.get()) != 1)
 		throw std::runtime_error("Failed to create cipher context");
+    return ctx;
+}
 
-    const EVP_CIPHER* cipher = EVP_aes_128_cbc();
-
-    int result;
-    if (encrypt) {
-        result = EVP_EncryptInit_ex(ctx.get(), cipher, nullptr, key.data(), iv.data());
-    } else {
-        result = EVP_DecryptInit_ex(ctx.get(), cipher, nullptr, key.data(), iv.data());
-    }
+size_t BspCrypto::aes_cipher_operation(const uint8_t* input, size_t input_len, const uint8_t* iv, bool encrypt, uint8_t* output) const {
+    // copy of the keyed context, only the IV is set up here
+    return aes_cipher_run(copy_cipher_ctx(encrypt).get(), input, input_len, iv, encrypt, output);
+}
 
-    if (result != 1) {
+size_t BspCrypto::aes_cipher_run(EVP_CIPHER_CTX* ctx, const uint8_t* input, size_t input_len, const uint8_t* iv, bool encrypt, uint8_t* output) {
+    if (EVP_CipherInit_ex(ctx, nullptr, nullptr, nullptr, iv, -1) != 1) {
         throw std::runtime_error(encrypt ? "Failed to init AES encryption" : "Failed to init AES decryption");
     }
 
-    // Disable padding since we handle custom padding ourselves
-    if (EVP_CIPHER_CTX_set_padding(ctx.get(), 0) != 1) {
-        throw std::runtime_error("Failed to disable padding");
-    }
-
-    // Allocate output buffer (may need extra block for padding)
-    std::vector<uint8_t> output(input.size() + AES_BLOCK_SIZE);
+    // With padding disabled, at most input_len octets are written
     int len = 0;
+    int result;
 
     if (encrypt) {
-        result = EVP_EncryptUpdate(ctx.get(), output.data(), &len, input.data(), input.size());
+        result = EVP_EncryptUpdate(ctx, output, &len, input, input_len);
     } else {
-        result = EVP_DecryptUpdate(ctx.get(), output.data(), &len, input.data(), input.size());
+        result = EVP_DecryptUpdate(ctx, output, &len, input, input_len);
     }
 
     if (result != 1) {
@@ -195,16 +236,16 @@ std::vector<uint8_t> BspCrypto::aes_cipher_operation(const std::vector<uint8_t>&
     }
 
     // Verify output length matches input (since padding is disabled)
-    if (len != static_cast<int>(input.size())) {
+    if (len != static_cast<int>(input_len)) {
 		throw std::runtime_error("Unexpected " + std::string(encrypt ? "encryption" : "decryption") + " output length: " + std::to_string(len) +
-                               " expected: " + std::to_string(input.size()));
+                               " expected: " + std::to_string(input_len));
     }
 
     int final_len = 0;
     if (encrypt) {
-        result = EVP_EncryptFinal_ex(ctx.get(), output.data() + len, &final_len);
+        result = EVP_EncryptFinal_ex(ctx, output + len, &final_len);
     } else {
-        result = EVP_DecryptFinal_ex(ctx.get(), output.data() + len, &final_len);
+        result = EVP_DecryptFinal_ex(ctx, output + len, &final_len);
     }
 
     if (result != 1) {
@@ -216,8 +257,7 @@ std::vector<uint8_t> BspCrypto::aes_cipher_operation(const std::vector<uint8_t>&
 		throw std::runtime_error("Unexpected final " + std::string(encrypt ? "encryption" : "decryption") + " length: " + std::to_string(final_len));
     }
 
-    output.resize(len);
-    return output;
+    return len;
 }
 
 std::vector<uint8_t> BspCrypto::encode_bertlv_length(size_t length) {
@@ -247,18 +287,22 @@ void BspCrypto::print_hex(const char* label, const unsigned char* data, int len)
 }
 
 std::pair<size_t, size_t> BspCrypto::parse_bertlv_length(const std::vector<uint8_t>& data, size_t offset) {
-	if (offset >= data.size())
+    return parse_bertlv_length(data.data(), data.size(), offset);
+}
+
+std::pair<size_t, size_t> BspCrypto::parse_bertlv_length(const uint8_t* data, size_t size, size_t offset) {
+	if (offset >= size)
 		throw std::runtime_error("Invalid length offset");
 
     uint8_t first_byte = data[offset];
     if (first_byte < 0x80) {
 		return { first_byte, offset + 1 };
     } else if (first_byte == 0x81) {
-		if (offset + 1 >= data.size())
+		if (offset + 1 >= size)
 			throw std::runtime_error("Invalid length encoding");
 		return { data[offset + 1], offset + 2 };
     } else if (first_byte == 0x82) {
-		if (offset + 2 >= data.size())
+		if (offset + 2 >= size)
 			throw std::runtime_error("Invalid length encoding");
         size_t length = (data[offset + 1] << 8) | data[offset + 2];
 		return { length, offset + 3 };
@@ -347,49 +391,79 @@ std::vector<uint8_t> BspCrypto::add_padding(const std::vector<uint8_t>& data) {
 }
 
 std::vector<uint8_t> BspCrypto::remove_padding(const std::vector<uint8_t>& data) {
-  if (data.empty())
-    return data;
+  return std::vector<uint8_t>(data.begin(), data.begin() + unpadded_length(data.data(), data.size()));
+}
 
+size_t BspCrypto::unpadded_length(const uint8_t* data, size_t len) {
 // Remove trailing zeros first
-  int last_nonzero = data.size() - 1;
-  while (last_nonzero >= 0 && data[last_nonzero] == 0x00) {
+  size_t last_nonzero = len;
+  while (last_nonzero > 0 && data[last_nonzero - 1] == 0x00) {
     last_nonzero--;
   }
-  if (last_nonzero >= 0 && data[last_nonzero] == 0x80) {
-    return std::vector<uint8_t>(data.begin(), data.begin() + last_nonzero);
+  if (last_nonzero > 0 && data[last_nonzero - 1] == 0x80) {
+    return last_nonzero - 1;
   }
-  return data;
+  return len;
 }
 
 std::vector<uint8_t> BspCrypto::aes_encrypt(const std::vector<uint8_t>& plaintext) {
     auto padded = add_padding(plaintext);
     auto icv = generate_icv();
-    return aes_cipher_operation(padded, s_enc, icv, true);
+    return aes_cipher_operation(padded, icv, true);
 }
 
 std::vector<uint8_t> BspCrypto::aes_decrypt_with_icv(const std::vector<uint8_t>& ciphertext, const std::vector<uint8_t>& icv) {
-    auto decrypted = aes_cipher_operation(ciphertext, s_enc, icv, false);
+    auto decrypted = aes_cipher_operation(ciphertext, icv, false);
     return remove_padding(decrypted);
 }
 
-std::vector<uint8_t> BspCrypto::generate_icv_for_block(uint32_t block_num) {
-    std::vector<uint8_t> block_data(AES_BLOCK_SIZE, 0);
-
+void BspCrypto::icv_block(uint32_t block_num, uint8_t* block) {
     uint32_t block_num_be = htonl(block_num);
-    memcpy(&block_data[12], &block_num_be, 4);
+
+    memset(block, 0, AES_BLOCK_SIZE - 4);
+    memcpy(block + AES_BLOCK_SIZE - 4, &block_num_be, 4);
+}
+
+std::vector<uint8_t> BspCrypto::generate_icv_for_block(uint32_t block_num) {
+    std::vector<uint8_t> block_data(AES_BLOCK_SIZE);
+    icv_block(block_num, block_data.data());
 
     std::vector<uint8_t> zero_iv(AES_BLOCK_SIZE, 0);
-    return aes_cipher_operation(block_data, s_enc, zero_iv, true);
+    return aes_cipher_operation(block_data, zero_iv, true);
 }
 
 std::vector<uint8_t> BspCrypto::verify_and_decrypt_helper(const std::vector<uint8_t>& segment, const std::vector<uint8_t>& mac_chain_to_use, bool decrypt) {
-	if (segment.size() < 3)
+    std::vector<uint8_t> output(segment.size());
+    output.resize(verify_and_decrypt_segment(segment.data(), segment.size(), mac_chain_to_use, decrypt, output.data()));
+    return output;
+}
+
+size_t BspCrypto::verify_and_decrypt_segment(const uint8_t* segment, size_t segment_len, const std::vector<uint8_t>& mac_chain_to_use, bool decrypt,
+					     uint8_t* out) {
+    size_t payload_length;
+    const uint8_t* payload = verify_segment(segment, segment_len, mac_chain_to_use, payload_length);
+
+    if (decrypt) {
+        // generate_icv() increments block_number
+        auto icv = generate_icv();
+        size_t len = aes_cipher_operation(payload, payload_length, icv.data(), false, out);
+        return unpadded_length(out, len);
+    } else {
+        // MAC-only: return payload as-is and increment block counter
+        block_number++;
+        memcpy(out, payload, payload_length);
+        return payload_length;
+    }
+}
+
+const uint8_t* BspCrypto::verify_segment(const uint8_t* segment, size_t segment_len, const std::vector<uint8_t>& mac_chain_to_use, size_t& payload_length) {
+	if (segment_len < 3)
 		throw std::runtime_error("Segment too small");
 
     uint8_t tag = segment[0];
-    auto [length, length_end] = parse_bertlv_length(segment, 1);
+    auto [length, length_end] = parse_bertlv_length(segment, segment_len, 1);
 
-    if (length_end + length > segment.size()) {
+    if (length_end + length > segment_len) {
         throw std::runtime_error("Invalid segment length");
     }
 
@@ -397,40 +471,197 @@ std::vector<uint8_t> BspCrypto::verify_and_decrypt_helper(const std::vector<uint
         throw std::runtime_error("Invalid segment length: payload too small");
     }
 
-    size_t payload_length = length - MAC_LENGTH;
-    std::vector<uint8_t> payload(segment.begin() + length_end, segment.begin() + length_end + payload_length);
-	std::vector<uint8_t> received_mac(segment.begin() + length_end + payload_length, segment.begin() + length_end + length);
+    payload_length = length - MAC_LENGTH;
+    const uint8_t* payload = segment + length_end;
+    const uint8_t* received_mac = payload + payload_length;
 
-    size_t lcc = payload.size() + MAC_LENGTH;
-    std::vector<uint8_t> temp_data;
-    temp_data.insert(temp_data.end(), mac_chain_to_use.begin(), mac_chain_to_use.end());
-    temp_data.push_back(tag);
-
-    auto length_bytes = encode_bertlv_length(lcc);
-    temp_data.insert(temp_data.end(), length_bytes.begin(), length_bytes.end());
-    temp_data.insert(temp_data.end(), payload.begin(), payload.end());
+    // MAC over mac_chain + tag + length + payload, straight from the segment
+    auto length_bytes = encode_bertlv_length(payload_length + MAC_LENGTH);
+    std::vector<uint8_t> computed_full_mac = compute_cmac({ { mac_chain_to_use.data(), mac_chain_to_use.size() },
+							     { &tag, 1 },
+							     { length_bytes.data(), length_bytes.size() },
+							     { payload, payload_length } });
 
-    std::vector<uint8_t> computed_full_mac = compute_cmac(s_mac, temp_data);
-    std::vector<uint8_t> computed_mac(computed_full_mac.begin(), computed_full_mac.begin() + MAC_LENGTH);
-
-    if (received_mac != computed_mac) {
+    if (CRYPTO_memcmp(received_mac, computed_full_mac.data(), MAC_LENGTH) != 0) {
         throw std::runtime_error("MAC verification failed");
     }
 
     // Update instance state
     mac_chain = computed_full_mac;
 
-    if (decrypt) {
-        // generate_icv() increments block_number
-        auto icv = generate_icv();
-        return aes_decrypt_with_icv(payload, icv);
-    } else {
-        // MAC-only: return payload as-is and increment block counter
-        block_number++;
-        return payload;
+    return payload;
+}
+
+void BspCrypto::append_verified_segment(const uint8_t* segment, size_t segment_len, bool decrypt, std::vector<uint8_t>& out) {
+    size_t offset = out.size();
+
+    // no reallocation if the caller reserved enough
+    out.resize(offset + segment_len);
+    out.resize(offset + verify_and_decrypt_segment(segment, segment_len, mac_chain, decrypt, out.data() + offset));
+}
+
+namespace {
+
+// Threads kept across calls for parallel_ranges(), so that processing a profile does not start and join a set of
+// threads every time. Never destroyed: the workers are detached and may still wait on the queue at exit. A forked
+// child (TITAN components are processes) has none of the parent's threads and starts a pool of its own.
+class WorkerPool {
+  public:
+    static WorkerPool& instance(unsigned num_threads) {
+        static std::mutex instance_mutex;
+        static WorkerPool* pool = nullptr;
+        std::lock_guard<std::mutex> lock(instance_mutex);
+        if (!pool || pool->owner != getpid())
+            pool = new WorkerPool(num_threads);
+        return *pool;
+    }
+
+    unsigned size() const { return num_threads; }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        cond.notify_one();
+    }
+
+  private:
+    explicit WorkerPool(unsigned n) : num_threads(n), owner(getpid()) {
+        for (unsigned i = 0; i < n; i++)
+            std::thread(&WorkerPool::work, this).detach();
+    }
+
+    void work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [this]() { return !tasks.empty(); });
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    const unsigned num_threads;
+    const pid_t owner;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<std::function<void()>> tasks;
+};
+
+// Split [0, num) into contiguous ranges and run fn(begin, end) for each, the first one on the calling thread and
+// the others on the worker pool; the first exception thrown by a range is rethrown once all of them are done
+template <typename Fn> void parallel_ranges(size_t num, unsigned max_workers, Fn fn) {
+    unsigned workers = std::max(1u, std::min(max_workers, std::thread::hardware_concurrency()));
+    WorkerPool& pool = WorkerPool::instance(workers - 1);
+    workers = std::min<size_t>(std::min(workers, pool.size() + 1), num);
+    if (workers <= 1) {
+        fn(0, num);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(workers);
+    size_t per_worker = (num + workers - 1) / workers;
+    std::mutex mutex;
+    std::condition_variable done;
+    unsigned pending = workers - 1;
+
+    auto run_range = [&fn, &errors, per_worker, num](unsigned w) {
+        size_t begin = w * per_worker;
+        size_t end = std::min(num, begin + per_worker);
+        try {
+            fn(begin, end);
+        } catch (...) {
+            errors[w] = std::current_exception();
+        }
+    };
+
+    for (unsigned w = 1; w < workers; w++) {
+        pool.submit([&run_range, &mutex, &done, &pending, w]() {
+            run_range(w);
+            // notify while holding the lock: the caller may return and destroy mutex/done right after
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0)
+                done.notify_one();
+        });
+    }
+    run_range(0);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&pending]() { return pending == 0; });
+    }
+    for (auto& e : errors) {
+        if (e)
+            std::rethrow_exception(e);
     }
 }
 
+} // namespace
+
+void BspCrypto::verify_and_decrypt_segments(const std::vector<std::pair<const uint8_t*, size_t>>& segments, std::vector<uint8_t>& out,
+					    std::vector<size_t>* ends) {
+    if (segments.size() < PARALLEL_MIN_SEGMENTS) {
+        for (const auto& seg : segments) {
+            append_verified_segment(seg.first, seg.second, true, out);
+            if (ends)
+                ends->push_back(out.size());
+        }
+        return;
+    }
+
+    struct Job {
+        const uint8_t* ciphertext;
+        size_t len;
+        uint32_t block_num;
+        size_t offset; // of the plaintext in out
+        size_t plain_len;
+    };
+    std::vector<Job> jobs;
+    jobs.reserve(segments.size());
+
+    // Stage 1: the MAC chain, strictly in order; nothing is decrypted unless all segments verify
+    size_t base = out.size();
+    size_t offset = base;
+    for (const auto& seg : segments) {
+        Job job;
+        job.ciphertext = verify_segment(seg.first, seg.second, mac_chain, job.len);
+        job.block_num = block_number++;
+        job.offset = offset;
+        offset += job.len;
+        jobs.push_back(job);
+    }
+
+    // Stage 2: each worker derives the ICVs and decrypts its share of the segments on its own context copies
+    out.resize(offset);
+    parallel_ranges(jobs.size(), MAX_WORKERS, [this, &jobs, &out](size_t begin, size_t end) {
+        auto enc = copy_cipher_ctx(true);
+        auto dec = copy_cipher_ctx(false);
+        uint8_t block[AES_BLOCK_SIZE], icv[AES_BLOCK_SIZE];
+        static const uint8_t zero_iv[AES_BLOCK_SIZE] = {};
+
+        for (size_t i = begin; i < end; i++) {
+            Job& job = jobs[i];
+            icv_block(job.block_num, block);
+            aes_cipher_run(enc.get(), block, AES_BLOCK_SIZE, zero_iv, true, icv);
+            uint8_t* plain = out.data() + job.offset;
+            job.plain_len = unpadded_length(plain, aes_cipher_run(dec.get(), job.ciphertext, job.len, icv, false, plain));
+        }
+    });
+
+    // Close the gaps left by the removed padding
+    size_t w = base;
+    for (const Job& job : jobs) {
+        memmove(out.data() + w, out.data() + job.offset, job.plain_len);
+        w += job.plain_len;
+        if (ends)
+            ends->push_back(w);
+    }
+    out.resize(w);
+}
+
 std::vector<uint8_t> BspCrypto::compute_mac(uint8_t tag, const std::vector<uint8_t>& data) {
     size_t lcc = data.size() + MAC_LENGTH;
 
@@ -444,7 +675,7 @@ std::vector<uint8_t> BspCrypto::compute_mac(uint8_t tag, const std::vector<uint8
     temp_data.insert(temp_data.end(), data.begin(), data.end());
 
     // Compute CMAC
-    std::vector<uint8_t> full_mac = compute_cmac(s_mac, temp_data);
+    std::vector<uint8_t> full_mac = compute_cmac(temp_data);
 
     mac_chain = full_mac;
 
@@ -577,6 +808,48 @@ std::vector<uint8_t> BspCrypto::mac_only_one(uint8_t tag, const std::vector<uint
 std::vector<std::vector<uint8_t>> BspCrypto::encrypt_and_mac_seg(uint8_t tag, const std::vector<uint8_t>& data) {
     std::vector<std::vector<uint8_t>> segments;
     size_t max_payload = MAX_SEGMENT_SIZE - 10; // Account for overhead
+    size_t num = (data.size() + max_payload - 1) / max_payload;
+
+    if (num >= PARALLEL_MIN_SEGMENTS) {
+        // Mirror image of verify_and_decrypt_segments(): the ciphertext of a segment only depends on the ICV of its
+        // block number, so the segments are encrypted in parallel and then MACed in order
+        segments.resize(num);
+        uint32_t first_block = block_number;
+        parallel_ranges(num, MAX_WORKERS, [&](size_t begin, size_t end) {
+            auto enc = copy_cipher_ctx(true);
+            uint8_t block[AES_BLOCK_SIZE], icv[AES_BLOCK_SIZE];
+            static const uint8_t zero_iv[AES_BLOCK_SIZE] = {};
+            std::vector<uint8_t> padded;
+
+            for (size_t i = begin; i < end; i++) {
+                size_t offset = i * max_payload;
+                size_t segment_size = std::min(max_payload, data.size() - offset);
+
+                padded.assign(data.begin() + offset, data.begin() + offset + segment_size);
+                padded.push_back(0x80);
+                padded.resize((padded.size() + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE * AES_BLOCK_SIZE, 0x00);
+
+                // tag + length + ciphertext + mac, the mac is filled in below
+                auto length_bytes = encode_bertlv_length(padded.size() + MAC_LENGTH);
+                std::vector<uint8_t>& segment = segments[i];
+                segment.resize(1 + length_bytes.size() + padded.size() + MAC_LENGTH);
+                segment[0] = tag;
+                memcpy(&segment[1], length_bytes.data(), length_bytes.size());
+
+                icv_block(first_block + i, block);
+                aes_cipher_run(enc.get(), block, AES_BLOCK_SIZE, zero_iv, true, icv);
+                aes_cipher_run(enc.get(), padded.data(), padded.size(), icv, true, &segment[1 + length_bytes.size()]);
+            }
+        });
+
+        for (auto& segment : segments) {
+            size_t mac_offset = segment.size() - MAC_LENGTH;
+            mac_chain = compute_cmac({ { mac_chain.data(), mac_chain.size() }, { segment.data(), mac_offset } });
+            memcpy(&segment[mac_offset], mac_chain.data(), MAC_LENGTH);
+        }
+        block_number += num;
+        return segments;
+    }
 
     for (size_t offset = 0; offset < data.size(); offset += max_payload) {
         size_t segment_size = std::min(max_payload, data.size() - offset);
@@ -600,90 +873,177 @@ std::vector<std::vector<uint8_t>> BspCrypto::mac_only_seg(uint8_t tag, const std
     return segments;
 }
 
+namespace {
+
+// One BER-TLV inside the BoundProfilePackage, pointing into the caller's buffer
+struct BerTlv {
+    uint32_t tag;
+    const uint8_t* start; // first octet of the tag
+    const uint8_t* value;
+    size_t len;
+
+    size_t total() const { return (value - start) + len; }
+};
+
+// Parse the TLV at p, which must carry the given tag (multi octet tags packed, e.g. 0xBF36) and fit before end
+BerTlv expect_tlv(const uint8_t* p, const uint8_t* end, uint32_t tag) {
+    BerTlv tlv{ 0, p, nullptr, 0 };
+
+    if (p >= end)
+        throw BspCrypto::BppFormatError("Missing tag " + std::to_string(tag));
+
+    tlv.tag = *p++;
+    if ((tlv.tag & 0x1f) == 0x1f) {
+        do {
+            if (p >= end || tlv.tag > 0xffffff)
+                throw BspCrypto::BppFormatError("Truncated tag");
+            tlv.tag = (tlv.tag << 8) | *p;
+        } while (*p++ & 0x80);
+    }
+    if (tlv.tag != tag)
+        throw BspCrypto::BppFormatError("Unexpected tag " + std::to_string(tlv.tag) + ", expected " + std::to_string(tag));
+
+    if (p >= end)
+        throw BspCrypto::BppFormatError("Truncated length");
+    uint8_t first_byte = *p++;
+    if (first_byte < 0x80) {
+        tlv.len = first_byte;
+    } else {
+        size_t num = first_byte & 0x7f;
+        // indefinite length is not allowed in DER
+        if (num == 0 || num > 4)
+            throw BspCrypto::BppFormatError("Unsupported length encoding");
+        if (static_cast<size_t>(end - p) < num)
+            throw BspCrypto::BppFormatError("Truncated length");
+        while (num--)
+            tlv.len = (tlv.len << 8) | *p++;
+    }
+
+    if (tlv.len > static_cast<size_t>(end - p))
+        throw BspCrypto::BppFormatError("Length exceeds BoundProfilePackage");
+    tlv.value = p;
+    return tlv;
+}
+
+// Call fn for each element of a SEQUENCE OF with the given tag, returns the number of elements
+template <typename Fn> int for_each_tlv(const BerTlv& seq, uint32_t tag, Fn fn) {
+    const uint8_t* p = seq.value;
+    const uint8_t* end = seq.value + seq.len;
+    int num = 0;
+
+    while (p < end) {
+        BerTlv elem = expect_tlv(p, end, tag);
+        fn(elem);
+        p += elem.total();
+        num++;
+    }
+    return num;
+}
+
+} // namespace
+
 BspCrypto::BppProcessingResult BspCrypto::process_bound_profile_package(const std::vector<uint8_t>& allofit) {
-    BppProcessingResult result;
-    auto p = allofit.data();
-    BPP_ptr bpp(d2i_BoundProfilePackage_tagged(nullptr, &p, allofit.size()));
-    if (!bpp) {
-        std::cout << "Failed to decode BoundProfilePackage" << std::endl;
+    try {
+        return process_bpp(allofit.data(), allofit.size(), nullptr);
+    } catch (const BppFormatError& e) {
+        std::cout << "Failed to decode BoundProfilePackage: " << e.what() << std::endl;
         print_hex("  Data", allofit.data(), (allofit.size() > 32) ? 32 : allofit.size());
-        return result;
+        return BppProcessingResult();
     }
+}
 
-    // all mandatory
-	if (bpp->firstSequenceOf87 == nullptr || bpp->sequenceOf88 == nullptr || bpp->sequenceOf86 == nullptr) {
-            std::cout << "Malformed BoundProfilePackage" << std::endl;
-            return result;
-    }
+BspCrypto::BppProcessingResult BspCrypto::process_bound_profile_package(const uint8_t* data, size_t len, const BppSink& profile_sink) {
+    return process_bpp(data, len, &profile_sink);
+}
+
+BspCrypto::BppProcessingResult BspCrypto::process_bpp(const uint8_t* data, size_t len, const BppSink* profile_sink) {
+    BppProcessingResult result;
 
-    result.hasReplaceSessionKeys = bpp->secondSequenceOf87 != nullptr;
+    BerTlv bpp = expect_tlv(data, data + len, 0xBF36);
+    const uint8_t* p = bpp.value;
+    const uint8_t* end = bpp.value + bpp.len;
 
-	unsigned char* encoded = nullptr;
-	ASN1_OCTET_STRING* elem = nullptr;
-    int len = 0;
+    // InitialiseSecureChannelRequest was consumed when the session keys were derived
+    p += expect_tlv(p, end, 0xBF23).total();
+
+    // all mandatory except [2]
+    BerTlv seq87 = expect_tlv(p, end, 0xA0);
+    p += seq87.total();
+    BerTlv seq88 = expect_tlv(p, end, 0xA1);
+    p += seq88.total();
+    result.hasReplaceSessionKeys = p < end && *p == 0xA2;
+    BerTlv seq87_2{};
+    if (result.hasReplaceSessionKeys) {
+        seq87_2 = expect_tlv(p, end, 0xA2);
+        p += seq87_2.total();
+    }
+    BerTlv seq86 = expect_tlv(p, end, 0xA3);
 
     // Step 1: Decrypt ConfigureISDP with session keys
     std::cout << "Step 1: Decrypting ConfigureISDP with session keys..." << std::endl;
-    elem = sk_ASN1_OCTET_STRING_value(bpp->firstSequenceOf87, 0);
-    len = i2d_ASN1_OCTET_STRING_TAG7(elem, &encoded);
-	result.configureIsdp = decrypt_and_verify({ encoded, encoded + len }, true);
-    ossl_free_reset(encoded);
+    for_each_tlv(seq87, 0x87, [&](const BerTlv& seg) { append_verified_segment(seg.start, seg.total(), true, result.configureIsdp); });
 
     // Step 2: Verify StoreMetadata with session keys (MAC-only)
     std::cout << "Step 2: Verifying StoreMetadata with session keys (MAC-only)..." << std::endl;
-    int num_metadata = sk_ASN1_OCTET_STRING_num(bpp->sequenceOf88);
-    for (int i = 0; i < num_metadata; i++) {
-        elem = sk_ASN1_OCTET_STRING_value(bpp->sequenceOf88, i);
-        len = i2d_ASN1_OCTET_STRING_TAG8(elem, &encoded);
-        auto rv = decrypt_and_verify({ encoded, encoded + len }, false);
-        result.storeMetadata.insert(result.storeMetadata.end(), rv.begin(), rv.end());
-        ossl_free_reset(encoded);
-    }
+    result.storeMetadata.reserve(seq88.len);
+    int num_metadata = for_each_tlv(seq88, 0x88, [&](const BerTlv& seg) { append_verified_segment(seg.start, seg.total(), false, result.storeMetadata); });
     std::cout << "Step 2: " << num_metadata << " metadata chunks verified" << std::endl;
 
     // Step 3: If present, decrypt ReplaceSessionKeys with session keys
+    std::unique_ptr<BspCrypto> ppk_bsp;
     if (result.hasReplaceSessionKeys) {
         std::cout << "Step 3: Decrypting ReplaceSessionKeys with session keys..." << std::endl;
 
-        elem = sk_ASN1_OCTET_STRING_value(bpp->secondSequenceOf87, 0);
-        len = i2d_ASN1_OCTET_STRING_TAG7(elem, &encoded);
-		auto rsk_data = decrypt_and_verify({ encoded, encoded + len }, true);
+        std::vector<uint8_t> rsk_data;
+        for_each_tlv(seq87_2, 0x87, [&](const BerTlv& seg) { append_verified_segment(seg.start, seg.total(), true, rsk_data); });
         result.replaceSessionKeys = parse_replace_session_keys(rsk_data);
-        ossl_free_reset(encoded);
 
         // Step 4: Create NEW BSP instance with PPK and decrypt profile data
         std::cout << "Step 4: Creating new BSP instance with PPK keys..." << std::endl;
-        auto ppk_bsp = from_replace_session_keys(result.replaceSessionKeys);
+        ppk_bsp.reset(new BspCrypto(from_replace_session_keys(result.replaceSessionKeys)));
 
         print_hex("PPK-ENC", result.replaceSessionKeys.ppkEnc);
         print_hex("PPK-MAC", result.replaceSessionKeys.ppkCmac);
         print_hex("PPK Initial MCV", result.replaceSessionKeys.initialMacChainingValue);
 
-		std::cout << "Step 5: Decrypting profile data with PPK keys..." << std::endl;
-        int num = sk_ASN1_OCTET_STRING_num(bpp->sequenceOf86);
-        for (int i = 0; i < num; i++) {
-            elem = sk_ASN1_OCTET_STRING_value(bpp->sequenceOf86, i);
-            len = i2d_ASN1_OCTET_STRING_TAG6(elem, &encoded);
-			auto rv = ppk_bsp.decrypt_and_verify({ encoded, encoded + len }, true);
-            result.profileData.insert(result.profileData.end(), rv.begin(), rv.end());
-            ossl_free_reset(encoded);
-        }
-		std::cout << "Step 5: " << num << " profile chunks verified and decrypted" << std::endl;
-
+        std::cout << "Step 5: Decrypting profile data with PPK keys..." << std::endl;
     } else {
         // No ReplaceSessionKeys - decrypt profile data with session keys
         std::cout << "Step 3: Decrypting profile data with session keys (no PPK)..." << std::endl;
-        int num = sk_ASN1_OCTET_STRING_num(bpp->sequenceOf86);
-        for (int i = 0; i < num; i++) {
-            elem = sk_ASN1_OCTET_STRING_value(bpp->sequenceOf86, i);
-            len = i2d_ASN1_OCTET_STRING_TAG6(elem, &encoded);
-			auto rv = decrypt_and_verify({ encoded, encoded + len }, true);
-            result.profileData.insert(result.profileData.end(), rv.begin(), rv.end());
-            ossl_free_reset(encoded);
-        }
-		std::cout << "Step 3: " << num << " profile chunks verified and decrypted" << std::endl;
     }
 
+    BspCrypto& profile_bsp = ppk_bsp ? *ppk_bsp : *this;
+    std::vector<std::pair<const uint8_t*, size_t>> segments;
+    int num;
+    if (profile_sink) {
+        // a batch of segments at a time, the buffers are reused across batches
+        std::vector<uint8_t> scratch;
+        std::vector<size_t> ends;
+        auto flush = [&]() {
+            scratch.clear();
+            ends.clear();
+            profile_bsp.verify_and_decrypt_segments(segments, scratch, &ends);
+            size_t begin = 0;
+            for (size_t end : ends) {
+                (*profile_sink)(scratch.data() + begin, end - begin);
+                begin = end;
+            }
+            segments.clear();
+        };
+        num = for_each_tlv(seq86, 0x86, [&](const BerTlv& seg) {
+            segments.emplace_back(seg.start, seg.total());
+            if (segments.size() == PARALLEL_BATCH_SEGMENTS)
+                flush();
+        });
+        flush();
+    } else {
+        num = for_each_tlv(seq86, 0x86, [&](const BerTlv& seg) { segments.emplace_back(seg.start, seg.total()); });
+        // plaintext is never longer than the ciphertext, so this is the only allocation
+        result.profileData.reserve(seq86.len);
+        profile_bsp.verify_and_decrypt_segments(segments, result.profileData);
+    }
+    std::cout << (ppk_bsp ? "Step 5: " : "Step 3: ") << num << " profile chunks verified and decrypted" << std::endl;
+
     return result;
 }
 
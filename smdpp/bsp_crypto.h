@@ -14,6 +14,9 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
 #include <cstdint>
 #include <cstring>
 #include <arpa/inet.h>
@@ -152,16 +155,38 @@ class BspCrypto {
 	static const size_t MAX_SEGMENT_SIZE = 1020;
 	static const size_t MAC_LENGTH = 8;
 	static const size_t AES_KEY_SIZE = 16;
+	// Below this many segments, handing them to worker threads costs more than it saves
+	static const size_t PARALLEL_MIN_SEGMENTS = 32;
+	// Segments verified per round when the profile data is streamed to a sink
+	static const size_t PARALLEL_BATCH_SEGMENTS = 256;
+	static const unsigned MAX_WORKERS = 8;
 
 	std::vector<uint8_t> s_enc;
 	std::vector<uint8_t> s_mac;
 	std::vector<uint8_t> mac_chain;
 	uint32_t block_number;
 
-	static std::vector<uint8_t> compute_cmac(const std::vector<uint8_t>& key, const std::vector<uint8_t>& data, size_t output_size = AES_BLOCK_SIZE);
+	// Keyed once per session (S-ENC/S-MAC resp. PPK-ENC/PPK-MAC), every
+	// operation works on a copy so the key setup is not repeated per segment
+	EVP_MAC_CTX_unique_ptr cmac_tmpl;
+	EVP_CIPHER_CTX_unique_ptr enc_tmpl;
+	EVP_CIPHER_CTX_unique_ptr dec_tmpl;
 
-	std::vector<uint8_t> aes_cipher_operation(const std::vector<uint8_t>& input, const std::vector<uint8_t>& key, const std::vector<uint8_t>& iv,
-						  bool encrypt);
+	static EVP_MAC* cmac_impl();
+	static EVP_MAC_CTX_unique_ptr new_cmac_ctx(const std::vector<uint8_t>& key);
+	static EVP_CIPHER_CTX_unique_ptr new_cipher_ctx(const std::vector<uint8_t>& key, bool encrypt);
+
+	std::vector<uint8_t> compute_cmac(const std::vector<uint8_t>& data, size_t output_size = AES_BLOCK_SIZE) const;
+	// CMAC over the concatenation of parts, without assembling it first
+	std::vector<uint8_t> compute_cmac(std::initializer_list<std::pair<const uint8_t*, size_t>> parts, size_t output_size = AES_BLOCK_SIZE) const;
+
+	std::vector<uint8_t> aes_cipher_operation(const std::vector<uint8_t>& input, const std::vector<uint8_t>& iv, bool encrypt) const;
+	// out must have room for len octets, returns the number written
+	size_t aes_cipher_operation(const uint8_t* input, size_t len, const uint8_t* iv, bool encrypt, uint8_t* out) const;
+	// same on a private copy of enc_tmpl/dec_tmpl, which is left ready for the next IV
+	static size_t aes_cipher_run(EVP_CIPHER_CTX* ctx, const uint8_t* input, size_t len, const uint8_t* iv, bool encrypt, uint8_t* out);
+	EVP_CIPHER_CTX_unique_ptr copy_cipher_ctx(bool encrypt) const;
+	static void icv_block(uint32_t block_num, uint8_t* block);
 
 	static std::vector<uint8_t> encode_bertlv_length(size_t length);
 
@@ -169,8 +194,23 @@ class BspCrypto {
 	static void print_hex(const char* label, const unsigned char* data, int len);
 
 	static std::pair<size_t, size_t> parse_bertlv_length(const std::vector<uint8_t>& data, size_t offset);
+	static std::pair<size_t, size_t> parse_bertlv_length(const uint8_t* data, size_t size, size_t offset);
+
+	static size_t unpadded_length(const uint8_t* data, size_t len);
 
 	std::vector<uint8_t> verify_and_decrypt_helper(const std::vector<uint8_t>& segment, const std::vector<uint8_t>& mac_chain_to_use, bool decrypt);
+	// Verify the MAC of the segment TLV and decrypt it (or copy it for MAC-only) to out, which must have room
+	// for segment_len octets; returns the length of the plaintext
+	size_t verify_and_decrypt_segment(const uint8_t* segment, size_t segment_len, const std::vector<uint8_t>& mac_chain_to_use, bool decrypt,
+					  uint8_t* out);
+	void append_verified_segment(const uint8_t* segment, size_t segment_len, bool decrypt, std::vector<uint8_t>& out);
+	// MAC check only: advances mac_chain, returns the payload (ciphertext) inside segment
+	const uint8_t* verify_segment(const uint8_t* segment, size_t segment_len, const std::vector<uint8_t>& mac_chain_to_use, size_t& payload_len);
+	// Two stages: the MAC chain is verified over all segments in order, then the segments are decrypted in parallel
+	// (each only needs the ICV of its block number). Plaintext is appended to out, ends receives the end offset in
+	// out of each segment's plaintext.
+	void verify_and_decrypt_segments(const std::vector<std::pair<const uint8_t*, size_t>>& segments, std::vector<uint8_t>& out,
+					 std::vector<size_t>* ends = nullptr);
 
     public:
 	BspCrypto(const std::vector<uint8_t>& s_enc_key, const std::vector<uint8_t>& s_mac_key, const std::vector<uint8_t>& initial_mcv);
@@ -210,6 +250,19 @@ class BspCrypto {
 
 	BppProcessingResult process_bound_profile_package(const std::vector<uint8_t>& allofit);
 
+	// Structural error in a BoundProfilePackage
+	class BppFormatError : public std::runtime_error {
+	    public:
+		using std::runtime_error::runtime_error;
+	};
+
+	using BppSink = std::function<void(const uint8_t* data, size_t len)>;
+
+	// Single pass over the encoded BoundProfilePackage, without decoding it into a tree first: the segments are
+	// verified and decrypted straight from data, the profile data is passed to profile_sink segment by segment
+	// (result.profileData stays empty), so memory use does not depend on the profile size.
+	BppProcessingResult process_bound_profile_package(const uint8_t* data, size_t len, const BppSink& profile_sink);
+
 	BppProcessingResult process_bound_profile_package(const std::vector<uint8_t>& firstSequenceOf87, const std::vector<uint8_t>& sequenceOf88,
 							  const std::vector<uint8_t>& secondSequenceOf87, const std::vector<uint8_t>& sequenceOf86);
 
@@ -221,6 +274,10 @@ class BspCrypto {
 	std::vector<uint8_t> mac_only_one(uint8_t tag, const std::vector<uint8_t>& plaintext);
 	std::vector<std::vector<uint8_t>> encrypt_and_mac_seg(uint8_t tag, const std::vector<uint8_t>& data);
 	std::vector<std::vector<uint8_t>> mac_only_seg(uint8_t tag, const std::vector<uint8_t>& data);
+
+    private:
+	// profile data goes to profile_sink, or to result.profileData if it is null
+	BppProcessingResult process_bpp(const uint8_t* data, size_t len, const BppSink* profile_sink);
 };
 
 } // namespace BspCryptoNS
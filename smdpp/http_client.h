@@ -11,6 +11,8 @@
 #ifndef HTTP_CLIENT_H
 #define HTTP_CLIENT_H
 
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <openssl/x509.h>
@@ -40,6 +42,22 @@ class HttpClient {
 	ResponseData postJson(const std::string& url, unsigned int port, const std::string& jsonData, X509_STORE* store, std::vector<X509*>& certPool,
 			      const PostConfig& config);
 
+	/* Asynchronous variant of postJson(): all requests of one HttpClient share a single curl multi handle, so
+	 * connections are kept alive and reused, TLS sessions are resumed, and requests to the same server are
+	 * multiplexed if HTTP/2 is negotiated. Transfers make progress whenever requestDone() or waitResponse()
+	 * is called for any of them. */
+	typedef unsigned int RequestId;
+
+	RequestId submitPost(const std::string& url, unsigned int port, const std::string& body, X509_STORE* store, const std::vector<X509*>& certPool,
+			     const PostConfig& config);
+	// non-blocking
+	bool requestDone(RequestId id);
+	// blocks until the request has finished; throws on transport errors, as postJson() does
+	ResponseData waitResponse(RequestId id);
+
+	// Allow several requests on one HTTP/2 connection (default), otherwise a connection per request in flight
+	void setMultiplexing(bool enable);
+
     private:
 	static size_t writeCallback(void* contents, size_t size, size_t nmemb, void* userp);
 	static size_t headerCallback(void* contents, size_t size, size_t nmemb, void* userp);
@@ -53,6 +71,31 @@ class HttpClient {
 
 	static std::string get_cn_name(X509_NAME* const name);
 	static CURLcode sslCtxFunction(CURL* curl, SSL_CTX* sslCtx, void* arg);
+
+	// One request in flight; everything curl refers to during the transfer lives here
+	struct Transfer {
+		CURL* curl = nullptr;
+		struct curl_slist* headers = nullptr;
+		std::string body;
+		std::vector<X509*> certPool; // own references
+		SslCtxData ctxData = {};
+		ResponseData response = {};
+		bool done = false;
+		CURLcode result = CURLE_OK;
+
+		~Transfer();
+	};
+
+	// run the transfers, waiting at most timeoutMs for activity
+	void drive(int timeoutMs);
+	void release(Transfer& transfer);
+
+	CURLM* m_multi;
+	CURLSH* m_share;
+	std::map<RequestId, std::unique_ptr<Transfer>> m_transfers;
+	// finished easy handles, reset and kept for the next request
+	std::vector<CURL*> m_idleHandles;
+	RequestId m_nextId = 1;
 };
 
 } // namespace RspCrypto
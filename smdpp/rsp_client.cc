@@ -237,84 +237,14 @@ static std::vector<uint8_t> certToDER(X509* cert) {
 	return der;
 }
 
-bool CertificateUtil::verifyCertificateChainDynamic(X509* cert, const std::vector<X509*>& certPool, X509* rootCA, bool verbose) {
-	LOG_INFO("Verifying certificate chain...");
-	LOG_INFO("Target certificate: " + getSubjectName(cert));
-
-	// certificate store for trusted roots only
-	std::unique_ptr<X509_STORE, X509_STORE_Deleter> store(X509_STORE_new());
-	if (!store) {
-		throw OpenSSLError("Failed to create X509_STORE");
-	}
-
-	// Only add the explicitly provided root CA to the trust store
-	if (rootCA) {
-		if (verbose) {
-			LOG_INFO("Adding trusted root CA: " + getSubjectName(rootCA));
-		}
-		if (X509_STORE_add_cert(store.get(), rootCA) != 1) {
-			throw OpenSSLError("Failed to add root CA to store");
-		}
-	} else {
-		// If no root CA provided, find self-signed certificates in the pool
-		LOG_WARNING("No explicit root CA provided - searching for self-signed "
-			    "certificates");
-		for (auto candidate : certPool) {
-			if (X509_check_issued(candidate, candidate) == X509_V_OK) {
-				if (verbose) {
-					LOG_INFO("Adding self-signed certificate as trusted root: " + getSubjectName(candidate));
-				}
-				if (X509_STORE_add_cert(store.get(), candidate) != 1) {
-					unsigned long err = ERR_peek_last_error();
-					// Ignore duplicate certificate errors
-					if (ERR_GET_REASON(err) != X509_R_CERT_ALREADY_IN_HASH_TABLE) {
-						throw OpenSSLError("Failed to add root CA to store");
-					}
-					ERR_clear_error();
-				}
-			}
-		}
-	}
-
-	// Build untrusted chain from cert pool (excluding the root if it's in
-	// there) IMPORTANT: custom deleter that only frees the stack, not the
-	// certificates
-	auto stack_only_deleter = [](STACK_OF(X509) * stack) {
-		if (stack) {
-			sk_X509_free(stack); // This only frees the stack structure, not the contents
-		}
-	};
-	std::unique_ptr<STACK_OF(X509), decltype(stack_only_deleter)> untrusted_chain(sk_X509_new_null(), stack_only_deleter);
-	if (!untrusted_chain) {
-		throw OpenSSLError("Failed to create untrusted chain");
-	}
-
-	// Add all certificates from the pool as untrusted intermediates
-	for (auto poolCert : certPool) {
-		// Skip if this is the target certificate
-		if (X509_cmp(poolCert, cert) == 0) {
-			continue;
-		}
-		// Skip if this is the root CA (already in trust store)
-		if (rootCA && X509_cmp(poolCert, rootCA) == 0) {
-			continue;
-		}
-		// Add to untrusted chain
-		if (sk_X509_push(untrusted_chain.get(), poolCert) == 0) {
-			throw OpenSSLError("Failed to add certificate to untrusted chain");
-		}
-	}
-
-	if (verbose) {
-		LOG_INFO("Untrusted chain contains " + std::to_string(sk_X509_num(untrusted_chain.get())) + " certificates");
-	}
-
+// X509_verify_cert() with the exceptions needed for SGP.22 certificates; errors are only logged if logErrors is set
+static bool verifyChainWithStore(X509* cert, X509_STORE* store, STACK_OF(X509)* untrusted, bool verbose, bool logErrors) {
 	std::unique_ptr<X509_STORE_CTX, X509_STORE_CTX_Deleter> ctx(X509_STORE_CTX_new());
 	if (!ctx) {
 		throw OpenSSLError("Failed to create X509_STORE_CTX");
 	}
 
-	if (X509_STORE_CTX_init(ctx.get(), store.get(), cert, untrusted_chain.get()) != 1) {
+	if (X509_STORE_CTX_init(ctx.get(), store, cert, untrusted) != 1) {
 		throw OpenSSLError("Failed to initialize X509_STORE_CTX");
 	}
 
@@ -343,18 +273,20 @@ bool CertificateUtil::verifyCertificateChainDynamic(X509* cert, const std::vecto
 	int result = X509_verify_cert(ctx.get());
 
 	if (result != 1) {
-		int error = X509_STORE_CTX_get_error(ctx.get());
-		int depth = X509_STORE_CTX_get_error_depth(ctx.get());
-		X509* errorCert = X509_STORE_CTX_get_current_cert(ctx.get());
+		if (logErrors) {
+			int error = X509_STORE_CTX_get_error(ctx.get());
+			int depth = X509_STORE_CTX_get_error_depth(ctx.get());
+			X509* errorCert = X509_STORE_CTX_get_current_cert(ctx.get());
 
-		LOG_ERROR("Certificate verification failed:");
-		LOG_ERROR("  Error:   " + std::string(X509_verify_cert_error_string(error)));
-		LOG_ERROR("  Depth:   " + std::to_string(depth));
+			LOG_ERROR("Certificate verification failed:");
+			LOG_ERROR("  Error:   " + std::string(X509_verify_cert_error_string(error)));
+			LOG_ERROR("  Depth:   " + std::to_string(depth));
 
-		if (errorCert) {
-			LOG_ERROR("  Cert:    " + getSubjectName(errorCert));
+			if (errorCert) {
+				LOG_ERROR("  Cert:    " + CertificateUtil::getSubjectName(errorCert));
+			}
 		}
-
+		ERR_clear_error();
 		return false;
 	}
 
@@ -366,7 +298,7 @@ bool CertificateUtil::verifyCertificateChainDynamic(X509* cert, const std::vecto
 			LOG_INFO("Verified certificate chain:");
 			for (int i = 0; i < sk_X509_num(verified_chain); i++) {
 				X509* chainCert = sk_X509_value(verified_chain, i);
-				LOG_INFO("  " + std::to_string(i + 1) + ". " + getSubjectName(chainCert));
+				LOG_INFO("  " + std::to_string(i + 1) + ". " + CertificateUtil::getSubjectName(chainCert));
 			}
 			sk_X509_pop_free(verified_chain, X509_free);
 		}
@@ -375,6 +307,150 @@ bool CertificateUtil::verifyCertificateChainDynamic(X509* cert, const std::vecto
 	return true;
 }
 
+bool CertificateUtil::verifyCertificateChainDynamic(X509* cert, const std::vector<X509*>& certPool, X509* rootCA, bool verbose) {
+	// one-off; callers verifying repeatedly against the same pool should keep a CertificateVerifier
+	return CertificateVerifier(certPool, rootCA).verify(cert, verbose);
+}
+
+CertificateVerifier::CertificateVerifier(const std::vector<X509*>& certPool, X509* rootCA) : m_store(X509_STORE_new()), m_untrusted(sk_X509_new_null()) {
+	if (!m_store || !m_untrusted) {
+		sk_X509_free(m_untrusted);
+		throw OpenSSLError("Failed to create X509_STORE");
+	}
+
+	try {
+		// Only add the explicitly provided root CA to the trust store
+		if (rootCA) {
+			LOG_DEBUG("Adding trusted root CA: " + CertificateUtil::getSubjectName(rootCA));
+			if (X509_STORE_add_cert(m_store.get(), rootCA) != 1) {
+				throw OpenSSLError("Failed to add root CA to store");
+			}
+		} else {
+			// If no root CA provided, find self-signed certificates in the pool
+			LOG_WARNING("No explicit root CA provided - searching for self-signed "
+				    "certificates");
+			for (auto candidate : certPool) {
+				if (X509_check_issued(candidate, candidate) == X509_V_OK) {
+					LOG_DEBUG("Adding self-signed certificate as trusted root: " + CertificateUtil::getSubjectName(candidate));
+					if (X509_STORE_add_cert(m_store.get(), candidate) != 1) {
+						unsigned long err = ERR_peek_last_error();
+						// Ignore duplicate certificate errors
+						if (ERR_GET_REASON(err) != X509_R_CERT_ALREADY_IN_HASH_TABLE) {
+							throw OpenSSLError("Failed to add root CA to store");
+						}
+						ERR_clear_error();
+					}
+				}
+			}
+		}
+
+		// Everything else in the pool is an untrusted intermediate
+		for (auto poolCert : certPool) {
+			if (rootCA && X509_cmp(poolCert, rootCA) == 0) {
+				continue;
+			}
+			if (sk_X509_push(m_untrusted, poolCert) == 0) {
+				throw OpenSSLError("Failed to add certificate to untrusted chain");
+			}
+			X509_up_ref(poolCert);
+
+			auto ski = CertificateUtil::getSubjectKeyIdentifier(poolCert);
+			if (!ski.empty()) {
+				m_bySKI[ski].push_back(poolCert);
+			}
+			m_bySubject[X509_subject_name_hash(poolCert)].push_back(poolCert);
+		}
+	} catch (...) {
+		sk_X509_pop_free(m_untrusted, X509_free);
+		throw;
+	}
+
+	LOG_DEBUG("Certificate verifier: " + std::to_string(sk_X509_num(m_untrusted)) + " untrusted certificates");
+}
+
+CertificateVerifier::~CertificateVerifier() {
+	sk_X509_pop_free(m_untrusted, X509_free);
+}
+
+std::vector<X509*> CertificateVerifier::findIssuers(X509* cert) const {
+	std::vector<X509*> issuers;
+	auto aki = CertificateUtil::getAuthorityKeyIdentifier(cert);
+	const std::vector<X509*>* candidates = nullptr;
+
+	if (!aki.empty()) {
+		auto it = m_bySKI.find(aki);
+		if (it != m_bySKI.end()) {
+			candidates = &it->second;
+		}
+	} else {
+		auto it = m_bySubject.find(X509_issuer_name_hash(cert));
+		if (it != m_bySubject.end()) {
+			candidates = &it->second;
+		}
+	}
+
+	if (candidates) {
+		for (auto candidate : *candidates) {
+			if (candidate != cert && X509_check_issued(candidate, cert) == X509_V_OK) {
+				issuers.push_back(candidate);
+			}
+		}
+	}
+	return issuers;
+}
+
+bool CertificateVerifier::verify(X509* cert, bool verbose) {
+	std::vector<uint8_t> fingerprint(EVP_MAX_MD_SIZE);
+	unsigned int len = 0;
+	if (X509_digest(cert, EVP_sha256(), fingerprint.data(), &len) != 1) {
+		throw OpenSSLError("Failed to compute certificate fingerprint");
+	}
+	fingerprint.resize(len);
+
+	if (m_verified.count(fingerprint)) {
+		LOG_DEBUG("Certificate chain already verified: " + CertificateUtil::getSubjectName(cert));
+		return true;
+	}
+
+	LOG_DEBUG("Verifying certificate chain of: " + CertificateUtil::getSubjectName(cert));
+
+	// Collect the issuers by AKI -> SKI (or issuer -> subject), just the chain instead of the whole pool
+	auto stack_only_deleter = [](STACK_OF(X509) * stack) {
+		sk_X509_free(stack);
+	};
+	std::unique_ptr<STACK_OF(X509), decltype(stack_only_deleter)> chain(sk_X509_new_null(), stack_only_deleter);
+	if (!chain) {
+		throw OpenSSLError("Failed to create untrusted chain");
+	}
+	std::vector<X509*> todo = { cert };
+	std::set<X509*> seen;
+	while (!todo.empty() && sk_X509_num(chain.get()) < sk_X509_num(m_untrusted)) {
+		X509* current = todo.back();
+		todo.pop_back();
+		for (auto issuer : findIssuers(current)) {
+			if (seen.insert(issuer).second) {
+				sk_X509_push(chain.get(), issuer);
+				todo.push_back(issuer);
+			}
+		}
+	}
+
+	if (verbose) {
+		LOG_INFO("Untrusted chain contains " + std::to_string(sk_X509_num(chain.get())) + " certificates");
+	}
+
+	bool ok = verifyChainWithStore(cert, m_store.get(), chain.get(), verbose, false);
+	if (!ok) {
+		// the identifiers did not lead to a trusted root, let OpenSSL search the whole pool
+		ok = verifyChainWithStore(cert, m_store.get(), m_untrusted, verbose, true);
+	}
+
+	if (ok) {
+		m_verified.insert(fingerprint);
+	}
+	return ok;
+}
+
 static std::vector<std::filesystem::path> find_cert_files(const std::filesystem::path& root_path, const std::vector<std::string>& name_filters = {}) {
 	std::vector<std::filesystem::path> result;
 
@@ -903,12 +979,45 @@ static bool verify_TR031111(const std::vector<uint8_t>& message, const std::vect
 HttpClient::HttpClient() {
 	// should be called once per application
 	curl_global_init(CURL_GLOBAL_DEFAULT);
+
+	// the multi handle owns the connection cache, TLS sessions and DNS results are shared on top of that
+	m_multi = curl_multi_init();
+	m_share = curl_share_init();
+	if (!m_multi || !m_share) {
+		curl_multi_cleanup(m_multi);
+		curl_share_cleanup(m_share);
+		curl_global_cleanup();
+		throw std::runtime_error("Failed to initialize CURL");
+	}
+	curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	setMultiplexing(true);
 }
 
 HttpClient::~HttpClient() {
+	for (auto& entry : m_transfers) {
+		release(*entry.second);
+	}
+	m_transfers.clear();
+	for (CURL* curl : m_idleHandles) {
+		curl_easy_cleanup(curl);
+	}
+	curl_multi_cleanup(m_multi);
+	curl_share_cleanup(m_share);
 	curl_global_cleanup();
 }
 
+HttpClient::Transfer::~Transfer() {
+	curl_slist_free_all(headers);
+	for (X509* cert : certPool) {
+		X509_free(cert);
+	}
+}
+
+void HttpClient::setMultiplexing(bool enable) {
+	curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, enable ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+}
+
 // Private helper functions for HttpClient
 size_t HttpClient::writeCallback(void* contents, size_t size, size_t nmemb, void* userp) {
 	size_t realSize = size * nmemb;
@@ -981,14 +1090,28 @@ CURLcode HttpClient::sslCtxFunction(CURL* curl, SSL_CTX* sslCtx, void* arg) {
 
 HttpClient::ResponseData HttpClient::postJson(const std::string& url, unsigned int port, const std::string& jsonData, X509_STORE* store,
 					      std::vector<X509*>& certPool, const PostConfig& config) {
-	ResponseData response;
-	CURL* curl = curl_easy_init();
+	return waitResponse(submitPost(url, port, jsonData, store, certPool, config));
+}
+
+HttpClient::RequestId HttpClient::submitPost(const std::string& url, unsigned int port, const std::string& body, X509_STORE* store,
+					     const std::vector<X509*>& certPool, const PostConfig& config) {
+	auto transfer = std::make_unique<Transfer>();
+
+	// a finished handle still knows its connections and TLS sessions, only the options are reset
+	if (!m_idleHandles.empty()) {
+		transfer->curl = m_idleHandles.back();
+		m_idleHandles.pop_back();
+		curl_easy_reset(transfer->curl);
+	} else {
+		transfer->curl = curl_easy_init();
+	}
+	CURL* curl = transfer->curl;
 
 	if (!curl) {
 		throw std::runtime_error("Failed to initialize CURL");
 	}
 
-	struct curl_slist* headers = nullptr;
+	struct curl_slist*& headers = transfer->headers;
 	std::string contentTypeHeader = "Content-Type: " + config.contentType;
 	if (config.useMutualTLS) {
 		if (config.contentType == "application/json") {
@@ -1008,19 +1131,32 @@ HttpClient::ResponseData HttpClient::postJson(const std::string& url, unsigned i
 		headers = curl_slist_append(headers, "X-Admin-Protocol: gsma/rsp/v2.5.0");
 	}
 
-	SslCtxData ctxData = { .store = store, .certPool = &certPool, .verifyResult = false, .errorMessage = "" };
+	// the caller's certificates may be gone before the connection is set up
+	for (X509* cert : certPool) {
+		X509_up_ref(cert);
+		transfer->certPool.push_back(cert);
+	}
+	transfer->body = body;
+	transfer->ctxData = { .store = store, .certPool = &transfer->certPool, .verifyResult = false, .errorMessage = "" };
 
 	try {
 		// Basic CURL setup
 		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
 		curl_easy_setopt(curl, CURLOPT_PORT, port);
 		curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonData.c_str());
-		curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, jsonData.size()); // Important for binary data
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, transfer->body.c_str());
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, transfer->body.size()); // Important for binary data
 		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-		curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+		curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer->response.body);
 		curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
-		curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response.headers);
+		curl_easy_setopt(curl, CURLOPT_HEADERDATA, &transfer->response.headers);
+		curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer.get());
+
+		// Keep the connection open for the next request and resume TLS sessions
+		curl_easy_setopt(curl, CURLOPT_SHARE, m_share);
+		curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+		// wait for a connection that can be multiplexed rather than opening another one
+		curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
 
 		// Enable SSL verification
 		curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
@@ -1049,29 +1185,90 @@ HttpClient::ResponseData HttpClient::postJson(const std::string& url, unsigned i
 			}
 		}
 
-		// Use our custom SSL context function for server cert verification
+		// Use our custom SSL context function for server cert verification; only called for new connections
 		curl_easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, sslCtxFunction);
-		curl_easy_setopt(curl, CURLOPT_SSL_CTX_DATA, &ctxData);
+		curl_easy_setopt(curl, CURLOPT_SSL_CTX_DATA, &transfer->ctxData);
 
 		curl_easy_setopt(curl, CURLOPT_VERBOSE, config.verboseOutput ? 1L : 0L);
 
-		CURLcode res = curl_easy_perform(curl);
+		CURLMcode mres = curl_multi_add_handle(m_multi, curl);
+		if (mres != CURLM_OK) {
+			throw std::runtime_error(std::string("CURL request failed: ") + curl_multi_strerror(mres));
+		}
+	} catch (...) {
+		curl_easy_cleanup(curl);
+		throw;
+	}
+
+	RequestId id = m_nextId++;
+	m_transfers[id] = std::move(transfer);
+	return id;
+}
 
-		if (res != CURLE_OK) {
-			throw std::runtime_error(std::string("CURL request failed: ") + curl_easy_strerror(res));
+void HttpClient::drive(int timeoutMs) {
+	int running = 0;
+	CURLMcode mres = curl_multi_perform(m_multi, &running);
+
+	if (mres == CURLM_OK && running > 0 && timeoutMs > 0) {
+		mres = curl_multi_poll(m_multi, nullptr, 0, timeoutMs, nullptr);
+		if (mres == CURLM_OK) {
+			mres = curl_multi_perform(m_multi, &running);
 		}
+	}
+	if (mres != CURLM_OK) {
+		throw std::runtime_error(std::string("CURL multi failed: ") + curl_multi_strerror(mres));
+	}
 
-		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.statusCode);
+	CURLMsg* msg;
+	int pending;
+	while ((msg = curl_multi_info_read(m_multi, &pending))) {
+		if (msg->msg != CURLMSG_DONE) {
+			continue;
+		}
+		Transfer* transfer = nullptr;
+		curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &transfer);
+		transfer->done = true;
+		transfer->result = msg->data.result;
+		curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &transfer->response.statusCode);
+	}
+}
 
-		curl_slist_free_all(headers);
-		curl_easy_cleanup(curl);
+void HttpClient::release(Transfer& transfer) {
+	curl_multi_remove_handle(m_multi, transfer.curl);
+	m_idleHandles.push_back(transfer.curl);
+	transfer.curl = nullptr;
+}
 
-		return response;
-	} catch (...) {
-		curl_slist_free_all(headers);
-		curl_easy_cleanup(curl);
-		throw;
+bool HttpClient::requestDone(RequestId id) {
+	auto it = m_transfers.find(id);
+	if (it == m_transfers.end()) {
+		throw std::runtime_error("Unknown HTTP request " + std::to_string(id));
+	}
+	if (!it->second->done) {
+		drive(0);
+	}
+	return it->second->done;
+}
+
+HttpClient::ResponseData HttpClient::waitResponse(RequestId id) {
+	auto it = m_transfers.find(id);
+	if (it == m_transfers.end()) {
+		throw std::runtime_error("Unknown HTTP request " + std::to_string(id));
+	}
+
+	// CURLOPT_TIMEOUT bounds this
+	while (!it->second->done) {
+		drive(1000);
+	}
+
+	std::unique_ptr<Transfer> transfer = std::move(it->second);
+	m_transfers.erase(it);
+	release(*transfer);
+
+	if (transfer->result != CURLE_OK) {
+		throw std::runtime_error(std::string("CURL request failed: ") + curl_easy_strerror(transfer->result));
 	}
+	return std::move(transfer->response);
 }
 
 // Hashed Confirmation Code = SHA256(SHA256(Confirmation Code) | TransactionID)
@@ -1577,6 +1774,19 @@ bool RSPClient::verifyServerSignature(const std::vector<uint8_t>& signedData, co
 	}
 }
 
+bool RSPClient::verifyCertificateChain(const std::vector<uint8_t>& derCert) {
+	if (!m_certVerifier) {
+		std::vector<X509*> pool;
+		for (const auto& cert : m_certPool) {
+			pool.push_back(cert.get());
+		}
+		m_certVerifier = std::make_unique<CertificateVerifier>(pool, m_rootCA.get());
+	}
+
+	auto cert = CertificateUtil::loadCertFromDER(derCert);
+	return m_certVerifier->verify(cert.get());
+}
+
 bool RSPClient::verifyServerSignature(const std::vector<uint8_t>& serverSigned1, const std::vector<uint8_t>& serverSignature1) {
 	return verifyServerSignature(serverSigned1, serverSignature1, m_serverCert.get());
 }
@@ -1617,6 +1827,43 @@ std::string RSPClient::sendHttpsPostWithContentType(const std::string& endpoint,
 std::string RSPClient::sendHttpsPostUnified(const std::string& endpoint, const std::string& body, int& httpStatusCode, unsigned int portOverride,
 					    bool useMutualTLS, const std::string& clientCertPath, const std::string& clientKeyPath,
 					    const std::string& contentType) {
+	return completeHttpsPost(submitHttpsPostUnified(endpoint, body, portOverride, useMutualTLS, clientCertPath, clientKeyPath, contentType),
+				 httpStatusCode);
+}
+
+unsigned int RSPClient::submitHttpsPost(const std::string& endpoint, const std::string& body, unsigned int portOverride, bool withAuth) {
+	if (withAuth) {
+		if (!m_useMutualTLS) {
+			LOG_WARNING("submitHttpsPost with auth called but mutual TLS not configured");
+		}
+		return submitHttpsPostUnified(endpoint, body, portOverride, m_useMutualTLS, m_clientCertPath, m_clientKeyPath);
+	}
+	return submitHttpsPostUnified(endpoint, body, portOverride);
+}
+
+bool RSPClient::isHttpsPostComplete(unsigned int requestId) {
+	if (!m_httpClient) {
+		throw std::runtime_error("No HTTP request submitted");
+	}
+	return m_httpClient->requestDone(requestId);
+}
+
+std::string RSPClient::completeHttpsPost(unsigned int requestId, int& httpStatusCode) {
+	if (!m_httpClient) {
+		throw std::runtime_error("No HTTP request submitted");
+	}
+
+	HttpClient::ResponseData response = m_httpClient->waitResponse(requestId);
+
+	httpStatusCode = response.statusCode;
+
+	LOG_DEBUG("HTTP " + std::to_string(httpStatusCode) + " response, body length: " + std::to_string(response.body.length()));
+
+	return response.body;
+}
+
+unsigned int RSPClient::submitHttpsPostUnified(const std::string& endpoint, const std::string& body, unsigned int portOverride, bool useMutualTLS,
+					       const std::string& clientCertPath, const std::string& clientKeyPath, const std::string& contentType) {
 	if (!m_httpClient) {
 		m_httpClient = std::make_unique<HttpClient>();
 	}
@@ -1631,9 +1878,10 @@ std::string RSPClient::sendHttpsPostUnified(const std::string& endpoint, const s
 	}
 
 	// Add custom TLS server certificate if configured globally
+	std::vector<std::unique_ptr<X509, X509Deleter>> tlsCerts;
 	if (m_useCustomTlsCert && !m_customTlsCertPath.empty()) {
 		try {
-			auto tlsCerts = CertificateUtil::loadCertificateChain(m_customTlsCertPath);
+			tlsCerts = CertificateUtil::loadCertificateChain(m_customTlsCertPath);
 			for (auto& cert : tlsCerts) {
 				rawCertPool.push_back(cert.get());
 			}
@@ -1654,13 +1902,7 @@ std::string RSPClient::sendHttpsPostUnified(const std::string& endpoint, const s
 	LOG_DEBUG("Sending " + std::string(useMutualTLS ? "ES2+ request with mutual TLS" : "HTTPS request") + " to: " + endpoint +
 		  " (port: " + std::to_string(portOverride) + ")");
 
-	HttpClient::ResponseData response = m_httpClient->postJson(url, portOverride, body, nullptr, rawCertPool, config);
-
-	httpStatusCode = response.statusCode;
-
-	LOG_DEBUG("HTTP " + std::to_string(httpStatusCode) + " response, body length: " + std::to_string(response.body.length()));
-
-	return response.body;
+	return m_httpClient->submitPost(url, portOverride, body, nullptr, rawCertPool, config);
 }
 
 } // namespace RspCrypto
\ No newline at end of file
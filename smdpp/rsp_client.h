@@ -11,7 +11,9 @@
 #ifndef RSP_CLIENT_H
 #define RSP_CLIENT_H
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 #include "helpers.h" // For deleter functors
@@ -25,6 +27,7 @@ namespace RspCrypto {
 
 // Forward declarations for internal types
 class HttpClient;
+class CertificateVerifier;
 
 /**
  * RSPClient - Remote SIM Provisioning Client
@@ -70,6 +73,9 @@ class RSPClient {
 	bool verifyServerSignature(const std::vector<uint8_t>& serverSigned1, const std::vector<uint8_t>& serverSignature1,
 				   const std::vector<uint8_t>& derDataServerCert);
 	std::vector<uint8_t> computeECDHSharedSecret(const std::vector<uint8_t>& otherPublicKey);
+	// Chain verification against the root CA and certificate pool of this client, the results are
+	// cached like by CertificateVerifier
+	bool verifyCertificateChain(const std::vector<uint8_t>& derCert);
 
 	// Confirmation code and transaction handling
 	void setConfirmationCode(const std::string& confirmationCode);
@@ -90,6 +96,12 @@ class RSPClient {
 					 bool useMutualTLS = false, const std::string& clientCertPath = "", const std::string& clientKeyPath = "",
 					 const std::string& contentType = "application/json");
 
+	// Asynchronous HTTP operations: any number of requests can be in flight, on kept-alive (and, with HTTP/2,
+	// multiplexed) connections; completeHttpsPost() blocks until the given request has finished
+	unsigned int submitHttpsPost(const std::string& endpoint, const std::string& body, unsigned int portOverride, bool withAuth = false);
+	bool isHttpsPostComplete(unsigned int requestId);
+	std::string completeHttpsPost(unsigned int requestId, int& httpStatusCode);
+
     private:
 	// Private helper methods
 	void loadCertificate(const std::string& certPath, const std::string& certType, std::unique_ptr<X509, X509Deleter>& certStorage);
@@ -100,6 +112,9 @@ class RSPClient {
 	bool verifyServerSignature(const std::vector<uint8_t>& serverSigned1, const std::vector<uint8_t>& signature, X509* serverCert,
 				   const std::string& certSource);
 	int getEUICCCurveNID();
+	unsigned int submitHttpsPostUnified(const std::string& endpoint, const std::string& body, unsigned int portOverride, bool useMutualTLS = false,
+					    const std::string& clientCertPath = "", const std::string& clientKeyPath = "",
+					    const std::string& contentType = "application/json");
 
 	// Member variables
 	std::string m_serverUrl;
@@ -126,6 +141,9 @@ class RSPClient {
 	std::vector<uint8_t> m_transactionId;
 	std::string m_caCertPath;
 
+	// built from m_rootCA/m_certPool on first use
+	std::unique_ptr<CertificateVerifier> m_certVerifier;
+
 	std::unique_ptr<HttpClient> m_httpClient;
 	bool m_useCustomTlsCert;
 	std::string m_customTlsCertPath;
@@ -154,6 +172,36 @@ class CertificateUtil {
 	static bool verifyCertificateChainDynamic(X509* cert, const std::vector<X509*>& certPool, X509* rootCA, bool verbose);
 };
 
+/**
+ * Certificate chain verification against a fixed root CA and certificate pool
+ *
+ * The trust store and an index of the pool by SKI and subject are built once; the chain of a
+ * certificate is looked up by following its AKI (or issuer name) instead of handing the whole
+ * pool to OpenSSL. Certificates that verified are remembered by their SHA-256 fingerprint and
+ * are not verified again for the lifetime of the verifier: the validity period is not checked
+ * again either, so a certificate that expires after its first verification keeps verifying.
+ * Failed verifications are not remembered.
+ */
+class CertificateVerifier {
+    public:
+	CertificateVerifier(const std::vector<X509*>& certPool, X509* rootCA);
+	~CertificateVerifier();
+	CertificateVerifier(const CertificateVerifier&) = delete;
+	CertificateVerifier& operator=(const CertificateVerifier&) = delete;
+
+	bool verify(X509* cert, bool verbose = false);
+
+    private:
+	std::vector<X509*> findIssuers(X509* cert) const;
+
+	std::unique_ptr<X509_STORE, X509_STORE_Deleter> m_store;
+	// untrusted certificates of the pool, references owned
+	STACK_OF(X509)* m_untrusted;
+	std::map<std::vector<uint8_t>, std::vector<X509*>> m_bySKI;
+	std::map<unsigned long, std::vector<X509*>> m_bySubject;
+	std::set<std::vector<uint8_t>> m_verified;
+};
+
 } // namespace RspCrypto
 
 #endif // RSP_CLIENT_H
\ No newline at end of file
@@ -2,6 +2,7 @@
  * IMPLEMENTATION FILE: smdpp_Tests_Functions.cc
  * TTCN-3 External Function Implementations
  * ============================================================================ */
+#include <algorithm>
 #include <memory>
 #include <map>
 #include <mutex>
@@ -454,22 +455,36 @@ CHARSTRING ext__CertificateUtil__getCurveOID(const OCTETSTRING& certData) {
 
 BOOLEAN ext__CertificateUtil__verifyCertificateChainDynamic(const OCTETSTRING& cert, const CHARSTRING& certPoolDir,
 							    const OCTETSTRING& rootCA) {
+	// the certificate directories do not change during a test run: load each one once and keep its trust store
+	// and the chains verified so far. Never invalidated, certificates added to a directory later on are not seen.
+	static std::map<std::pair<std::string, std::vector<uint8_t>>, std::unique_ptr<CertificateVerifier>> verifiers;
+
 	return cert_bool_wrapper("ext__CertificateUtil__verifyCertificateChainDynamic", [&]() {
 		std::vector<uint8_t> certDer = octetstring_to_bytes(cert);
 		std::string poolDir = charstring_to_string(certPoolDir);
 		std::vector<uint8_t> rootDer = octetstring_to_bytes(rootCA);
 
 		auto certObj = CertificateUtil::loadCertFromDER(certDer);
-		auto rootObj = CertificateUtil::loadCertFromDER(rootDer);
 
-		auto certPool = CertificateUtil::loadCertificatesFromDirectory(poolDir, {});
-		std::vector<X509*> certPoolRaw;
-		for (const auto& c : certPool) {
-			certPoolRaw.push_back(c.get());
+		auto& verifier = verifiers[{ poolDir, rootDer }];
+		if (!verifier) {
+			auto rootObj = CertificateUtil::loadCertFromDER(rootDer);
+			auto certPool = CertificateUtil::loadCertificatesFromDirectory(poolDir, {});
+			std::vector<X509*> certPoolRaw;
+			for (const auto& c : certPool) {
+				certPoolRaw.push_back(c.get());
+			}
+			// takes its own references
+			verifier = std::make_unique<CertificateVerifier>(certPoolRaw, rootObj.get());
 		}
 
-		return CertificateUtil::verifyCertificateChainDynamic(certObj.get(), certPoolRaw, rootObj.get(),
-								      false); // verbose=false
+		return verifier->verify(certObj.get(), false);
+	});
+}
+
+BOOLEAN ext__RSPClient__verifyCertificateChain(const INTEGER& clientHandle, const OCTETSTRING& cert) {
+	return with_client(clientHandle, "ext__RSPClient__verifyCertificateChain", BOOLEAN(false), [&](RSPClient* client) {
+		return BOOLEAN(client->verifyCertificateChain(octetstring_to_bytes(cert)));
 	});
 }
 
@@ -505,73 +520,176 @@ void ext__logDebug(const CHARSTRING& message) {
 	log_wrapper<Logger::debug>("ext__logDebug", message);
 }
 
+// Session keys of a BoundProfilePackage, derived using X9.63 KDF (from_kdf); eid is given in hex
+static BspCryptoNS::BspCrypto bsp_from_kdf(const OCTETSTRING& sharedSecret, const INTEGER& keyType,
+					   const INTEGER& keyLength, const OCTETSTRING& hostId, const CHARSTRING& eid) {
+	std::vector<uint8_t> sharedSecretVec = octetstring_to_bytes(sharedSecret);
+	std::vector<uint8_t> hostIdVec = octetstring_to_bytes(hostId);
+
+	std::string eidStr = charstring_to_string(eid);
+	std::vector<uint8_t> eidVec;
+	for (size_t i = 0; i < eidStr.length(); i += 2) {
+		std::string hexByte = eidStr.substr(i, 2);
+		uint8_t byte = static_cast<uint8_t>(std::stoi(hexByte, nullptr, 16));
+		eidVec.push_back(byte);
+	}
+
+	LOG_DEBUG("BSP KDF inputs:");
+	LOG_DEBUG("  Shared secret: " + HexUtil::bytesToHex(sharedSecretVec));
+	LOG_DEBUG("  Key type: " + std::to_string(keyType.get_long_long_val()) +
+		  " (0x" + HexUtil::bytesToHex({static_cast<uint8_t>(keyType.get_long_long_val())}) + ")");
+	LOG_DEBUG("  Key length: " + std::to_string(keyLength.get_long_long_val()));
+	LOG_DEBUG("  Host ID: " + HexUtil::bytesToHex(hostIdVec));
+	LOG_DEBUG("  EID: " + HexUtil::bytesToHex(eidVec));
+
+	auto bsp = BspCryptoNS::BspCrypto::from_kdf(sharedSecretVec,
+						    static_cast<uint8_t>(keyType.get_long_long_val()),
+						    static_cast<uint8_t>(keyLength.get_long_long_val()),
+						    hostIdVec, eidVec);
+
+	LOG_DEBUG("BSP session keys derived successfully");
+	return bsp;
+}
+
+static ProcessedBoundProfilePackage processed_bpp_error() {
+	ProcessedBoundProfilePackage error_result;
+	error_result.configureIsdp() = OCTETSTRING(0, nullptr);
+	error_result.storeMetadata() = OCTETSTRING(0, nullptr);
+	error_result.hasReplaceSessionKeys() = BOOLEAN(false);
+	error_result.profileData() = OCTETSTRING(0, nullptr);
+	error_result.ppkEnc() = OMIT_VALUE;
+	error_result.ppkMac() = OMIT_VALUE;
+	error_result.ppkInitialMCV() = OMIT_VALUE;
+	return error_result;
+}
+
+static ProcessedBoundProfilePackage processed_bpp_to_ttcn(const BspCryptoNS::BspCrypto::BppProcessingResult& result) {
+	ProcessedBoundProfilePackage ttcn_result = processed_bpp_error();
+	ttcn_result.configureIsdp() = bytes_to_octetstring(result.configureIsdp);
+	ttcn_result.storeMetadata() = bytes_to_octetstring(result.storeMetadata);
+	ttcn_result.hasReplaceSessionKeys() = BOOLEAN(result.hasReplaceSessionKeys);
+	ttcn_result.profileData() = bytes_to_octetstring(result.profileData);
+
+	if (result.hasReplaceSessionKeys) {
+		ttcn_result.ppkEnc() = bytes_to_octetstring(result.replaceSessionKeys.ppkEnc);
+		ttcn_result.ppkMac() = bytes_to_octetstring(result.replaceSessionKeys.ppkCmac);
+		ttcn_result.ppkInitialMCV() =
+			bytes_to_octetstring(result.replaceSessionKeys.initialMacChainingValue);
+		LOG_DEBUG("ReplaceSessionKeys present - PPK will be used for profile decryption");
+	}
+
+	LOG_DEBUG("BoundProfilePackage processed successfully");
+	LOG_DEBUG("ConfigureISDP size: " + std::to_string(result.configureIsdp.size()));
+	LOG_DEBUG("StoreMetadata size: " + std::to_string(result.storeMetadata.size()));
+	LOG_DEBUG("Profile data size: " + std::to_string(result.profileData.size()));
+
+	return ttcn_result;
+}
+
 ProcessedBoundProfilePackage ext__BSP__processBoundProfilePackage(const OCTETSTRING& sharedSecret,
 								  const INTEGER& keyType, const INTEGER& keyLength,
 								  const OCTETSTRING& hostId, const CHARSTRING& eid,
 								  const OCTETSTRING& encodedBoundProfilePackage) {
-	auto makeErrorResult = []() {
-		ProcessedBoundProfilePackage error_result;
-		error_result.configureIsdp() = OCTETSTRING(0, nullptr);
-		error_result.storeMetadata() = OCTETSTRING(0, nullptr);
-		error_result.hasReplaceSessionKeys() = BOOLEAN(false);
-		error_result.profileData() = OCTETSTRING(0, nullptr);
-		return error_result;
-	};
-
-	return safe_execute("ext__BSP__processBoundProfilePackage", makeErrorResult(), [&]() {
-		std::vector<uint8_t> sharedSecretVec = octetstring_to_bytes(sharedSecret);
-		std::vector<uint8_t> hostIdVec = octetstring_to_bytes(hostId);
-
-		std::string eidStr = charstring_to_string(eid);
-		std::vector<uint8_t> eidVec;
-		for (size_t i = 0; i < eidStr.length(); i += 2) {
-			std::string hexByte = eidStr.substr(i, 2);
-			uint8_t byte = static_cast<uint8_t>(std::stoi(hexByte, nullptr, 16));
-			eidVec.push_back(byte);
-		}
-
+	return safe_execute("ext__BSP__processBoundProfilePackage", processed_bpp_error(), [&]() {
+		auto bsp = bsp_from_kdf(sharedSecret, keyType, keyLength, hostId, eid);
 		std::vector<uint8_t> bppData = octetstring_to_bytes(encodedBoundProfilePackage);
 
-		// Derive BSP session keys using X9.63 KDF (from_kdf)
-		LOG_DEBUG("BSP KDF inputs:");
-		LOG_DEBUG("  Shared secret: " + HexUtil::bytesToHex(sharedSecretVec));
-		LOG_DEBUG("  Key type: " + std::to_string(keyType.get_long_long_val()) +
-			  " (0x" + HexUtil::bytesToHex({static_cast<uint8_t>(keyType.get_long_long_val())}) + ")");
-		LOG_DEBUG("  Key length: " + std::to_string(keyLength.get_long_long_val()));
-		LOG_DEBUG("  Host ID: " + HexUtil::bytesToHex(hostIdVec));
-		LOG_DEBUG("  EID: " + HexUtil::bytesToHex(eidVec));
-
-		auto bsp = BspCryptoNS::BspCrypto::from_kdf(sharedSecretVec,
-							    static_cast<uint8_t>(keyType.get_long_long_val()),
-							    static_cast<uint8_t>(keyLength.get_long_long_val()),
-							    hostIdVec, eidVec);
-
-		LOG_DEBUG("BSP session keys derived successfully");
 		LOG_DEBUG("Processing BoundProfilePackage of size: " + std::to_string(bppData.size()));
 
-		auto result = bsp.process_bound_profile_package(bppData);
-
-		// Convert result back to TTCN-3
-		ProcessedBoundProfilePackage ttcn_result;
-		ttcn_result.configureIsdp() = bytes_to_octetstring(result.configureIsdp);
-		ttcn_result.storeMetadata() = bytes_to_octetstring(result.storeMetadata);
-		ttcn_result.hasReplaceSessionKeys() = BOOLEAN(result.hasReplaceSessionKeys);
-		ttcn_result.profileData() = bytes_to_octetstring(result.profileData);
-
-		if (result.hasReplaceSessionKeys) {
-			ttcn_result.ppkEnc() = bytes_to_octetstring(result.replaceSessionKeys.ppkEnc);
-			ttcn_result.ppkMac() = bytes_to_octetstring(result.replaceSessionKeys.ppkCmac);
-			ttcn_result.ppkInitialMCV() =
-				bytes_to_octetstring(result.replaceSessionKeys.initialMacChainingValue);
-			LOG_DEBUG("ReplaceSessionKeys present - PPK will be used for profile decryption");
-		}
+		return processed_bpp_to_ttcn(bsp.process_bound_profile_package(bppData));
+	});
+}
 
-		LOG_DEBUG("BoundProfilePackage processed successfully");
-		LOG_DEBUG("ConfigureISDP size: " + std::to_string(result.configureIsdp.size()));
-		LOG_DEBUG("StoreMetadata size: " + std::to_string(result.storeMetadata.size()));
-		LOG_DEBUG("Profile data size: " + std::to_string(result.profileData.size()));
+ProcessedBoundProfilePackage ext__BSP__processBoundProfilePackageStreamed(const OCTETSTRING& sharedSecret,
+									  const INTEGER& keyType, const INTEGER& keyLength,
+									  const OCTETSTRING& hostId, const CHARSTRING& eid,
+									  const OCTETSTRING& encodedBoundProfilePackage,
+									  INTEGER& numChunks) {
+	numChunks = INTEGER(0);
+
+	return safe_execute("ext__BSP__processBoundProfilePackageStreamed", processed_bpp_error(), [&]() {
+		auto bsp = bsp_from_kdf(sharedSecret, keyType, keyLength, hostId, eid);
+		std::vector<uint8_t> profileData;
+		int chunks = 0;
+
+		auto result = bsp.process_bound_profile_package(
+			static_cast<const unsigned char*>(encodedBoundProfilePackage), encodedBoundProfilePackage.lengthof(),
+			[&](const uint8_t* data, size_t len) {
+				profileData.insert(profileData.end(), data, data + len);
+				chunks++;
+			});
+		result.profileData.swap(profileData);
+
+		numChunks = INTEGER(chunks);
+		return processed_bpp_to_ttcn(result);
+	});
+}
+
+// DER TLV with a one or two octet tag
+static void append_tlv(std::vector<uint8_t>& out, uint16_t tag, const std::vector<uint8_t>& value) {
+	if (tag > 0xff)
+		out.push_back(tag >> 8);
+	out.push_back(tag & 0xff);
+	if (value.size() < 0x80) {
+		out.push_back(value.size());
+	} else {
+		int num = value.size() > 0xffffff ? 4 : value.size() > 0xffff ? 3 : value.size() > 0xff ? 2 : 1;
+		out.push_back(0x80 | num);
+		while (num--)
+			out.push_back((value.size() >> (8 * num)) & 0xff);
+	}
+	out.insert(out.end(), value.begin(), value.end());
+}
+
+static void append_segments(std::vector<uint8_t>& out, const std::vector<std::vector<uint8_t>>& segments) {
+	for (const auto& segment : segments)
+		out.insert(out.end(), segment.begin(), segment.end());
+}
 
-		return ttcn_result;
+OCTETSTRING ext__BSP__buildBoundProfilePackage(const OCTETSTRING& sharedSecret, const INTEGER& keyType,
+					       const INTEGER& keyLength, const OCTETSTRING& hostId, const CHARSTRING& eid,
+					       const OCTETSTRING& configureIsdp, const OCTETSTRING& storeMetadata,
+					       const OCTETSTRING& profileData) {
+	return safe_execute("ext__BSP__buildBoundProfilePackage", OCTETSTRING(0, nullptr), [&]() {
+		auto bsp = bsp_from_kdf(sharedSecret, keyType, keyLength, hostId, eid);
+		std::vector<uint8_t> seq87, seq88, seq86, body, bpp;
+
+		append_segments(seq87, bsp.encrypt_and_mac_seg(0x87, octetstring_to_bytes(configureIsdp)));
+		append_segments(seq88, bsp.mac_only_seg(0x88, octetstring_to_bytes(storeMetadata)));
+		append_segments(seq86, bsp.encrypt_and_mac_seg(0x86, octetstring_to_bytes(profileData)));
+
+		// the InitialiseSecureChannelRequest is not looked at when processing
+		append_tlv(body, 0xBF23, {});
+		append_tlv(body, 0xA0, seq87);
+		append_tlv(body, 0xA1, seq88);
+		append_tlv(body, 0xA3, seq86);
+		append_tlv(bpp, 0xBF36, body);
+
+		return bytes_to_octetstring(bpp);
+	});
+}
+
+OCTETSTRING ext__BSP__encryptAndMacSegments(const OCTETSTRING& sharedSecret, const INTEGER& keyType,
+					     const INTEGER& keyLength, const OCTETSTRING& hostId, const CHARSTRING& eid,
+					     const INTEGER& tag, const OCTETSTRING& data, const BOOLEAN& parallel) {
+	return safe_execute("ext__BSP__encryptAndMacSegments", OCTETSTRING(0, nullptr), [&]() {
+		auto bsp = bsp_from_kdf(sharedSecret, keyType, keyLength, hostId, eid);
+		std::vector<uint8_t> plaintext = octetstring_to_bytes(data);
+		std::vector<uint8_t> out;
+
+		if (parallel) {
+			append_segments(out, bsp.encrypt_and_mac_seg(static_cast<uint8_t>(static_cast<int>(tag)), plaintext));
+		} else {
+			// one segment at a time, as encrypt_and_mac_seg() does below its parallel threshold
+			const size_t max_payload = 1010; // segment size 1020 minus tag, length and MAC
+			for (size_t offset = 0; offset < plaintext.size(); offset += max_payload) {
+				size_t len = std::min(max_payload, plaintext.size() - offset);
+				std::vector<uint8_t> chunk(plaintext.begin() + offset, plaintext.begin() + offset + len);
+				auto segment = bsp.encrypt_and_mac_one(static_cast<uint8_t>(static_cast<int>(tag)), chunk);
+				out.insert(out.end(), segment.begin(), segment.end());
+			}
+		}
+		return bytes_to_octetstring(out);
 	});
 }
 
@@ -641,6 +759,40 @@ CHARSTRING ext__RSPClient__sendHttpsPostWithAuth(const INTEGER& clientHandle, co
 	});
 }
 
+INTEGER ext__RSPClient__submitHttpsPost(const INTEGER& clientHandle, const CHARSTRING& endpoint, const CHARSTRING& body,
+					const INTEGER& port, const BOOLEAN& withAuth) {
+	return with_client(clientHandle, "ext__RSPClient__submitHttpsPost", INTEGER(-1), [&](RSPClient* client) {
+		unsigned int requestId = client->submitHttpsPost(
+			charstring_to_string(endpoint),
+			charstring_to_string(body),
+			static_cast<int>(port),
+			static_cast<bool>(withAuth)
+		);
+
+		return INTEGER(static_cast<int>(requestId));
+	});
+}
+
+BOOLEAN ext__RSPClient__isHttpsPostComplete(const INTEGER& clientHandle, const INTEGER& requestId) {
+	// a failed request is complete, completeHttpsPost() reports the error
+	return with_client(clientHandle, "ext__RSPClient__isHttpsPostComplete", BOOLEAN(true), [&](RSPClient* client) {
+		return BOOLEAN(client->isHttpsPostComplete(static_cast<int>(requestId)));
+	});
+}
+
+CHARSTRING ext__RSPClient__completeHttpsPost(const INTEGER& clientHandle, const INTEGER& requestId, INTEGER& statusCode) {
+	statusCode = INTEGER(0);
+
+	return with_client(clientHandle, "ext__RSPClient__completeHttpsPost", CHARSTRING(""), [&](RSPClient* client) {
+		int httpStatus = 0;
+
+		std::string response = client->completeHttpsPost(static_cast<int>(requestId), httpStatus);
+
+		statusCode = INTEGER(httpStatus);
+		return string_to_charstring(response);
+	});
+}
+
 CHARSTRING ext__RSPClient__sendHttpsPostWithContentType(const INTEGER& clientHandle, const CHARSTRING& endpoint,
 						 const CHARSTRING& body, const INTEGER& port, const CHARSTRING& contentType, INTEGER& statusCode) {
 	statusCode = INTEGER(0);
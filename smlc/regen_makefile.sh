@@ -9,6 +9,7 @@ FILES="
 	IPA_CodecPort_CtrlFunctDef.cc
 	IPL4asp_PT.cc
 	IPL4asp_discovery.cc
+	Index_FunctionDefs.cc
 	IuUP_EncDec.cc
 	MGCP_CodecPort_CtrlFunctDef.cc
 	Native_FunctionDefs.cc